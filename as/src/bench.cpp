@@ -0,0 +1,131 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+using namespace std;
+
+/*
+ * 汇编器的性能基准：生成一个很大的汇编程序，运行汇编器，
+ * 输出每秒处理的行数和汇编器进程的峰值内存（RSS）。
+ * 用法: bench <汇编器> [行数，默认5000000] [生成的汇编文件，默认build/bench.asm]
+ */
+
+// 生成的程序：每16行一个标签，包含所有指令格式、注释和空行，分支跳回上一个标签
+void generate(const string& path, long lines) {
+    ofstream out(path);
+    long label = 0;
+    for (long i = 0; i < lines; i++) {
+        int r = i % 31 + 1;
+        switch (i % 16) {
+        case 0:
+            out << "L" << label++ << ":\n";
+            break;
+        case 1:
+            out << "    addi x" << r << " x" << r << " 1 ; 计数\n";
+            break;
+        case 2:
+            out << "    add x" << r << " x1 x2\n";
+            break;
+        case 3:
+            out << "\tld x" << r << " x2 8\n";
+            break;
+        case 4:
+            out << "    sd x" << r << " x2 -16\n";
+            break;
+        case 5:
+            out << "; 注释行\n";
+            break;
+        case 6:
+            out << "    lui x" << r << " 0x12345\n";
+            break;
+        case 7:
+            out << "    mul x3 x" << r << " x4\n";
+            break;
+        case 8:
+            out << "\n";
+            break;
+        case 9:
+            out << "    xori x" << r << " x5 -1\n";
+            break;
+        case 10:
+            out << "    sll x6 x" << r << " x7\n";
+            break;
+        case 11:
+            out << "    jalr x0 x0 56\n";
+            break;
+        case 12:
+            out << "    div x8 x" << r << " x9\n";
+            break;
+        case 13:
+            out << "    rdcycle x" << r << "\n";
+            break;
+        case 14:
+            out << "    bge x" << r << " x10 L" << label - 1 << "\n";
+            break;
+        default:
+            out << "    jal x1 L" << label - 1 << "\n";
+            break;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "用法: bench <汇编器> [行数] [生成的汇编文件]\n";
+        return 1;
+    }
+    const char* as = argv[1];
+    long lines = argc >= 3 ? strtol(argv[2], nullptr, 0) : 5000000;
+    string asm_path = argc >= 4 ? argv[3] : "build/bench.asm";
+    string bin_path = asm_path + ".bin";
+
+    generate(asm_path, lines);
+
+    // 在子进程中运行汇编器，标准输入重定向为生成的文件
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = open(asm_path.c_str(), O_RDONLY);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (fd < 0 || null_fd < 0)
+            _exit(127);
+        dup2(fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        execl(as, as, bin_path.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    if (pid < 0) {
+        cerr << "无法创建子进程\n";
+        return 1;
+    }
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        cerr << "等待子进程失败\n";
+        return 1;
+    }
+    double seconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        cerr << "汇编失败\n";
+        return 1;
+    }
+
+    ifstream in(asm_path, ios::ate | ios::binary);
+    long bytes = in.tellg();
+    cout << "Lines: " << lines << " (" << bytes / (1 << 20) << " MB)\n";
+    cout << "Host time: " << seconds << " s\n";
+    cout << "Lines per second: " << uint64_t(lines / seconds) << "\n";
+    cout << "Peak RSS: " << usage.ru_maxrss / 1024 << " MB\n";
+
+    remove(bin_path.c_str());
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "image.hpp"
+#include "isa.hpp"
+#include "lexer.hpp"
+#include "rvc.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+using namespace std;
+
+/*
+ * 反汇编器：逐条输出汇编器生成的映像（或原始二进制文件）中代码段的指令，
+ * 压缩指令（见rvc.hpp）输出16位的编码和展开之后的指令
+ * 用法: dis <bin_file>
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "用法: dis <bin_file>\n";
+        return 1;
+    }
+    int fd = open(argv[1], O_RDONLY);
+    if (fd < 0) {
+        cerr << "无法打开文件: " << argv[1] << '\n';
+        return 1;
+    }
+    lexer::Source source(fd);
+    close(fd);
+
+    string_view bin = source.text();
+    vector<image::SegmentView> segments;
+    uint64_t entry;
+    string error;
+    if (!image::parse(reinterpret_cast<const uint8_t*>(bin.data()), bin.size(), segments,
+                      entry, error)) {
+        cerr << "错误：" << argv[1] << ": " << error << '\n';
+        return 1;
+    }
+
+    printf("entry: %08llx\n", (unsigned long long)entry);
+    for (const image::SegmentView& seg : segments) {
+        // 数据段只输出地址和长度
+        if (!(seg.flags & image::SEG_CODE)) {
+            printf("data:  %08llx  %zu bytes\n", (unsigned long long)seg.addr, seg.size);
+            continue;
+        }
+        for (size_t off = 0; off + 2 <= seg.size;) {
+            uint64_t addr = seg.addr + off;
+            // 一组压缩指令的第二条只剩2字节，读取时补0
+            uint32_t word = off + 4 <= seg.size ? uint32_t(image::get_be(seg.data + off, 4))
+                                                : uint32_t(image::get_be(seg.data + off, 2)) << 16;
+            // 跳转目标相对于下一条指令的地址
+            if (rvc::is_compressed(addr, word)) {
+                uint16_t parcel = uint16_t(word >> 16);
+                printf("%08llx:  %04x      %s\n", (unsigned long long)addr, parcel,
+                       isa::disassemble(rvc::expand(parcel), int(addr + 2)).c_str());
+                off += 2;
+                continue;
+            }
+            if (off + 4 > seg.size)
+                break;
+            printf("%08llx:  %08x  %s\n", (unsigned long long)addr, word,
+                   isa::disassemble(word, int(addr + 4)).c_str());
+            off += 4;
+        }
+    }
+    return 0;
+}
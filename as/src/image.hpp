@@ -0,0 +1,229 @@
+#ifndef __IMAGE_HPP__
+#define __IMAGE_HPP__
+
+#include <cstddef>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+/*
+ * 汇编器输出的程序映像格式（所有整数均为大端序，与ram一致）：
+ *
+ *      偏移  大小  内容
+ *      0     4     魔数 "RVIM"
+ *      4     2     版本号（1）
+ *      6     2     段数n
+ *      8     8     入口地址（cpu复位后的pc）
+ *      16    32*n  段表，每个段：
+ *                      装载地址(8) 文件内偏移(8) 长度(8) 标志(4，SEG_CODE/SEG_DATA) 保留(4)
+ *      ...         各段的内容
+ *
+ * 装载时把每个段的内容原样复制到装载地址处即可，不需要任何转换，
+ * 因此映像可以直接mmap之后装载。不以魔数开头的文件按原始二进制装载到地址0处，入口为0。
+ */
+namespace image {
+
+constexpr char MAGIC[4] = {'R', 'V', 'I', 'M'};
+constexpr uint16_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t SEGMENT_SIZE = 32;
+
+/* 段的标志 */
+enum : uint32_t {
+    SEG_CODE = 1,
+    SEG_DATA = 2,
+};
+
+struct Segment {
+    uint64_t addr = 0;  // 装载地址
+    uint32_t flags = 0; // SEG_CODE/SEG_DATA
+    vector<uint8_t> bytes;
+};
+
+/**
+ * @brief 在内存中构建映像，最后一次写入文件
+ */
+class Writer {
+  public:
+    explicit Writer(uint64_t entry) : entry_(entry) {}
+
+    /**
+     * @brief 增加一个段，返回它的下标；段的内容之后可以继续追加
+     */
+    size_t add_segment(uint64_t addr, uint32_t flags) {
+        segments_.push_back(Segment{addr, flags, {}});
+        return segments_.size() - 1;
+    }
+
+    Segment& segment(size_t idx) { return segments_[idx]; }
+
+    /**
+     * @brief 生成文件头和段表
+     */
+    vector<uint8_t> header() const {
+        size_t offset = HEADER_SIZE + SEGMENT_SIZE * segments_.size();
+        vector<uint8_t> out;
+        out.reserve(offset);
+        out.insert(out.end(), MAGIC, MAGIC + 4);
+        put_be(out, VERSION, 2);
+        put_be(out, segments_.size(), 2);
+        put_be(out, entry_, 8);
+        for (const Segment& s : segments_) {
+            put_be(out, s.addr, 8);
+            put_be(out, offset, 8);
+            put_be(out, s.bytes.size(), 8);
+            put_be(out, s.flags, 4);
+            put_be(out, 0, 4);
+            offset += s.bytes.size();
+        }
+        return out;
+    }
+
+    /**
+     * @brief 把文件头和各段的内容用一次writev写入文件，段的内容不再复制
+     */
+    bool write(const string& path) const {
+        vector<uint8_t> head = header();
+        vector<iovec> iov;
+        iov.push_back(iovec{head.data(), head.size()});
+        for (const Segment& s : segments_)
+            if (!s.bytes.empty())
+                iov.push_back(iovec{const_cast<uint8_t*>(s.bytes.data()), s.bytes.size()});
+
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+        // writev可能只写入一部分，跳过已经写入的部分继续写
+        size_t next = 0;
+        bool ok = true;
+        while (next < iov.size()) {
+            ssize_t n = writev(fd, iov.data() + next, int(min(iov.size() - next, size_t(IOV_MAX))));
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                ok = false;
+                break;
+            }
+            size_t left = size_t(n);
+            while (next < iov.size() && left >= iov[next].iov_len)
+                left -= iov[next++].iov_len;
+            if (left > 0) {
+                iov[next].iov_base = static_cast<uint8_t*>(iov[next].iov_base) + left;
+                iov[next].iov_len -= left;
+            }
+        }
+        return close(fd) == 0 && ok;
+    }
+
+  private:
+    static void put_be(vector<uint8_t>& out, uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; i--)
+            out.push_back(uint8_t(value >> (8 * i)));
+    }
+
+    uint64_t entry_;
+    vector<Segment> segments_;
+};
+
+inline uint64_t get_be(const uint8_t* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++)
+        value = value << 8 | p[i];
+    return value;
+}
+
+/**
+ * @brief 文件是否以映像的魔数开头
+ */
+inline bool is_image(const uint8_t* data, size_t size) {
+    return size >= HEADER_SIZE && memcmp(data, MAGIC, 4) == 0;
+}
+
+/* 映像中的一个段，内容指向文件本身 */
+struct SegmentView {
+    uint64_t addr;
+    uint32_t flags;
+    const uint8_t* data;
+    size_t size;
+};
+
+/**
+ * @brief 解析映像的段表；不是映像的文件作为装载到地址0处的一个代码段
+ *
+ * @param data 文件内容（通常是mmap得到的）
+ * @param size 文件长度
+ * @param segments 返回各个段
+ * @param entry 返回入口地址
+ * @param error 失败时返回原因
+ * @return true 解析成功
+ */
+inline bool parse(const uint8_t* data, size_t size, vector<SegmentView>& segments,
+                  uint64_t& entry, string& error) {
+    segments.clear();
+    entry = 0;
+    if (!is_image(data, size)) {
+        segments.push_back(SegmentView{0, SEG_CODE, data, size});
+        return true;
+    }
+
+    uint64_t version = get_be(data + 4, 2);
+    uint64_t count = get_be(data + 6, 2);
+    if (version != VERSION) {
+        error = "unsupported image version " + to_string(version);
+        return false;
+    }
+    if (HEADER_SIZE + SEGMENT_SIZE * count > size) {
+        error = "truncated segment table";
+        return false;
+    }
+    entry = get_be(data + 8, 8);
+
+    for (uint64_t i = 0; i < count; i++) {
+        const uint8_t* seg = data + HEADER_SIZE + SEGMENT_SIZE * i;
+        uint64_t offset = get_be(seg + 8, 8);
+        uint64_t length = get_be(seg + 16, 8);
+        if (offset > size || length > size - offset) {
+            error = "segment " + to_string(i) + " lies outside the file";
+            return false;
+        }
+        segments.push_back(
+            SegmentView{get_be(seg, 8), uint32_t(get_be(seg + 24, 4)), data + offset, length});
+    }
+    return true;
+}
+
+/**
+ * @brief 装载映像或原始二进制文件：把每个段复制到它的装载地址处
+ *
+ * @param write 写入内存的函数：write(addr, ptr, n)，返回实际写入的字节数
+ * @param entry 返回入口地址
+ * @param error 失败时返回原因
+ * @return true 装载成功
+ */
+template <typename Write>
+bool load(const uint8_t* data, size_t size, Write&& write, uint64_t& entry, string& error) {
+    vector<SegmentView> segments;
+    if (!parse(data, size, segments, entry, error))
+        return false;
+    for (size_t i = 0; i < segments.size(); i++) {
+        const SegmentView& s = segments[i];
+        if (write(s.addr, s.data, s.size) != s.size) {
+            error = "segment " + to_string(i) + " does not fit in RAM";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace image
+
+#endif // __IMAGE_HPP__
@@ -0,0 +1,445 @@
+#ifndef __ISA_HPP__
+#define __ISA_HPP__
+
+#include "lexer.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+namespace isa {
+
+/* 指令格式，决定立即数在编码中的位置 */
+enum Format : uint8_t {
+    FMT_R,
+    FMT_I,
+    FMT_S,
+    FMT_B,
+    FMT_U,
+    FMT_J,
+    FMT_CSR, // csrrs rd csr x0：I型，立即数为无符号的CSR地址，rs1固定为x0
+};
+
+/* 汇编格式中的操作数 */
+enum Operand : uint8_t {
+    OPD_NONE,
+    OPD_RD,
+    OPD_RS1,
+    OPD_RS2,
+    OPD_IMM,    // 立即数（lui为imm[31:12]）
+    OPD_TARGET, // 跳转目标：标签或地址，偏移量相对于下一条指令的地址
+    OPD_CSR,    // CSR地址或名称
+};
+
+constexpr size_t MAX_OPERANDS = 3;
+
+/* 一条指令的规格：汇编格式和编码 */
+struct Spec {
+    string_view mnemonic;
+    Format format;
+    uint8_t opcode;
+    uint8_t funct3;
+    uint8_t funct7;
+    Operand operands[MAX_OPERANDS];
+
+    constexpr size_t operand_count() const {
+        size_t n = 0;
+        while (n < MAX_OPERANDS && operands[n] != OPD_NONE)
+            n++;
+        return n;
+    }
+};
+
+/* 支持的指令，与README中的指令表一致（not、ret、rdcycle、rdinstret是伪指令，由汇编器展开） */
+constexpr Spec SPECS[] = {
+    {"ld", FMT_I, 0x03, 3, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"lb", FMT_I, 0x03, 0, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"lbu", FMT_I, 0x03, 4, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"lh", FMT_I, 0x03, 1, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"lhu", FMT_I, 0x03, 5, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"lw", FMT_I, 0x03, 2, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"lwu", FMT_I, 0x03, 6, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"sd", FMT_S, 0x23, 3, 0, {OPD_RS2, OPD_RS1, OPD_IMM}},
+    {"sb", FMT_S, 0x23, 0, 0, {OPD_RS2, OPD_RS1, OPD_IMM}},
+    {"sh", FMT_S, 0x23, 1, 0, {OPD_RS2, OPD_RS1, OPD_IMM}},
+    {"sw", FMT_S, 0x23, 2, 0, {OPD_RS2, OPD_RS1, OPD_IMM}},
+    {"add", FMT_R, 0x33, 0, 0x00, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"sub", FMT_R, 0x33, 0, 0x20, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"mul", FMT_R, 0x33, 0, 0x01, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"div", FMT_R, 0x33, 4, 0x01, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"sll", FMT_R, 0x33, 1, 0x00, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"srl", FMT_R, 0x33, 5, 0x00, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"and", FMT_R, 0x33, 7, 0x00, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"or", FMT_R, 0x33, 6, 0x00, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"xor", FMT_R, 0x33, 4, 0x00, {OPD_RD, OPD_RS1, OPD_RS2}},
+    {"addi", FMT_I, 0x13, 0, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"xori", FMT_I, 0x13, 4, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"lui", FMT_U, 0x37, 0, 0, {OPD_RD, OPD_IMM}},
+    {"beq", FMT_B, 0x63, 0, 0, {OPD_RS1, OPD_RS2, OPD_TARGET}},
+    {"bge", FMT_B, 0x63, 5, 0, {OPD_RS1, OPD_RS2, OPD_TARGET}},
+    {"jal", FMT_J, 0x6F, 0, 0, {OPD_RD, OPD_TARGET}},
+    {"jalr", FMT_I, 0x67, 2, 0, {OPD_RD, OPD_RS1, OPD_IMM}},
+    {"csrr", FMT_CSR, 0x73, 2, 0, {OPD_RD, OPD_CSR}},
+};
+
+constexpr size_t SPEC_COUNT = sizeof(SPECS) / sizeof(SPECS[0]);
+
+/* ---------------- 助记符的完美哈希 ---------------- */
+
+constexpr size_t HASH_SIZE = 64; // 2的幂，不小于指令数；取指令数的两倍以上，种子很快就能找到
+static_assert(HASH_SIZE >= SPEC_COUNT, "哈希表太小");
+
+constexpr uint32_t hash(string_view s, uint32_t seed) {
+    uint32_t h = seed;
+    for (char c : s)
+        h = (h ^ uint8_t(c)) * 0x01000193u;
+    return (h ^ (h >> 15)) & (HASH_SIZE - 1);
+}
+
+// 编译期搜索一个种子，使所有助记符落在不同的槽中
+constexpr uint32_t find_seed() {
+    for (uint32_t seed = 0x811C9DC5u;; seed++) {
+        bool used[HASH_SIZE] = {};
+        bool ok = true;
+        for (size_t i = 0; i < SPEC_COUNT && ok; i++) {
+            uint32_t slot = hash(SPECS[i].mnemonic, seed);
+            ok = !used[slot];
+            used[slot] = true;
+        }
+        if (ok)
+            return seed;
+    }
+}
+
+constexpr uint32_t HASH_SEED = find_seed();
+
+// 槽 -> SPECS中的下标，空槽为-1
+constexpr array<int8_t, HASH_SIZE> build_slots() {
+    array<int8_t, HASH_SIZE> slots{};
+    for (auto& s : slots)
+        s = -1;
+    for (size_t i = 0; i < SPEC_COUNT; i++)
+        slots[hash(SPECS[i].mnemonic, HASH_SEED)] = int8_t(i);
+    return slots;
+}
+
+constexpr array<int8_t, HASH_SIZE> SLOTS = build_slots();
+
+/**
+ * @brief 按助记符查找指令规格
+ *
+ * @return 未知的助记符返回nullptr
+ */
+constexpr const Spec* lookup(string_view mnemonic) {
+    int8_t i = SLOTS[hash(mnemonic, HASH_SEED)];
+    if (i < 0 || SPECS[i].mnemonic != mnemonic)
+        return nullptr;
+    return &SPECS[i];
+}
+
+static_assert(lookup("add") == &SPECS[11] && lookup("lbu") == &SPECS[2] && lookup("csrr") == &SPECS[SPEC_COUNT - 1] &&
+                  lookup("blt") == nullptr,
+              "助记符查找错误");
+
+/* ---------------- 编码和译码 ---------------- */
+
+/* 指令的各个字段，imm的含义由格式决定：
+ * B/J为相对于下一条指令地址的偏移量（不左移），U为imm[31:12]，CSR为无符号的CSR地址 */
+struct Fields {
+    uint32_t rd = 0, rs1 = 0, rs2 = 0;
+    int32_t imm = 0;
+
+    constexpr bool operator==(const Fields& o) const {
+        return rd == o.rd && rs1 == o.rs1 && rs2 == o.rs2 && imm == o.imm;
+    }
+};
+
+constexpr int32_t sext(uint32_t value, int bits) {
+    return int32_t(value << (32 - bits)) >> (32 - bits);
+}
+
+constexpr uint32_t encode(const Spec& s, const Fields& f) {
+    uint32_t imm = uint32_t(f.imm);
+    uint32_t code = s.opcode | (f.rd & 0x1F) << 7;
+    switch (s.format) {
+    case FMT_R:
+        return s.opcode | (f.rd & 0x1F) << 7 | s.funct3 << 12 | (f.rs1 & 0x1F) << 15 |
+               (f.rs2 & 0x1F) << 20 | uint32_t(s.funct7) << 25;
+    case FMT_I:
+    case FMT_CSR:
+        return code | s.funct3 << 12 | (f.rs1 & 0x1F) << 15 | (imm & 0xFFF) << 20;
+    case FMT_S:
+        return s.opcode | (imm & 0x1F) << 7 | s.funct3 << 12 | (f.rs1 & 0x1F) << 15 |
+               (f.rs2 & 0x1F) << 20 | (imm >> 5 & 0x7F) << 25;
+    case FMT_B:
+        return s.opcode | (imm >> 10 & 0x1) << 7 | (imm & 0xF) << 8 | s.funct3 << 12 |
+               (f.rs1 & 0x1F) << 15 | (f.rs2 & 0x1F) << 20 | (imm >> 4 & 0x3F) << 25 |
+               (imm >> 11 & 0x1) << 31;
+    case FMT_U:
+        return code | (imm & 0xFFFFF) << 12;
+    case FMT_J:
+        return code | (imm >> 11 & 0xFF) << 12 | (imm >> 10 & 0x1) << 20 |
+               (imm & 0x3FF) << 21 | (imm >> 19 & 0x1) << 31;
+    }
+    return code;
+}
+
+/* 译码的结果，未知指令的spec为nullptr */
+struct Decoded {
+    const Spec* spec = nullptr;
+    Fields fields;
+};
+
+constexpr Decoded decode(uint32_t code) {
+    uint32_t opcode = code & 0x7F;
+    uint32_t funct3 = code >> 12 & 0x7;
+    uint32_t funct7 = code >> 25;
+
+    Decoded d;
+    for (const Spec& s : SPECS) {
+        if (s.opcode != opcode)
+            continue;
+        bool match = true;
+        switch (s.format) {
+        case FMT_R:
+            match = s.funct3 == funct3 && s.funct7 == funct7;
+            break;
+        case FMT_CSR:
+            match = s.funct3 == funct3 && (code >> 15 & 0x1F) == 0;
+            break;
+        case FMT_I:
+        case FMT_S:
+        case FMT_B:
+            match = s.funct3 == funct3;
+            break;
+        default:
+            break;
+        }
+        if (match) {
+            d.spec = &s;
+            break;
+        }
+    }
+    if (!d.spec)
+        return d;
+
+    Fields& f = d.fields;
+    switch (d.spec->format) {
+    case FMT_R:
+        f.rd = code >> 7 & 0x1F;
+        f.rs1 = code >> 15 & 0x1F;
+        f.rs2 = code >> 20 & 0x1F;
+        break;
+    case FMT_I:
+        f.rd = code >> 7 & 0x1F;
+        f.rs1 = code >> 15 & 0x1F;
+        f.imm = sext(code >> 20, 12);
+        break;
+    case FMT_CSR:
+        f.rd = code >> 7 & 0x1F;
+        f.imm = int32_t(code >> 20);
+        break;
+    case FMT_S:
+        f.rs1 = code >> 15 & 0x1F;
+        f.rs2 = code >> 20 & 0x1F;
+        f.imm = sext((code >> 25) << 5 | (code >> 7 & 0x1F), 12);
+        break;
+    case FMT_B:
+        f.rs1 = code >> 15 & 0x1F;
+        f.rs2 = code >> 20 & 0x1F;
+        f.imm = sext((code >> 31) << 11 | (code >> 7 & 0x1) << 10 | (code >> 25 & 0x3F) << 4 |
+                         (code >> 8 & 0xF),
+                     12);
+        break;
+    case FMT_U:
+        f.rd = code >> 7 & 0x1F;
+        f.imm = sext(code >> 12, 20);
+        break;
+    case FMT_J:
+        f.rd = code >> 7 & 0x1F;
+        f.imm = sext((code >> 31) << 19 | (code >> 12 & 0xFF) << 11 | (code >> 20 & 0x1) << 10 |
+                         (code >> 21 & 0x3FF),
+                     20);
+        break;
+    }
+    return d;
+}
+
+// 编译期检查每一条指令的编码都能译码回同一条指令
+constexpr bool encode_decode_consistent() {
+    for (const Spec& s : SPECS) {
+        Fields f;
+        f.rd = s.format == FMT_S || s.format == FMT_B ? 0 : 5;
+        f.rs1 = s.format == FMT_U || s.format == FMT_J || s.format == FMT_CSR ? 0 : 6;
+        f.rs2 = s.format == FMT_R || s.format == FMT_S || s.format == FMT_B ? 7 : 0;
+        f.imm = s.format == FMT_R ? 0 : s.format == FMT_CSR ? 0xC02 : -4;
+        Decoded d = decode(encode(s, f));
+        if (d.spec != &s || !(d.fields == f))
+            return false;
+    }
+    return true;
+}
+static_assert(encode_decode_consistent(), "指令表的编码和译码不一致");
+
+/* ---------------- 操作数的文本形式 ---------------- */
+
+inline int reg_idx(string_view r) {
+    if (r.size() < 2 || r[0] != 'x')
+        throw invalid_argument("非法寄存器名");
+    int idx = lexer::to_int(r.substr(1));
+    if (idx < 0 || idx > 31)
+        throw invalid_argument("寄存器编号超出范围");
+    return idx;
+}
+
+// CSR地址：数字，或cycle/time/instret/hpmcounter3~hpmcounter31
+inline int csr_idx(string_view name) {
+    if (name == "cycle")
+        return 0xC00;
+    if (name == "time")
+        return 0xC01;
+    if (name == "instret")
+        return 0xC02;
+    if (name.rfind("hpmcounter", 0) == 0) {
+        int n = lexer::to_int(name.substr(10));
+        if (n < 3 || n > 31)
+            throw invalid_argument("hpmcounter编号超出范围");
+        return 0xC00 + n;
+    }
+    int csr = lexer::to_int(name, 0);
+    if (csr < 0 || csr > 0xFFF)
+        throw invalid_argument("CSR地址超出范围");
+    return csr;
+}
+
+/**
+ * @brief 把地址拆成lui和addi的立即数：addr == (sext(hi) << 12) + sext(lo)
+ */
+inline void split_hi_lo(int64_t addr, int32_t& hi, int32_t& lo) {
+    lo = sext(uint32_t(addr) & 0xFFF, 12);
+    hi = sext(uint32_t((uint64_t(addr) - uint64_t(int64_t(lo))) >> 12) & 0xFFFFF, 20);
+}
+
+/**
+ * @brief 解析立即数：数字，或%hi(sym)/%lo(sym)（sym为标签或数字）
+ */
+template <typename Resolve>
+int32_t imm_value(string_view t, Resolve& resolve) {
+    if (t.size() > 5 && t[0] == '%' && t[3] == '(' && t.back() == ')') {
+        string_view fn = t.substr(1, 2), sym = t.substr(4, t.size() - 5);
+        if (fn != "hi" && fn != "lo")
+            throw invalid_argument("未知的立即数函数: " + string(t));
+        int64_t addr;
+        try {
+            addr = lexer::to_int64(sym);
+        } catch (...) {
+            addr = resolve(sym);
+        }
+        int32_t hi, lo;
+        split_hi_lo(addr, hi, lo);
+        return fn == "hi" ? hi : lo;
+    }
+    return lexer::to_int(t, 0);
+}
+
+/**
+ * @brief 按指令规格解析一行的操作数并编码
+ *
+ * @param tok 该行的token，tok[0]为助记符
+ * @param addr 下一条指令的地址，跳转偏移量相对于它计算
+ * @param resolve 把标签解析为地址，未定义的标签应抛出异常
+ */
+template <typename Resolve>
+uint32_t assemble(const Spec& s, const lexer::Tokens& tok, int addr, Resolve&& resolve) {
+    size_t n = s.operand_count();
+    if (tok.size() != n + 1)
+        throw runtime_error(string(s.mnemonic) + " 格式错误");
+
+    Fields f;
+    for (size_t i = 0; i < n; i++) {
+        string_view t = tok[i + 1];
+        switch (s.operands[i]) {
+        case OPD_RD:
+            f.rd = reg_idx(t);
+            break;
+        case OPD_RS1:
+            f.rs1 = reg_idx(t);
+            break;
+        case OPD_RS2:
+            f.rs2 = reg_idx(t);
+            break;
+        case OPD_IMM:
+            f.imm = imm_value(t, resolve);
+            break;
+        case OPD_CSR:
+            f.imm = csr_idx(t);
+            break;
+        case OPD_TARGET: {
+            int target;
+            try {
+                target = lexer::to_int(t, 0);
+            } catch (...) {
+                target = resolve(t);
+            }
+            f.imm = target - addr;
+            if (f.imm % 2 != 0)
+                throw runtime_error(string(s.mnemonic) + " 偏移未对齐");
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return encode(s, f);
+}
+
+/**
+ * @brief 反汇编一条指令，输出的文本可以由汇编器重新汇编为同一编码
+ *
+ * @param addr 下一条指令的地址，用于把跳转偏移量还原为目标地址
+ */
+inline string disassemble(uint32_t code, int addr) {
+    Decoded d = decode(code);
+    if (!d.spec)
+        return "unknown";
+
+    string text(d.spec->mnemonic);
+    for (size_t i = 0; i < d.spec->operand_count(); i++) {
+        text += ' ';
+        switch (d.spec->operands[i]) {
+        case OPD_RD:
+            text += 'x' + to_string(d.fields.rd);
+            break;
+        case OPD_RS1:
+            text += 'x' + to_string(d.fields.rs1);
+            break;
+        case OPD_RS2:
+            text += 'x' + to_string(d.fields.rs2);
+            break;
+        case OPD_IMM:
+            text += to_string(d.fields.imm);
+            break;
+        case OPD_TARGET:
+            text += to_string(addr + d.fields.imm);
+            break;
+        case OPD_CSR: {
+            static const char digits[] = "0123456789abcdef";
+            text += "0x";
+            for (int shift = 8; shift >= 0; shift -= 4)
+                text += digits[d.fields.imm >> shift & 0xF];
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return text;
+}
+
+} // namespace isa
+
+#endif // __ISA_HPP__
@@ -0,0 +1,263 @@
+#ifndef __LEXER_HPP__
+#define __LEXER_HPP__
+
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+namespace lexer {
+
+/**
+ * @brief 汇编器的输入：普通文件直接映射到内存，管道等无法映射的输入一次性读入缓冲区
+ *
+ * 词法分析得到的token都是指向这块内存的string_view，在Source析构之前有效。
+ */
+class Source {
+  public:
+    explicit Source(int fd) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                map_ = static_cast<const char*>(addr);
+                size_ = st.st_size;
+                // 只顺序扫描，提示内核提前读入
+                madvise(addr, size_, MADV_SEQUENTIAL);
+                return;
+            }
+        }
+
+        char chunk[1 << 16];
+        ssize_t n;
+        while ((n = read(fd, chunk, sizeof(chunk))) != 0) {
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw runtime_error("读取输入失败");
+            }
+            buffer_.insert(buffer_.end(), chunk, chunk + n);
+        }
+        size_ = buffer_.size();
+    }
+
+    ~Source() {
+        if (map_)
+            munmap(const_cast<char*>(map_), size_);
+    }
+
+    Source(const Source&) = delete;
+    Source& operator=(const Source&) = delete;
+
+    string_view text() const {
+        return string_view(map_ ? map_ : buffer_.data(), size_);
+    }
+
+  private:
+    const char* map_ = nullptr;
+    vector<char> buffer_;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief 一行中的token：前MAX_TOKENS个保存在固定数组中
+ *
+ * 只有.dword等数据伪操作的一行会超出MAX_TOKENS个，超出的部分放在overflow_中，
+ * overflow_的容量在各行之间复用，因此扫描时不会为每行分配内存。
+ */
+class Tokens {
+  public:
+    static constexpr size_t MAX_TOKENS = 8;
+
+    Tokens() = default;
+    Tokens(initializer_list<string_view> list) {
+        for (string_view t : list)
+            push_back(t);
+    }
+
+    void push_back(string_view t) {
+        if (n_ < MAX_TOKENS)
+            tok_[n_] = t;
+        else
+            overflow_.push_back(t);
+        n_++;
+    }
+
+    // 去掉第一个token（行首的标签）
+    void pop_front() {
+        for (size_t i = 1; i < n_; i++)
+            set(i - 1, (*this)[i]);
+        if (n_ > MAX_TOKENS)
+            overflow_.pop_back();
+        n_--;
+    }
+
+    void clear() {
+        n_ = 0;
+        overflow_.clear();
+    }
+    size_t size() const { return n_; }
+    bool empty() const { return n_ == 0; }
+    string_view operator[](size_t i) const {
+        return i < MAX_TOKENS ? tok_[i] : overflow_[i - MAX_TOKENS];
+    }
+
+  private:
+    void set(size_t i, string_view t) {
+        if (i < MAX_TOKENS)
+            tok_[i] = t;
+        else
+            overflow_[i - MAX_TOKENS] = t;
+    }
+
+    string_view tok_[MAX_TOKENS];
+    vector<string_view> overflow_;
+    size_t n_ = 0;
+};
+
+/**
+ * @brief 逐行扫描输入：去掉';'之后的注释，按空白切分token，不复制任何字符
+ */
+class Lexer {
+  public:
+    explicit Lexer(string_view text) : pos_(text.data()), end_(text.data() + text.size()) {}
+
+    /**
+     * @brief 读取下一个含有token的行
+     *
+     * @param tok 该行的token
+     * @return false 输入已经结束
+     */
+    bool next(Tokens& tok) {
+        while (pos_ < end_) {
+            const char* eol = static_cast<const char*>(memchr(pos_, '\n', end_ - pos_));
+            if (!eol)
+                eol = end_;
+            const char* p = pos_;
+            pos_ = eol + (eol < end_);
+            line_no_++;
+
+            const char* comment = static_cast<const char*>(memchr(p, ';', eol - p));
+            if (comment)
+                eol = comment;
+
+            tok.clear();
+            while (true) {
+                while (p < eol && is_space(*p))
+                    p++;
+                if (p == eol)
+                    break;
+                const char* start = p;
+                while (p < eol && !is_space(*p))
+                    p++;
+                tok.push_back(string_view(start, p - start));
+            }
+            if (!tok.empty())
+                return true;
+        }
+        return false;
+    }
+
+    // 最近一次next()返回的行的行号（从1开始）
+    int line_no() const { return line_no_; }
+
+  private:
+    static bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    const char* pos_;
+    const char* end_;
+    int line_no_ = 0;
+};
+
+/**
+ * @brief 把整个token解析为整数，语义与stoi相同（base为0时识别0x/0前缀），但不允许多余的字符
+ */
+inline int to_int(string_view s, int base = 10) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    bool neg = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        neg = (*p == '-');
+        p++;
+    }
+    if (base == 0) {
+        if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+            base = 16;
+            p += 2;
+        } else if (end - p > 1 && p[0] == '0') {
+            base = 8;
+        } else {
+            base = 10;
+        }
+    }
+
+    // 符号已经处理过，from_chars不能再看到第二个符号
+    if (p < end && (*p == '+' || *p == '-'))
+        throw invalid_argument("非法数字: " + string(s));
+
+    long long value = 0;
+    auto [ptr, ec] = from_chars(p, end, value, base);
+    if (ec == errc::result_out_of_range)
+        throw out_of_range("数字超出范围: " + string(s));
+    if (ec != errc() || ptr != end || p == end)
+        throw invalid_argument("非法数字: " + string(s));
+    value = neg ? -value : value;
+    if (value < INT_MIN || value > INT_MAX)
+        throw out_of_range("数字超出范围: " + string(s));
+    return int(value);
+}
+
+/**
+ * @brief 把整个token解析为64位整数（base为0时识别0x/0前缀），
+ *        十六进制和八进制可以写出全部64位（如0xFFFFFFFFFFFFFFFF），结果按补码返回
+ */
+inline int64_t to_int64(string_view s, int base = 0) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    bool neg = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        neg = (*p == '-');
+        p++;
+    }
+    if (base == 0) {
+        if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+            base = 16;
+            p += 2;
+        } else if (end - p > 1 && p[0] == '0') {
+            base = 8;
+        } else {
+            base = 10;
+        }
+    }
+    if (p < end && (*p == '+' || *p == '-'))
+        throw invalid_argument("非法数字: " + string(s));
+
+    unsigned long long value = 0;
+    auto [ptr, ec] = from_chars(p, end, value, base);
+    if (ec == errc::result_out_of_range)
+        throw out_of_range("数字超出范围: " + string(s));
+    if (ec != errc() || ptr != end || p == end)
+        throw invalid_argument("非法数字: " + string(s));
+    // 十进制只能表示有符号64位整数的范围
+    if (base == 10 && value > (neg ? 1ULL << 63 : (1ULL << 63) - 1))
+        throw out_of_range("数字超出范围: " + string(s));
+    return int64_t(neg ? 0 - value : value);
+}
+
+} // namespace lexer
+
+#endif // __LEXER_HPP__
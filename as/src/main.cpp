@@ -1,276 +1,422 @@
+#include "image.hpp"
+#include "isa.hpp"
+#include "lexer.hpp"
+#include "opt.hpp"
+#include "rvc.hpp"
+#include "section.hpp"
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>
-#include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
-#include <unordered_set>
-#include <utility>
 #include <vector>
 using namespace std;
 
-int reg_idx(const string& r) {
-    if (r.size() < 2 || r[0] != 'x')
-        throw invalid_argument("非法寄存器名");
-    int idx = stoi(r.substr(1));
-    if (idx < 0 || idx > 31)
-        throw invalid_argument("寄存器编号超出范围");
-    return idx;
+void write_uint32_be(vector<uint8_t>& out, uint32_t val) {
+    for (int i = 0; i < 4; ++i)
+        out.push_back((val >> (8 * (3 - i))) & 0xFF);
 }
 
-void write_uint32_be(ofstream& fout, uint32_t val) {
-    for (int i = 0; i < 4; ++i)
-        fout.put((val >> (8 * (3 - i))) & 0xFF);
+// 按大端序写入val的低bytes个字节
+void write_be(vector<uint8_t>& out, uint64_t val, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i)
+        out.push_back((val >> (8 * i)) & 0xFF);
 }
 
-void write_uint64_be(ofstream& fout, uint64_t val) {
-    for (int i = 0; i < 8; ++i)
-        fout.put((val >> (8 * (7 - i))) & 0xFF);
+// 指令（含伪指令）占用的字节数：la展开为lui和addi两条指令，li的长度取决于常数
+uint64_t instr_size(const lexer::Tokens& tok) {
+    if (tok[0] == "li")
+        return 4 * opt::expand_li(tok).size();
+    return tok[0] == "la" ? 8 : 4;
 }
 
-vector<string> tokenize(const string& line) {
-    vector<string> res;
-    stringstream ss(line);
-    string word;
-    while (ss >> word)
-        res.push_back(word);
-    return res;
+/**
+ * @brief 把只对应一条指令的伪指令（not、ret、rdcycle、rdinstret）换成实际的指令
+ */
+void rewrite_pseudo(lexer::Tokens& tok) {
+    string_view inst = tok[0];
+    if (inst == "not") {
+        if (tok.size() != 3)
+            throw runtime_error("not 格式错误");
+        tok = {"xori", tok[1], tok[2], "-1"};
+    } else if (inst == "ret") {
+        if (tok.size() != 1)
+            throw runtime_error("ret 格式错误");
+        // 与jalr使用同一行指令表，保证funct3与cpu的译码一致
+        tok = {"jalr", "x0", "x1", "0"};
+    } else if (inst == "rdcycle" || inst == "rdinstret") {
+        if (tok.size() != 2)
+            throw runtime_error(string(inst) + " 格式错误");
+        tok = {"csrr", tok[1], inst.substr(2)};
+    }
+}
+
+/**
+ * @brief 处理一条伪操作（以'.'开头）
+ *
+ * 第一遍out为nullptr，只推进位置计数器；第二遍把数据写入out（当前块对应的段）。
+ *
+ * @param tok 该行的token，tok[0]为伪操作
+ * @param layout 位置计数器
+ * @param out 当前块的内容，第一遍为nullptr
+ * @param resolve 把标签解析为地址（只在第二遍调用）
+ */
+template <typename Resolve>
+void directive(const lexer::Tokens& tok, section::Layout& layout, vector<uint8_t>* out,
+               Resolve&& resolve) {
+    string_view name = tok[0];
+    size_t argc = tok.size() - 1;
+
+    if (name == ".text" || name == ".data") {
+        // .text / .data [地址]
+        if (argc > (name == ".data" ? 1u : 0u))
+            throw runtime_error(string(name) + " 格式错误");
+        section::Kind kind = name == ".text" ? section::TEXT : section::DATA;
+        if (argc == 1)
+            layout.switch_to(kind, true, uint64_t(lexer::to_int64(tok[1])));
+        else
+            layout.switch_to(kind);
+    } else if (name == ".org") {
+        // .org 地址：当前节从该地址继续
+        if (argc != 1)
+            throw runtime_error(".org 格式错误");
+        layout.org(uint64_t(lexer::to_int64(tok[1])));
+    } else if (name == ".align") {
+        // .align n：按2^n字节对齐，用0填充
+        if (argc != 1)
+            throw runtime_error(".align 格式错误");
+        uint64_t pad = layout.padding(lexer::to_int(tok[1], 0));
+        if (out)
+            out->insert(out->end(), pad, 0);
+        layout.advance(pad);
+    } else if (name == ".space") {
+        // .space n [填充字节，默认0]
+        if (argc != 1 && argc != 2)
+            throw runtime_error(".space 格式错误");
+        int64_t n = lexer::to_int64(tok[1]);
+        if (n < 0)
+            throw runtime_error(".space 长度不能为负数");
+        int fill = argc == 2 ? lexer::to_int(tok[2], 0) : 0;
+        if (out)
+            out->insert(out->end(), size_t(n), uint8_t(fill));
+        layout.advance(uint64_t(n));
+    } else if (name == ".dword" || name == ".word" || name == ".half" || name == ".byte") {
+        // .dword/.word/.half/.byte 值...：值为数字或标签（标签的地址）
+        int bytes = name == ".dword" ? 8 : name == ".word" ? 4 : name == ".half" ? 2 : 1;
+        if (argc == 0)
+            throw runtime_error(string(name) + " 缺少数据");
+        if (out) {
+            for (size_t i = 1; i <= argc; i++) {
+                int64_t value;
+                try {
+                    value = lexer::to_int64(tok[i]);
+                } catch (invalid_argument&) {
+                    value = resolve(tok[i]);
+                }
+                if (bytes < 8) {
+                    int64_t limit = int64_t(1) << (8 * bytes);
+                    if (value < -limit / 2 || value >= limit)
+                        throw runtime_error(string(name) + " 数据超出范围: " +
+                                            string(tok[i]));
+                }
+                write_be(*out, uint64_t(value), bytes);
+            }
+        }
+        layout.advance(uint64_t(bytes) * argc);
+    } else {
+        throw runtime_error("未知伪操作: " + string(name));
+    }
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        cerr << "用法: assembler <output_file> [start_addr, 默认0x1000]\n";
+    // -O打开窥孔优化，-C打开压缩指令（见opt.hpp），可以出现在任意位置
+    bool optimize = false, compress = false;
+    vector<const char*> args;
+    for (int i = 1; i < argc; i++) {
+        if (string_view(argv[i]) == "-O")
+            optimize = true;
+        else if (string_view(argv[i]) == "-C")
+            compress = true;
+        else
+            args.push_back(argv[i]);
+    }
+    if (args.empty() || args.size() > 2) {
+        cerr << "用法: assembler [-O] [-C] <output_file> [start_addr, 默认0]\n";
         return 1;
     }
 
-    const char* output_file = argv[1];
-    uint64_t start_addr = (argc >= 3) ? strtoull(argv[2], nullptr, 0) : 0x1000;
+    const char* output_file = args[0];
+    // .text的装载地址，也是程序的入口
+    uint64_t start_addr = args.size() == 2 ? strtoull(args[1], nullptr, 0) : 0;
 
-    unordered_map<string, int> label_addr;
-    vector<pair<pair<int, int>, vector<string>>> program;
-    unordered_set<int> used;
-    string line;
-    int curr_addr = 0;
-    bool have_prev = true;
-    int line_no = 0;
+    // 输入（标准输入）整体映射到内存，标签和token都是指向它的string_view
+    lexer::Source source(STDIN_FILENO);
+    section::Layout layout(start_addr);
+    unordered_map<string_view, section::Location> labels;
+    lexer::Tokens tok;
 
     bool compile_status = true;
+    auto report = [&](int line, const exception& e) {
+        cerr << "错误（行数 " << line << "）：" << e.what() << "\n";
+        compile_status = false;
+    };
 
-    // 第一遍：记录地址、行数和标签
-    while (getline(cin, line)) {
-        ++line_no;
-        size_t comment = line.find(';');
-        if (comment != string::npos)
-            line = line.substr(0, comment);
-        line.erase(0, line.find_first_not_of(" \t\r\n"));
-        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+    // 优化时第一遍决定删除哪些指令（按指令的序号记录），第二遍跳过同样的指令
+    vector<bool> removed;
+    uint64_t dead_count = 0, branch_count = 0, reduced_count = 0;
+    // 尚未确定是否跳转到下一条指令的跳转：只有标签行和被删除的指令跟在它们之后，
+    // 还没有计入位置计数器；遇到目标标签时删除，遇到其他内容时再计入
+    struct Pending {
+        size_t index;
+        string_view target;
+        opt::Candidate cand;
+    };
+    vector<Pending> pending;
+    // 压缩时第一遍决定每条指令的长度，第二遍按同样的顺序查询
+    opt::Packer packer;
+    auto commit = [&] {
+        for (const Pending& p : pending)
+            layout.advance(compress ? packer.add(p.cand, layout.here()) : 4);
+        pending.clear();
+    };
+    // 跳转目标都是标签时，基本块只能从标签处开始，才能跟踪寄存器的常数值
+    bool numeric_jumps = false;
 
-        if (line.empty())
-            continue;
-        vector<string> tok = tokenize(line);
-        if (tok.empty())
-            continue;
+    // 标签的最终地址：place()之后每个块的地址都已确定
+    auto resolve = [&](string_view label) {
+        auto it = labels.find(label);
+        if (it == labels.end())
+            throw runtime_error("未定义标签: " + string(label));
+        return int64_t(layout.addr_of(it->second));
+    };
 
-        if (tok[0].back() == ':') {
-            string label = tok[0].substr(0, tok[0].size() - 1);
-            label_addr[label] = curr_addr;
-            tok.erase(tok.begin());
-            if (tok.empty())
-                continue;
-        }
+    // 第一遍：确定各节的布局和标签的位置，指令在第二遍重新扫描输入时再编码。
+    // 压缩的c.beqz/c.j在地址确定之后才知道偏移量是否超出范围，超出时放弃压缩它们并重新进行第一遍
+    for (;;) {
+        layout = section::Layout(start_addr);
+        labels.clear();
+        removed.clear();
+        dead_count = branch_count = 0;
+        pending.clear();
+        packer.reset();
+        numeric_jumps = false;
 
-        if (used.count(curr_addr)) {
-            cerr << "错误：地址重复：" << hex << curr_addr << '\n';
-            return 1;
+        lexer::Lexer scan(source.text());
+        while (scan.next(tok)) {
+            try {
+                if (tok[0].back() == ':') {
+                    string_view label = tok[0].substr(0, tok[0].size() - 1);
+                    while (!pending.empty() && pending.back().target == label) {
+                        removed[pending.back().index] = true;
+                        pending.pop_back();
+                        branch_count++;
+                    }
+                    commit();
+                    layout.advance(packer.flush());
+                    if (!labels.emplace(label, layout.here()).second)
+                        throw runtime_error("标签重复定义: " + string(label));
+                    tok.pop_front();
+                    if (tok.empty())
+                        continue;
+                }
+                if (tok[0][0] == '.') {
+                    commit();
+                    layout.advance(packer.flush());
+                    directive(tok, layout, nullptr, [](string_view) { return int64_t(0); });
+                    continue;
+                }
+                if (layout.kind() != section::TEXT)
+                    throw runtime_error("指令只能出现在.text中");
+                if (layout.addr() % 4 != 0)
+                    throw runtime_error("指令的地址没有4字节对齐");
+                uint64_t size = instr_size(tok);
+                opt::Candidate cand;
+                if (compress && tok[0] != "li" && tok[0] != "la") {
+                    lexer::Tokens plain = tok;
+                    rewrite_pseudo(plain);
+                    cand = opt::candidate(plain);
+                }
+                if (optimize) {
+                    removed.push_back(false);
+                    string_view target;
+                    if (opt::jump_target(tok, target) && opt::is_number(target))
+                        numeric_jumps = true;
+                    if (opt::dead(tok)) {
+                        removed.back() = true;
+                        dead_count++;
+                        continue;
+                    }
+                    if (opt::branch_to_label(tok, target)) {
+                        pending.push_back(Pending{removed.size() - 1, target, cand});
+                        continue;
+                    }
+                    commit();
+                }
+                if (!compress) {
+                    layout.advance(size);
+                    continue;
+                }
+                // li展开的每条指令分别压缩，la是两条不能压缩的指令
+                if (tok[0] == "li") {
+                    for (uint32_t c : opt::expand_li(tok)) {
+                        opt::Candidate part;
+                        part.ok = rvc::compress(c) != 0;
+                        layout.advance(packer.add(part, layout.here()));
+                    }
+                } else {
+                    for (uint64_t i = 0; i < size / 4; i++)
+                        layout.advance(packer.add(cand, layout.here()));
+                }
+            } catch (exception& e) {
+                report(scan.line_no(), e);
+            }
         }
-
-        used.insert(curr_addr);
-        have_prev = true;
-        curr_addr += 4;
-        program.emplace_back(make_pair(make_pair(curr_addr, line_no), tok));
+        commit();
+        layout.advance(packer.flush());
+        try {
+            layout.place();
+        } catch (exception& e) {
+            cerr << "错误：" << e.what() << "\n";
+            compile_status = false;
+        }
+        if (!compile_status || !compress || packer.check(layout, resolve))
+            break;
     }
 
-    ofstream fout(output_file, ios::binary);
-    if (!fout) {
-        cerr << "无法打开输出文件: " << output_file << '\n';
+    if (!compile_status) {
+        filesystem::remove(output_file);
         return 1;
     }
 
-    // write_uint32_be(fout, 0);
-    // write_uint64_be(fout, start_addr);
-    for (auto& [info, tok] : program) {
-        int addr = info.first;
-        int line = info.second;
-        string inst = tok[0];
-        uint32_t code = 0;
-
-    retry:
-        try {
-            if (inst == "not") {
-                if (tok.size() != 3)
-                    throw runtime_error("not 格式错误");
-                tok = {"xori", tok[1], tok[2], "-1"};
-                inst = "xori";
-            }
+    // 映像在内存中构建，最后一次写入输出文件：每个块是一个段
+    image::Writer img(start_addr);
+    for (const section::Chunk& c : layout.chunks()) {
+        size_t idx = img.add_segment(
+            c.addr, c.kind == section::TEXT ? image::SEG_CODE : image::SEG_DATA);
+        img.segment(idx).bytes.reserve(c.size);
+    }
 
-            if (inst == "ret") {
-                if (tok.size() != 1)
-                    throw runtime_error("ret 格式错误");
-                code = (0 << 20) | (1 << 15) | (0 << 12) | (0 << 7) | 0x67;
-                write_uint32_be(fout, code);
+    // 第二遍：逐行编码，addr为下一条指令的地址（跳转偏移相对于它计算）
+    layout.rewind();
+    lexer::Lexer lex(source.text());
+    opt::Constants consts;
+    size_t index = 0; // 指令的序号，与第一遍的removed对应
+    size_t unit = 0;  // 写出的指令的序号，与第一遍的packer对应
+    while (lex.next(tok)) {
+        if (tok[0].back() == ':') {
+            consts.clear();
+            tok.pop_front();
+            if (tok.empty())
                 continue;
+        }
+        int line = lex.line_no();
+        vector<uint8_t>& out = img.segment(layout.here().chunk).bytes;
+        // 写出一条指令；压缩时按第一遍的决定使用16位编码，否则优化时先尝试替换为更便宜的指令
+        auto emit = [&](uint32_t code) {
+            bool half = compress && packer.compressed(unit++);
+            if (optimize && !numeric_jumps) {
+                if (!half) {
+                    uint32_t better = consts.reduce(code);
+                    reduced_count += better != code;
+                    code = better;
+                }
+                consts.update(code);
+            }
+            if (!half) {
+                write_uint32_be(out, code);
+                return;
             }
+            uint16_t c = rvc::compress(code);
+            if (c == 0)
+                throw runtime_error("内部错误：第一遍判断能压缩的指令无法压缩");
+            write_be(out, c, 2);
+        };
 
-            if (inst == "blt")
-                throw runtime_error("不支持 blt 指令");
+        if (tok[0][0] == '.') {
+            try {
+                directive(tok, layout, &out, resolve);
+            } catch (exception& e) {
+                report(line, e);
+            }
+            continue;
+        }
 
-            if (inst == "lui") {
-                if (tok.size() != 3)
-                    throw runtime_error("lui 格式错误");
-                int rd = reg_idx(tok[1]);
-                int imm = stoi(tok[2], nullptr, 0);
-                code = (imm << 12) | (rd << 7) | 0x37;
-            } else if (inst == "ld") {
-                if (tok.size() != 4)
-                    throw runtime_error("ld 格式错误");
-                int rd = reg_idx(tok[1]);
-                int offset = stoi(tok[3]);
-                int rs1 = reg_idx(tok[2]);
-                code =
-                    (offset << 20) | (rs1 << 15) | (3 << 12) | (rd << 7) | 0x03;
-            } else if (inst == "sd") {
-                if (tok.size() != 4)
-                    throw runtime_error("sd 格式错误");
-                int rs2 = reg_idx(tok[1]);
-                int offset = stoi(tok[3]);
-                int rs1 = reg_idx(tok[2]);
-                code = ((offset >> 5) << 25) | (rs2 << 20) | (rs1 << 15) |
-                       (3 << 12) | ((offset & 0x1F) << 7) | 0x23;
-            } else if (inst == "add" || inst == "sub" || inst == "mul" ||
-                       inst == "and" || inst == "or" || inst == "xor" ||
-                       inst == "div" || inst == "sll" || inst == "srl") {
-                if (tok.size() != 4)
-                    throw runtime_error(inst + " 格式错误");
+        if (optimize && removed[index++])
+            continue;
 
-                int rd = reg_idx(tok[1]), rs1 = reg_idx(tok[2]),
-                    rs2 = reg_idx(tok[3]);
-                int funct3, funct7;
+        uint32_t code = 0;
 
-                if (inst == "add") {
-                    funct3 = 0;
-                    funct7 = 0x00;
-                } else if (inst == "sub") {
-                    funct3 = 0;
-                    funct7 = 0x20;
-                } else if (inst == "mul") {
-                    funct3 = 0;
-                    funct7 = 0x01;
-                } else if (inst == "div") {
-                    funct3 = 4;
-                    funct7 = 0x01;
-                } else if (inst == "and") {
-                    funct3 = 7;
-                    funct7 = 0x00;
-                } else if (inst == "or") {
-                    funct3 = 6;
-                    funct7 = 0x00;
-                } else if (inst == "xor") {
-                    funct3 = 4;
-                    funct7 = 0x00;
-                } else if (inst == "sll") {
-                    funct3 = 1;
-                    funct7 = 0x00;
-                } else if (inst == "srl") {
-                    funct3 = 5;
-                    funct7 = 0x00;
-                }
+        try {
+            // 压缩时一行的长度由第一遍决定（li可能展开为多条指令）
+            uint64_t size = instr_size(tok);
+            if (compress)
+                size = packer.bytes(unit, size / 4);
+            // c.beqz/c.j的偏移量相对于下一条指令（2字节之后）计算
+            int addr = int(layout.addr() + (compress && packer.compressed(unit) ? 2 : 4));
+            layout.advance(size);
 
-                code = (funct7 << 25) | (rs2 << 20) | (rs1 << 15) |
-                       (funct3 << 12) | (rd << 7) | 0x33;
-            } else if (inst == "xori" || inst == "addi") {
-                if (tok.size() != 4)
-                    throw runtime_error(inst + " 格式错误");
-                int rd = reg_idx(tok[1]), rs1 = reg_idx(tok[2]);
-                int imm = stoi(tok[3], nullptr, 0);
-                int funct3 = (inst == "xori" ? 4 : 0);
-                code = (imm << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) |
-                       0x13;
-            } else if (inst == "beq" || inst == "bge") {
-                if (tok.size() != 4)
-                    throw runtime_error(inst + " 格式错误");
-                int rs1 = reg_idx(tok[1]), rs2 = reg_idx(tok[2]);
-                int target;
-                try {
-                    target = stoi(tok[3], nullptr, 0);
-                } catch (...) {
-                    if (!label_addr.count(tok[3]))
-                        throw runtime_error("未定义标签: " + tok[3]);
-                    target = label_addr[tok[3]];
-                }
-                int offset = target - (addr);
-                if (offset % 2 != 0)
-                    throw runtime_error("beq 偏移未对齐");
+            rewrite_pseudo(tok);
+            string_view inst = tok[0];
 
-                int imm12 = (offset >> 11) & 1;
-                int imm10_5 = (offset >> 4) & 0x3F;
-                int imm4_1 = (offset >> 0) & 0xF;
-                int imm11 = (offset >> 10) & 1;
-                int funct3 = (inst == "beq") ? 0 : 5;
+            if (inst == "li") {
+                for (uint32_t c : opt::expand_li(tok))
+                    emit(c);
+                continue;
+            }
 
-                code = (imm12 << 31) | (imm10_5 << 25) | (rs2 << 20) |
-                       (rs1 << 15) | (funct3 << 12) | (imm4_1 << 8) |
-                       (imm11 << 7) | 0x63;
-            } else if (inst == "jal") {
+            // la rd sym：lui rd %hi(sym)；addi rd rd %lo(sym)
+            if (inst == "la") {
                 if (tok.size() != 3)
-                    throw runtime_error("jal 格式错误，应为: jal rd offset");
-
-                int rd = reg_idx(tok[1]);
-                int target;
+                    throw runtime_error("la 格式错误");
+                isa::Fields f;
+                f.rd = f.rs1 = isa::reg_idx(tok[1]);
+                int64_t target;
                 try {
-                    target = stoi(tok[2], nullptr, 0);
-                } catch (...) {
-                    if (!label_addr.count(tok[2]))
-                        throw runtime_error("未定义标签: " + tok[2]);
-                    target = label_addr[tok[2]];
+                    target = lexer::to_int64(tok[2]);
+                } catch (invalid_argument&) {
+                    target = resolve(tok[2]);
                 }
-
-                int offset = target - addr;
-                if (offset % 2 != 0)
-                    throw runtime_error("jal 偏移必须2字节对齐");
-
-                int imm = offset & 0x1FFFFF;
-                int imm20 = (imm >> 19) & 1;
-                int imm10_1 = (imm >> 0) & 0x3FF;
-                int imm11 = (imm >> 10) & 1;
-                int imm19_12 = (imm >> 11) & 0xFF;
-
-                code = (imm20 << 31) | (imm19_12 << 12) | (imm11 << 20) |
-                       (imm10_1 << 21) | (rd << 7) | 0x6F;
-            } else if (inst == "jalr") {
-                if (tok.size() != 4)
-                    throw runtime_error("jalr 格式错误");
-                int rd = reg_idx(tok[1]);
-                int imm = stoi(tok[3]);
-                int rs1 = reg_idx(tok[2]);
-                code = (imm << 20) | (rs1 << 15) | (0b010 << 12) | (rd << 7) |
-                       0x67;
-            } else {
-                throw runtime_error("未知指令: " + inst);
+                int32_t hi, lo;
+                isa::split_hi_lo(target, hi, lo);
+                f.imm = hi;
+                emit(isa::encode(*isa::lookup("lui"), f));
+                f.imm = lo;
+                emit(isa::encode(*isa::lookup("addi"), f));
+                continue;
             }
 
-            write_uint32_be(fout, code);
+            // 其余指令由指令表描述：按操作数的种类解析并按格式编码
+            const isa::Spec* spec = isa::lookup(inst);
+            if (!spec)
+                throw runtime_error("未知指令: " + string(inst));
+            code = isa::assemble(*spec, tok, addr, resolve);
+
+            emit(code);
         } catch (exception& e) {
-            cerr << "错误（行数 " << line << "）：" << e.what() << "\n";
-            compile_status = false;
+            report(line, e);
         }
     }
 
-    fout.close();
+    if (compile_status && !img.write(output_file)) {
+        cerr << "无法写入输出文件: " << output_file << '\n';
+        compile_status = false;
+    }
     if (compile_status) {
         cout << "汇编成功，输出文件: " << output_file << "\n";
+        if (optimize)
+            cout << "优化：删除了" << dead_count + branch_count << "条指令（无效运算"
+                 << dead_count << "条，跳转到下一条指令" << branch_count << "条），替换了"
+                 << reduced_count << "条mul/div\n";
+        if (compress) {
+            uint64_t before = 4 * packer.count(), saved = 2 * packer.compressed_count();
+            cout << "压缩：" << packer.compressed_count() << "条指令使用16位编码，代码从" << before
+                 << "字节减少到" << before - saved << "字节（减少" << fixed << setprecision(1)
+                 << (before ? 100.0 * saved / before : 0.0) << "%）\n";
+        }
         return 0;
     }
     // 如果编译失败，则删除编译的二进制文件
@@ -278,4 +424,4 @@ int main(int argc, char* argv[]) {
         filesystem::remove(output_file);
         return 1;
     }
-}
\ No newline at end of file
+}
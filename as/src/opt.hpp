@@ -0,0 +1,503 @@
+#ifndef __OPT_HPP__
+#define __OPT_HPP__
+
+#include "isa.hpp"
+#include "lexer.hpp"
+#include "rvc.hpp"
+#include "section.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/*
+ * 汇编器的优化：li伪指令的常数合成，-O打开的窥孔优化，以及-C打开的压缩指令。
+ *
+ * 窥孔优化分两部分：
+ *      删除指令（第一遍决定，标签的地址因此已经是删除之后的地址）：
+ *          没有效果的运算指令（写x0，或addi rd rd 0等恒等运算）
+ *          跳转到下一条指令的beq/bge/jal x0
+ *      替换指令（第二遍决定，长度不变）：
+ *          在基本块内跟踪取值已知的寄存器，把乘以/除以常数的mul/div
+ *          换成add、addi、sll或srl
+ *
+ * 压缩指令（见rvc.hpp）两条一组占据一个字，第一遍把相邻的两条能压缩的指令配成一组，
+ * 不能配对的指令仍使用32位编码；标签和伪操作处不跨越配对，因此标签总是4字节对齐。
+ * c.beqz/c.j的偏移量在第一遍结束之后才知道：先假定能够压缩，
+ * 偏移量超出范围时不再压缩这条指令，重新进行第一遍，直到所有压缩的跳转都在范围内。
+ */
+namespace opt {
+
+/* ---------------- li的常数合成 ---------------- */
+
+inline uint32_t encode(string_view mnemonic, uint32_t rd, uint32_t rs1, uint32_t rs2,
+                       int32_t imm) {
+    isa::Fields f;
+    f.rd = rd;
+    f.rs1 = rs1;
+    f.rs2 = rs2;
+    f.imm = imm;
+    return isa::encode(*isa::lookup(mnemonic), f);
+}
+
+inline bool fits12(int64_t v) { return v >= -2048 && v < 2048; }
+
+/* 没有临时寄存器时li最多展开的指令数，更长的序列由add左移而来，应改用临时寄存器 */
+constexpr size_t LI_MAX_WITHOUT_TMP = 8;
+
+/**
+ * @brief 左移s位：有临时寄存器时addi tmp x0 s；sll rd rd tmp，
+ *        否则（或s不超过2时）用s条add rd rd rd
+ */
+inline void shift_left(uint32_t rd, uint32_t tmp, int s, vector<uint32_t>& out) {
+    if (tmp && s > 2) {
+        out.push_back(encode("addi", tmp, 0, 0, s));
+        out.push_back(encode("sll", rd, rd, tmp, 0));
+        return;
+    }
+    for (int i = 0; i < s; i++)
+        out.push_back(encode("add", rd, rd, rd, 0));
+}
+
+/**
+ * @brief 只用lui、addi和左移把value写入x[rd]
+ */
+inline void li_shift(int64_t value, uint32_t rd, uint32_t tmp, vector<uint32_t>& out) {
+    if (fits12(value)) {
+        out.push_back(encode("addi", rd, 0, 0, int32_t(value)));
+        return;
+    }
+    // lui的结果按32位符号扩展，0x7FFFF800~0x7FFFFFFF等值无法用lui+addi得到
+    int32_t hi, lo;
+    isa::split_hi_lo(value, hi, lo);
+    if (int64_t(int32_t(uint32_t(hi) << 12)) + lo == value) {
+        out.push_back(encode("lui", rd, 0, 0, hi));
+        if (lo)
+            out.push_back(encode("addi", rd, rd, 0, lo));
+        return;
+    }
+
+    // 更宽的常数：先合成去掉低12位并右移之后的高位，再左移并加上低12位
+    lo = isa::sext(uint32_t(value) & 0xFFF, 12);
+    uint64_t rest = uint64_t(value) - uint64_t(int64_t(lo));
+    int s = __builtin_ctzll(rest);
+    li_shift(int64_t(rest) >> s, rd, tmp, out);
+    shift_left(rd, tmp, s, out);
+    if (lo)
+        out.push_back(encode("addi", rd, rd, 0, lo));
+}
+
+/**
+ * @brief 用最短的指令序列把value写入x[rd]，结果追加到out
+ *
+ * 在以下几种合成方式中取最短的一种：
+ *      lui、addi和左移（见li_shift）
+ *      先合成~value，再xori rd rd -1
+ *      高位为0时，先合成左移之后低位补1的值，再用srl右移（需要临时寄存器）
+ * 指令集中没有slli/srli，移位量需要先写入临时寄存器；没有临时寄存器时左移改用add。
+ *
+ * @param tmp 可以改写的临时寄存器，没有时为0
+ */
+inline void li(int64_t value, uint32_t rd, uint32_t tmp, vector<uint32_t>& out) {
+    vector<uint32_t> best;
+    li_shift(value, rd, tmp, best);
+
+    if (best.size() > 2) {
+        vector<uint32_t> seq;
+        li_shift(~value, rd, tmp, seq);
+        seq.push_back(encode("xori", rd, rd, 0, -1));
+        if (seq.size() < best.size())
+            best = seq;
+    }
+    int lz = value > 0 ? __builtin_clzll(uint64_t(value)) : 0;
+    if (tmp && lz > 0 && best.size() > 3) {
+        vector<uint32_t> seq;
+        li_shift(int64_t(uint64_t(value) << lz | ((uint64_t(1) << lz) - 1)), rd, tmp, seq);
+        seq.push_back(encode("addi", tmp, 0, 0, lz));
+        seq.push_back(encode("srl", rd, rd, tmp, 0));
+        if (seq.size() < best.size())
+            best = seq;
+    }
+    out.insert(out.end(), best.begin(), best.end());
+}
+
+/**
+ * @brief 展开一行li rd imm [tmp]，imm为64位的数字（标签的地址用la）
+ */
+inline vector<uint32_t> expand_li(const lexer::Tokens& tok) {
+    if (tok.size() != 3 && tok.size() != 4)
+        throw runtime_error("li 格式错误");
+    uint32_t rd = isa::reg_idx(tok[1]);
+    uint32_t tmp = tok.size() == 4 ? isa::reg_idx(tok[3]) : 0;
+    if (tmp && tmp == rd)
+        throw runtime_error("li 的临时寄存器不能与目标寄存器相同");
+    vector<uint32_t> out;
+    li(lexer::to_int64(tok[2]), rd, tmp, out);
+    if (!tmp && out.size() > LI_MAX_WITHOUT_TMP)
+        throw runtime_error("li 的常数需要" + to_string(out.size()) +
+                            "条指令，请给出临时寄存器：li rd imm tmp");
+    return out;
+}
+
+/* ---------------- 删除指令（第一遍） ---------------- */
+
+/**
+ * @brief 不依赖标签地址地译码一条指令：操作数中有标签或%hi/%lo时返回false
+ */
+inline bool decode_plain(const lexer::Tokens& tok, isa::Decoded& d) {
+    const isa::Spec* spec = isa::lookup(tok[0]);
+    if (!spec || spec->format == isa::FMT_B || spec->format == isa::FMT_J)
+        return false;
+    try {
+        d = isa::decode(isa::assemble(*spec, tok, 0, [](string_view) -> int64_t {
+            throw invalid_argument("标签");
+        }));
+    } catch (exception&) {
+        return false;
+    }
+    return d.spec != nullptr;
+}
+
+/**
+ * @brief 指令是否没有任何效果：运算结果写入x0，或者运算是恒等的
+ */
+inline bool dead(const lexer::Tokens& tok) {
+    isa::Decoded d;
+    if (!decode_plain(tok, d))
+        return false;
+    string_view m = d.spec->mnemonic;
+    const isa::Fields& f = d.fields;
+    bool alu = d.spec->opcode == 0x33 || d.spec->opcode == 0x13 || m == "lui";
+    if (!alu)
+        return false;
+    if (f.rd == 0)
+        return true;
+    if (m == "addi" || m == "xori")
+        return f.rs1 == f.rd && f.imm == 0;
+    if (m == "add" || m == "sub" || m == "or" || m == "xor" || m == "sll" || m == "srl")
+        if (f.rs1 == f.rd && f.rs2 == 0)
+            return true;
+    if (m == "add" || m == "or" || m == "xor")
+        if (f.rs1 == 0 && f.rs2 == f.rd)
+            return true;
+    if (m == "and" || m == "or")
+        return f.rs1 == f.rd && f.rs2 == f.rd;
+    return false;
+}
+
+/**
+ * @brief 取得beq/bge/jal的跳转目标（标签或数字地址）
+ *
+ * @return false 不是这三种指令，或者格式错误
+ */
+inline bool jump_target(const lexer::Tokens& tok, string_view& target) {
+    const isa::Spec* spec = isa::lookup(tok[0]);
+    if (!spec || (spec->format != isa::FMT_B && spec->format != isa::FMT_J) ||
+        tok.size() != spec->operand_count() + 1)
+        return false;
+    target = tok[tok.size() - 1];
+    return true;
+}
+
+inline bool is_number(string_view t) {
+    try {
+        lexer::to_int(t, 0);
+        return true;
+    } catch (exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief 指令是否是跳转到标签、且除跳转以外没有效果的beq/bge/jal x0
+ *
+ * @param target 返回跳转目标的标签
+ */
+inline bool branch_to_label(const lexer::Tokens& tok, string_view& target) {
+    if (!jump_target(tok, target) || is_number(target))
+        return false;
+    return tok[0] != "jal" || tok[1] == "x0";
+}
+
+/* ---------------- 替换指令（第二遍） ---------------- */
+
+/**
+ * @brief 基本块内取值已知的寄存器
+ *
+ * 每条写出的指令之后调用update()；遇到标签（可能的跳转目标）时调用clear()。
+ * jal/jalr之后被调用的代码可能改写任何寄存器，因此同样清空。
+ */
+class Constants {
+  public:
+    Constants() { clear(); }
+
+    void clear() {
+        for (int i = 1; i < 32; i++)
+            known_[i] = false;
+        known_[0] = true;
+        value_[0] = 0;
+    }
+
+    void update(uint32_t code) {
+        isa::Decoded d = isa::decode(code);
+        if (!d.spec)
+            return;
+        const isa::Fields& f = d.fields;
+        string_view m = d.spec->mnemonic;
+        if (m == "jal" || m == "jalr") {
+            clear();
+            return;
+        }
+        if (d.spec->format == isa::FMT_S || d.spec->format == isa::FMT_B || f.rd == 0)
+            return;
+
+        uint64_t a = value_[f.rs1], b = value_[f.rs2];
+        bool ka = known_[f.rs1], kb = known_[f.rs2];
+        bool known = false;
+        uint64_t v = 0;
+        if (m == "lui") {
+            known = true;
+            v = uint64_t(int64_t(int32_t(uint32_t(f.imm) << 12)));
+        } else if (m == "addi" || m == "xori") {
+            known = ka;
+            v = m == "addi" ? a + uint64_t(int64_t(f.imm)) : a ^ uint64_t(int64_t(f.imm));
+        } else if (d.spec->format == isa::FMT_R) {
+            known = ka && kb;
+            v = alu(m, a, b);
+        }
+        known_[f.rd] = known;
+        value_[f.rd] = v;
+    }
+
+    /**
+     * @brief 把乘以/除以已知常数的mul/div换成更便宜的一条指令
+     *
+     * @return 替换后的编码，不能替换时返回code本身
+     */
+    uint32_t reduce(uint32_t code) const {
+        isa::Decoded d = isa::decode(code);
+        if (!d.spec)
+            return code;
+        string_view m = d.spec->mnemonic;
+        if (m != "mul" && m != "div")
+            return code;
+        const isa::Fields& f = d.fields;
+        uint32_t rd = f.rd, a = f.rs1, b = f.rs2;
+
+        if (known_[a] && known_[b]) {
+            int64_t v = int64_t(alu(m, value_[a], value_[b]));
+            if (fits12(v))
+                return encode("addi", rd, 0, 0, int32_t(v));
+        }
+        // 乘法可交换：让b为取值已知的一方
+        if (m == "mul" && !known_[b] && known_[a])
+            swap(a, b);
+        if (!known_[b])
+            return code;
+
+        uint64_t c = value_[b];
+        if (c == 0)
+            return encode("addi", rd, 0, 0, 0); // div的除数为0时结果也为0
+        if (c == 1)
+            return encode("addi", rd, a, 0, 0);
+        if (m == "mul" && c == 2)
+            return encode("add", rd, a, a, 0);
+        if ((c & (c - 1)) == 0) {
+            // div为无符号除法，除以2^k即逻辑右移k位
+            int k = __builtin_ctzll(c);
+            for (uint32_t r = 1; r < 32; r++)
+                if (known_[r] && value_[r] == uint64_t(k))
+                    return encode(m == "mul" ? "sll" : "srl", rd, a, r, 0);
+        }
+        return code;
+    }
+
+  private:
+    static uint64_t alu(string_view m, uint64_t a, uint64_t b) {
+        if (m == "add")
+            return a + b;
+        if (m == "sub")
+            return a - b;
+        if (m == "mul")
+            return a * b;
+        if (m == "div")
+            return b ? a / b : 0;
+        if (m == "sll")
+            return a << (b & 0x3F);
+        if (m == "srl")
+            return a >> (b & 0x3F);
+        if (m == "and")
+            return a & b;
+        if (m == "or")
+            return a | b;
+        return a ^ b;
+    }
+
+    bool known_[32];
+    uint64_t value_[32] = {};
+};
+
+/* ---------------- 压缩指令（第一遍） ---------------- */
+
+/* 一条32位的指令能否压缩；c.beqz/c.j还要在地址确定之后检查偏移量 */
+struct Candidate {
+    bool ok = false;
+    string_view target; // c.beqz/c.j的跳转目标（标签或数字地址）
+    bool jump = false;  // c.j，否则为c.beqz
+};
+
+/**
+ * @brief 判断一行指令（不含伪指令）能否压缩，不抛出异常：格式错误的指令留给第二遍报错
+ */
+inline Candidate candidate(const lexer::Tokens& tok) {
+    Candidate c;
+    string_view target;
+    if (jump_target(tok, target)) {
+        // beq x8~x15 x0 目标：c.beqz；jal x0 目标：c.j
+        try {
+            if (tok[0] == "beq") {
+                int rs1 = isa::reg_idx(tok[1]);
+                c.ok = rs1 >= 8 && rs1 < 16 && isa::reg_idx(tok[2]) == 0;
+            } else if (tok[0] == "jal") {
+                c.ok = isa::reg_idx(tok[1]) == 0;
+                c.jump = true;
+            }
+        } catch (exception&) {
+            c.ok = false;
+        }
+        c.target = target;
+        return c;
+    }
+    isa::Decoded d;
+    c.ok = decode_plain(tok, d) && rvc::compress(isa::encode(*d.spec, d.fields)) != 0;
+    return c;
+}
+
+/**
+ * @brief 第一遍中把相邻的两条能压缩的指令配成一组，决定每条指令的长度
+ *
+ * 指令按第二遍写出的顺序依次加入（li展开的每条指令各算一条），序号在各次第一遍之间不变，
+ * 因此第二遍按同样的序号查询每条指令是否压缩。
+ */
+class Packer {
+  public:
+    /**
+     * @brief 重新开始第一遍；之前因偏移量超出范围而放弃压缩的指令保持不压缩
+     */
+    void reset() {
+        units_.clear();
+        waiting_ = false;
+    }
+
+    /**
+     * @brief 加入一条指令
+     *
+     * @param here 当前的位置（不含等待配对的指令）
+     * @return 位置计数器应当前进的字节数：等待配对时为0，配成一组时为两条指令的4字节
+     */
+    uint64_t add(const Candidate& c, section::Location here) {
+        size_t idx = units_.size();
+        units_.push_back(Unit{here, false, c.target, c.jump});
+        if (!c.ok || (idx < rejected_.size() && rejected_[idx])) {
+            // 等待配对的指令先使用32位编码，这条指令在它之后
+            uint64_t flushed = flush();
+            units_[idx].loc.offset += flushed;
+            return flushed + 4;
+        }
+        if (!waiting_) {
+            waiting_ = true;
+            return 0;
+        }
+        // 与等待的指令配成一组，第二条在第一条之后2字节处
+        waiting_ = false;
+        units_[idx - 1].compressed = units_[idx].compressed = true;
+        units_[idx].loc = units_[idx - 1].loc;
+        units_[idx].loc.offset += 2;
+        return 4;
+    }
+
+    /**
+     * @brief 标签、伪操作之前和第一遍结束时调用：等待配对的指令使用32位编码
+     *
+     * @return 位置计数器应当前进的字节数
+     */
+    uint64_t flush() {
+        if (!waiting_)
+            return 0;
+        waiting_ = false;
+        return 4;
+    }
+
+    /**
+     * @brief 第一遍结束、地址确定之后检查压缩的c.beqz/c.j的偏移量
+     *
+     * @param resolve 把标签解析为地址
+     * @return false 有跳转超出了范围，已经放弃压缩它们，需要重新进行第一遍
+     */
+    template <typename Resolve>
+    bool check(const section::Layout& layout, Resolve&& resolve) {
+        bool ok = true;
+        for (size_t i = 0; i < units_.size(); i++) {
+            const Unit& u = units_[i];
+            if (!u.compressed || u.target.empty())
+                continue;
+            bool fits = false;
+            try {
+                int64_t target = is_number(u.target) ? lexer::to_int64(u.target) : resolve(u.target);
+                int64_t offset = target - int64_t(layout.addr_of(u.loc) + 2);
+                int64_t limit = u.jump ? 2048 : 256;
+                fits = offset % 2 == 0 && offset >= -limit && offset < limit;
+            } catch (exception&) {
+                // 未定义的标签在第二遍报错
+            }
+            if (!fits) {
+                rejected_.resize(units_.size());
+                rejected_[i] = true;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    bool compressed(size_t idx) const { return units_[idx].compressed; }
+
+    /**
+     * @brief 从第first条开始的n条指令的总长度
+     */
+    uint64_t bytes(size_t first, size_t n) const {
+        uint64_t total = 0;
+        for (size_t i = first; i < first + n; i++)
+            total += units_[i].compressed ? 2 : 4;
+        return total;
+    }
+
+    size_t count() const { return units_.size(); }
+
+    size_t compressed_count() const {
+        size_t n = 0;
+        for (const Unit& u : units_)
+            n += u.compressed;
+        return n;
+    }
+
+  private:
+    struct Unit {
+        section::Location loc; // 指令的位置
+        bool compressed;       // 是否使用16位编码
+        string_view target;    // c.beqz/c.j的跳转目标，其余为空
+        bool jump;
+    };
+
+    vector<Unit> units_;
+    vector<bool> rejected_; // 偏移量超出范围、不再压缩的指令
+    bool waiting_ = false;  // 最后一条指令能压缩，正在等待下一条与它配对
+};
+
+} // namespace opt
+
+#endif // __OPT_HPP__
@@ -0,0 +1,314 @@
+#ifndef __RVC_HPP__
+#define __RVC_HPP__
+
+#include <cstdint>
+
+using namespace std;
+
+/*
+ * 压缩指令（RV64C的子集）：16位的编码，执行时展开为一条32位的指令。
+ *
+ * 编码与RV64C相同，只保留展开之后在指令表中的指令：
+ *      c.addi4spn c.lw c.ld c.sw c.sd
+ *      c.nop c.addi c.li c.addi16sp c.lui c.sub c.xor c.or c.and c.j c.beqz
+ *      c.lwsp c.ldsp c.jr c.mv c.jalr c.add c.swsp c.sdsp
+ * 与32位的指令一样，c.j和c.beqz的偏移量相对于下一条指令的地址（pc+2）。
+ *
+ * 指令在内存中按大端序存放，32位指令的低2位（11）在它的最后一个字节，
+ * 因此压缩指令总是两条一组，占据一个4字节对齐的字：高16位是第一条，低16位是第二条。
+ * 取指时，地址的第1位为1（一组中的第二条），或者该地址处32位的低2位不为11，
+ * 就是一条压缩指令，编码为这32位的高16位。32位的指令仍然4字节对齐。
+ */
+namespace rvc {
+
+/**
+ * @brief addr处读出的32位word是否以一条压缩指令开头（编码为word的高16位）
+ */
+constexpr bool is_compressed(uint64_t addr, uint32_t word) {
+    return (addr & 0x2) || (word & 0x3) != 0x3;
+}
+
+constexpr int32_t sext(uint32_t value, int bits) {
+    return int32_t(value << (32 - bits)) >> (32 - bits);
+}
+
+/* ---------------- 展开后的32位指令（格式与isa.hpp的encode相同） ---------------- */
+
+constexpr uint32_t r_type(uint32_t funct7, uint32_t rs2, uint32_t rs1, uint32_t funct3,
+                          uint32_t rd) {
+    return funct7 << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | 0x33;
+}
+
+constexpr uint32_t i_type(int32_t imm, uint32_t rs1, uint32_t funct3, uint32_t rd,
+                          uint32_t opcode) {
+    return (uint32_t(imm) & 0xFFF) << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+constexpr uint32_t s_type(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t funct3) {
+    uint32_t u = uint32_t(imm);
+    return (u >> 5 & 0x7F) << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | (u & 0x1F) << 7 |
+           0x23;
+}
+
+// beq rs1 x0 offset：偏移量不左移
+constexpr uint32_t beq(uint32_t rs1, int32_t offset) {
+    uint32_t u = uint32_t(offset);
+    return (u >> 11 & 0x1) << 31 | (u >> 4 & 0x3F) << 25 | rs1 << 15 | (u & 0xF) << 8 |
+           (u >> 10 & 0x1) << 7 | 0x63;
+}
+
+// jal x0 offset：偏移量不左移
+constexpr uint32_t jal(int32_t offset) {
+    uint32_t u = uint32_t(offset);
+    return (u >> 19 & 0x1) << 31 | (u & 0x3FF) << 21 | (u >> 10 & 0x1) << 20 |
+           (u >> 11 & 0xFF) << 12 | 0x6F;
+}
+
+// jalr的funct3为010
+constexpr uint32_t jalr(uint32_t rd, uint32_t rs1) { return i_type(0, rs1, 2, rd, 0x67); }
+
+/* ---------------- 展开 ---------------- */
+
+/**
+ * @brief 把一条压缩指令展开为32位的指令
+ *
+ * @return 保留的编码或不支持的压缩指令返回0（未知指令）
+ */
+constexpr uint32_t expand(uint16_t c) {
+    uint32_t op = c & 0x3, funct3 = c >> 13 & 0x7;
+    uint32_t rd = c >> 7 & 0x1F, rs2 = c >> 2 & 0x1F;
+    uint32_t rd_s = 8 + (c >> 2 & 0x7), rs1_s = 8 + (c >> 7 & 0x7); // x8~x15
+    int32_t imm6 = sext((c >> 7 & 0x20) | (c >> 2 & 0x1F), 6);       // imm[5|4:0]
+
+    // 各种立即数在编码中的位置与RV64C相同
+    uint32_t uimm_w = (c >> 7 & 0x38) | (c >> 4 & 0x4) | (c << 1 & 0x40);     // c.lw/c.sw
+    uint32_t uimm_d = (c >> 7 & 0x38) | (c << 1 & 0xC0);                      // c.ld/c.sd
+    uint32_t uimm_lwsp = (c >> 7 & 0x20) | (c >> 2 & 0x1C) | (c << 4 & 0xC0); // c.lwsp
+    uint32_t uimm_ldsp = (c >> 7 & 0x20) | (c >> 2 & 0x18) | (c << 4 & 0x1C0); // c.ldsp
+    uint32_t uimm_swsp = (c >> 7 & 0x3C) | (c >> 1 & 0xC0);                   // c.swsp
+    uint32_t uimm_sdsp = (c >> 7 & 0x38) | (c >> 1 & 0x1C0);                  // c.sdsp
+
+    switch (op << 3 | funct3) {
+    // c.addi4spn rd' nzuimm：addi rd' x2 nzuimm
+    case 0 << 3 | 0: {
+        uint32_t u = (c >> 7 & 0x30) | (c >> 1 & 0x3C0) | (c >> 4 & 0x4) | (c >> 2 & 0x8);
+        return u ? i_type(int32_t(u), 2, 0, rd_s, 0x13) : 0;
+    }
+    // c.lw/c.ld rd' uimm(rs1')
+    case 0 << 3 | 2:
+        return i_type(int32_t(uimm_w), rs1_s, 2, rd_s, 0x03);
+    case 0 << 3 | 3:
+        return i_type(int32_t(uimm_d), rs1_s, 3, rd_s, 0x03);
+    // c.sw/c.sd rs2' uimm(rs1')
+    case 0 << 3 | 6:
+        return s_type(int32_t(uimm_w), rd_s, rs1_s, 2);
+    case 0 << 3 | 7:
+        return s_type(int32_t(uimm_d), rd_s, rs1_s, 3);
+
+    // c.nop / c.addi rd nzimm：addi rd rd nzimm
+    case 1 << 3 | 0:
+        if (rd == 0 && imm6 == 0)
+            return i_type(0, 0, 0, 0, 0x13);
+        return rd && imm6 ? i_type(imm6, rd, 0, rd, 0x13) : 0;
+    // c.li rd imm：addi rd x0 imm
+    case 1 << 3 | 2:
+        return rd ? i_type(imm6, 0, 0, rd, 0x13) : 0;
+    // c.addi16sp nzimm：addi x2 x2 nzimm；c.lui rd nzimm：lui rd nzimm
+    case 1 << 3 | 3:
+        if (rd == 2) {
+            int32_t imm = sext((c >> 3 & 0x200) | (c >> 2 & 0x10) | (c << 1 & 0x40) |
+                                   (c << 4 & 0x180) | (c << 3 & 0x20),
+                               10);
+            return imm ? i_type(imm, 2, 0, 2, 0x13) : 0;
+        }
+        return rd && imm6 ? (uint32_t(imm6) & 0xFFFFF) << 12 | rd << 7 | 0x37 : 0;
+    // c.sub/c.xor/c.or/c.and rd' rs2'：op rd' rd' rs2'
+    case 1 << 3 | 4: {
+        if ((c >> 10 & 0x7) != 0x3)
+            return 0; // c.srli/c.srai/c.andi/c.subw/c.addw
+        uint32_t rs2_s = 8 + (c >> 2 & 0x7);
+        switch (c >> 5 & 0x3) {
+        case 0:
+            return r_type(0x20, rs2_s, rs1_s, 0, rs1_s);
+        case 1:
+            return r_type(0, rs2_s, rs1_s, 4, rs1_s);
+        case 2:
+            return r_type(0, rs2_s, rs1_s, 6, rs1_s);
+        default:
+            return r_type(0, rs2_s, rs1_s, 7, rs1_s);
+        }
+    }
+    // c.j offset：jal x0 offset
+    case 1 << 3 | 5:
+        return jal(sext((c >> 1 & 0x800) | (c >> 7 & 0x10) | (c >> 1 & 0x300) |
+                            (c << 2 & 0x400) | (c >> 1 & 0x40) | (c << 1 & 0x80) |
+                            (c >> 2 & 0xE) | (c << 3 & 0x20),
+                        12));
+    // c.beqz rs1' offset：beq rs1' x0 offset
+    case 1 << 3 | 6:
+        return beq(rs1_s, sext((c >> 4 & 0x100) | (c >> 7 & 0x18) | (c << 1 & 0xC0) |
+                                   (c >> 2 & 0x6) | (c << 3 & 0x20),
+                               9));
+
+    // c.lwsp/c.ldsp rd uimm(x2)
+    case 2 << 3 | 2:
+        return rd ? i_type(int32_t(uimm_lwsp), 2, 2, rd, 0x03) : 0;
+    case 2 << 3 | 3:
+        return rd ? i_type(int32_t(uimm_ldsp), 2, 3, rd, 0x03) : 0;
+    // c.jr/c.mv/c.jalr/c.add
+    case 2 << 3 | 4:
+        if (rd == 0)
+            return 0; // c.ebreak和保留的编码
+        if (!(c >> 12 & 0x1))
+            return rs2 ? r_type(0, rs2, 0, 0, rd) : jalr(0, rd);
+        return rs2 ? r_type(0, rs2, rd, 0, rd) : jalr(1, rd);
+    // c.swsp/c.sdsp rs2 uimm(x2)
+    case 2 << 3 | 6:
+        return s_type(int32_t(uimm_swsp), rs2, 2, 2);
+    case 2 << 3 | 7:
+        return s_type(int32_t(uimm_sdsp), rs2, 2, 3);
+
+    default:
+        return 0;
+    }
+}
+
+/* ---------------- 压缩 ---------------- */
+
+/**
+ * @brief 把一条32位的指令压缩为16位，expand(compress(code)) == code
+ *
+ * @return 不能压缩时返回0（0不是合法的压缩指令）
+ */
+constexpr uint16_t compress(uint32_t code) {
+    uint32_t opcode = code & 0x7F, funct3 = code >> 12 & 0x7, funct7 = code >> 25;
+    uint32_t rd = code >> 7 & 0x1F, rs1 = code >> 15 & 0x1F, rs2 = code >> 20 & 0x1F;
+    int32_t imm_i = sext(code >> 20, 12);
+    int32_t imm_s = sext((code >> 25) << 5 | (code >> 7 & 0x1F), 12);
+    auto small = [](uint32_t r) { return r >= 8 && r < 16; }; // x8~x15
+    auto fits = [](int32_t v, int32_t lo, int32_t hi) { return v >= lo && v <= hi; };
+    auto c = [](uint32_t funct3, uint32_t body, uint32_t op) {
+        return uint16_t(funct3 << 13 | body | op);
+    };
+
+    switch (opcode) {
+    case 0x13: { // addi
+        if (funct3 != 0)
+            return 0;
+        int32_t imm = imm_i;
+        uint32_t u = uint32_t(imm);
+        if (rd == 0 && rs1 == 0 && imm == 0)
+            return c(0, 0, 0x1); // c.nop
+        if (rd && rs1 == rd && imm && fits(imm, -32, 31))
+            return c(0, (u >> 5 & 0x1) << 12 | rd << 7 | (u & 0x1F) << 2, 0x1); // c.addi
+        if (rd && rs1 == 0 && fits(imm, -32, 31))
+            return c(2, (u >> 5 & 0x1) << 12 | rd << 7 | (u & 0x1F) << 2, 0x1); // c.li
+        if (rd == 2 && rs1 == 2 && imm && imm % 16 == 0 && fits(imm, -512, 496))
+            return c(3, (u >> 9 & 0x1) << 12 | 2 << 7 | (u >> 4 & 0x1) << 6 | (u >> 6 & 0x1) << 5 |
+                            (u >> 7 & 0x3) << 3 | (u >> 5 & 0x1) << 2,
+                     0x1); // c.addi16sp
+        if (small(rd) && rs1 == 2 && imm > 0 && imm % 4 == 0 && imm < 1024)
+            return c(0, (u >> 4 & 0x3) << 11 | (u >> 6 & 0xF) << 7 | (u >> 2 & 0x1) << 6 |
+                            (u >> 3 & 0x1) << 5 | (rd - 8) << 2,
+                     0x0); // c.addi4spn
+        return 0;
+    }
+    case 0x37: { // lui
+        int32_t imm = sext(code >> 12, 20);
+        uint32_t u = uint32_t(imm);
+        if (rd && rd != 2 && imm && fits(imm, -32, 31))
+            return c(3, (u >> 5 & 0x1) << 12 | rd << 7 | (u & 0x1F) << 2, 0x1); // c.lui
+        return 0;
+    }
+    case 0x33: { // add/sub/xor/or/and
+        if (funct7 == 0 && funct3 == 0 && rd && rs2) {
+            if (rs1 == 0)
+                return c(4, rd << 7 | rs2 << 2, 0x2); // c.mv
+            if (rs1 == rd)
+                return c(4, 1 << 12 | rd << 7 | rs2 << 2, 0x2); // c.add
+        }
+        uint32_t funct2 = funct7 == 0x20 && funct3 == 0 ? 0
+                          : funct7 == 0 && funct3 == 4  ? 1
+                          : funct7 == 0 && funct3 == 6  ? 2
+                          : funct7 == 0 && funct3 == 7  ? 3
+                                                        : 4;
+        if (funct2 < 4 && small(rd) && rs1 == rd && small(rs2))
+            return c(4, 0x3 << 10 | (rd - 8) << 7 | funct2 << 5 | (rs2 - 8) << 2, 0x1);
+        return 0;
+    }
+    case 0x03:   // lw/ld
+    case 0x23: { // sw/sd
+        if (funct3 != 2 && funct3 != 3)
+            return 0;
+        bool load = opcode == 0x03, d = funct3 == 3;
+        int32_t imm = load ? imm_i : imm_s;
+        uint32_t u = uint32_t(imm), data = load ? rd : rs2;
+        if (imm < 0 || u % (d ? 8 : 4) != 0)
+            return 0;
+        // 以x2为基址：c.lwsp/c.ldsp/c.swsp/c.sdsp
+        if (rs1 == 2 && u < (d ? 512u : 256u)) {
+            uint32_t funct = (load ? 2 : 6) + d;
+            if (load && rd == 0)
+                return 0;
+            if (load)
+                return c(funct, (u >> 5 & 0x1) << 12 | rd << 7 |
+                                    (d ? (u >> 3 & 0x3) << 5 | (u >> 6 & 0x7) << 2
+                                       : (u >> 2 & 0x7) << 4 | (u >> 6 & 0x3) << 2),
+                         0x2);
+            return c(funct,
+                     (d ? (u >> 3 & 0x7) << 10 | (u >> 6 & 0x7) << 7
+                        : (u >> 2 & 0xF) << 9 | (u >> 6 & 0x3) << 7) |
+                         rs2 << 2,
+                     0x2);
+        }
+        // x8~x15：c.lw/c.ld/c.sw/c.sd
+        if (small(data) && small(rs1) && u < (d ? 256u : 128u))
+            return c((load ? 2 : 6) + d,
+                     (u >> 3 & 0x7) << 10 | (rs1 - 8) << 7 |
+                         (d ? (u >> 6 & 0x3) << 5 : (u >> 2 & 0x1) << 6 | (u >> 6 & 0x1) << 5) |
+                         (data - 8) << 2,
+                     0x0);
+        return 0;
+    }
+    case 0x6F: { // jal x0
+        int32_t off = sext((code >> 31) << 19 | (code >> 12 & 0xFF) << 11 | (code >> 20 & 0x1) << 10 |
+                               (code >> 21 & 0x3FF),
+                           20);
+        uint32_t u = uint32_t(off);
+        if (rd || off % 2 != 0 || !fits(off, -2048, 2046))
+            return 0;
+        return c(5, (u >> 11 & 0x1) << 12 | (u >> 4 & 0x1) << 11 | (u >> 8 & 0x3) << 9 |
+                        (u >> 10 & 0x1) << 8 | (u >> 6 & 0x1) << 7 | (u >> 7 & 0x1) << 6 |
+                        (u >> 1 & 0x7) << 3 | (u >> 5 & 0x1) << 2,
+                 0x1); // c.j
+    }
+    case 0x67: // jalr x0/x1 rs1 0
+        if (funct3 != 2 || imm_i != 0 || rs1 == 0 || rd > 1)
+            return 0;
+        return c(4, rd << 12 | rs1 << 7, 0x2); // c.jr/c.jalr
+    case 0x63: { // beq rs1' x0
+        int32_t off = sext((code >> 31) << 11 | (code >> 7 & 0x1) << 10 | (code >> 25 & 0x3F) << 4 |
+                               (code >> 8 & 0xF),
+                           12);
+        uint32_t u = uint32_t(off);
+        if (funct3 != 0 || rs2 != 0 || !small(rs1) || off % 2 != 0 || !fits(off, -256, 254))
+            return 0;
+        return c(6, (u >> 8 & 0x1) << 12 | (u >> 3 & 0x3) << 10 | (rs1 - 8) << 7 |
+                        (u >> 6 & 0x3) << 5 | (u >> 1 & 0x3) << 3 | (u >> 5 & 0x1) << 2,
+                 0x1); // c.beqz
+    }
+    default:
+        return 0;
+    }
+}
+
+// 与RV64C一致的编码：c.nop、ld x1 8(x2)、sd x1 8(x2)、addi x2 x2 -48、addi x10 x2 16
+static_assert(expand(0x0001) == 0x00000013 && compress(0x00000013) == 0x0001, "c.nop");
+static_assert(compress(0x00813083) == 0x60A2 && compress(0x00113423) == 0xE406 &&
+                  compress(0xFD010113) == 0x7179 && compress(0x01010513) == 0x0808,
+              "压缩指令的编码与RV64C不一致");
+static_assert(expand(0x0000) == 0 && compress(0x0000C067) == 0, "非法的压缩指令");
+
+} // namespace rvc
+
+#endif // __RVC_HPP__
@@ -0,0 +1,163 @@
+#ifndef __SECTION_HPP__
+#define __SECTION_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace section {
+
+/* 汇编程序的两个节：.text放指令（也可以放数据），.data只放数据 */
+enum Kind : uint8_t {
+    TEXT,
+    DATA,
+};
+
+/* 没有指定地址的.data紧跟在.text之后，按页对齐，因此.align最多按页对齐 */
+constexpr uint64_t DATA_ALIGN = 4096;
+
+/* 一块地址连续的内容，对应映像中的一个段 */
+struct Chunk {
+    Kind kind;
+    bool placed;   // 地址是否已经确定（.text、.org和带地址的.data在创建时确定）
+    uint64_t addr; // 装载地址
+    uint64_t size; // 长度
+};
+
+/* 节中的位置：所在的块和块内偏移 */
+struct Location {
+    size_t chunk;
+    uint64_t offset;
+};
+
+/**
+ * @brief 记录两个节的位置计数器
+ *
+ * 第一遍扫描时建立各个块并确定长度，place()之后所有块的地址都已确定；
+ * 第二遍调用rewind()之后重放同样的.text/.data/.org，得到同样的块，此时每个位置的地址都是最终地址。
+ */
+class Layout {
+  public:
+    explicit Layout(uint64_t text_addr) : text_addr_(text_addr) { rewind(); }
+
+    /**
+     * @brief 切换到另一个节；.data可以指定地址，此时开始一个新的块
+     */
+    void switch_to(Kind kind, bool has_addr = false, uint64_t addr = 0) {
+        kind_ = kind;
+        if (has_addr)
+            start_chunk(true, addr);
+        else if (current_[kind] < 0)
+            start_chunk(kind == TEXT, kind == TEXT ? text_addr_ : 0);
+    }
+
+    /**
+     * @brief .org：当前节从addr处开始一个新的块
+     */
+    void org(uint64_t addr) { start_chunk(true, addr); }
+
+    Kind kind() const { return kind_; }
+
+    Location here() const {
+        size_t c = size_t(current_[kind_]);
+        return Location{c, chunks_[c].size};
+    }
+
+    /**
+     * @brief 当前位置的地址；第一遍中尚未确定地址的.data块返回块内偏移
+     */
+    uint64_t addr() const {
+        Location loc = here();
+        return chunks_[loc.chunk].addr + loc.offset;
+    }
+
+    /**
+     * @brief 按2^exp字节对齐时需要填充的字节数
+     */
+    uint64_t padding(int exp) const {
+        if (exp < 0 || (uint64_t(1) << exp) > DATA_ALIGN)
+            throw invalid_argument(".align 超出范围（0~12）");
+        uint64_t align = uint64_t(1) << exp;
+        return (align - addr() % align) % align;
+    }
+
+    void advance(uint64_t bytes) { chunks_[current_[kind_]].size += bytes; }
+
+    /**
+     * @brief 第一遍结束时确定所有块的地址，并检查块之间没有重叠
+     */
+    void place() {
+        uint64_t text_end = text_addr_;
+        for (const Chunk& c : chunks_)
+            if (c.kind == TEXT)
+                text_end = max(text_end, c.addr + c.size);
+        uint64_t next = (text_end + DATA_ALIGN - 1) / DATA_ALIGN * DATA_ALIGN;
+        for (Chunk& c : chunks_) {
+            if (!c.placed) {
+                c.addr = next;
+                c.placed = true;
+                next += c.size;
+            }
+        }
+
+        vector<Chunk> sorted(chunks_);
+        sort(sorted.begin(), sorted.end(),
+             [](const Chunk& a, const Chunk& b) { return a.addr < b.addr; });
+        for (size_t i = 1; i < sorted.size(); i++) {
+            const Chunk& prev = sorted[i - 1];
+            if (prev.size && sorted[i].size && prev.addr + prev.size > sorted[i].addr)
+                throw runtime_error("地址重叠：0x" + hex(prev.addr) + "开始的内容与0x" +
+                                    hex(sorted[i].addr) + "开始的内容重叠");
+        }
+    }
+
+    /**
+     * @brief 回到输入的开头，准备第二遍扫描：之后创建的块依次对应第一遍的块
+     */
+    void rewind() {
+        replayed_ = 0;
+        current_[TEXT] = current_[DATA] = -1;
+        kind_ = TEXT;
+        switch_to(TEXT);
+    }
+
+    const vector<Chunk>& chunks() const { return chunks_; }
+
+    uint64_t addr_of(Location loc) const { return chunks_[loc.chunk].addr + loc.offset; }
+
+  private:
+    void start_chunk(bool placed, uint64_t addr) {
+        // 第二遍：重放第一遍建立的块，地址用place()确定的最终地址
+        if (replayed_ < chunks_.size()) {
+            chunks_[replayed_].size = 0;
+        } else {
+            chunks_.push_back(Chunk{kind_, placed, addr, 0});
+        }
+        current_[kind_] = int(replayed_++);
+    }
+
+    static string hex(uint64_t v) {
+        static const char digits[] = "0123456789abcdef";
+        string s;
+        do {
+            s.insert(s.begin(), digits[v & 0xF]);
+            v >>= 4;
+        } while (v);
+        return s;
+    }
+
+    uint64_t text_addr_;
+    vector<Chunk> chunks_;
+    size_t replayed_ = 0;
+    int current_[2];
+    Kind kind_ = TEXT;
+};
+
+} // namespace section
+
+#endif // __SECTION_HPP__
@@ -0,0 +1,206 @@
+#include "../src/isa.hpp"
+#include "../src/lexer.hpp"
+#include "../src/opt.hpp"
+#include "../src/rvc.hpp"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+/**
+ * @brief 按格式产生合法的随机字段：不用的字段为0，立即数在格式能表示的范围内
+ */
+isa::Fields random_fields(const isa::Spec& s, mt19937& rng) {
+    auto bits = [&](int n) { return int32_t(rng() & ((1u << n) - 1)); };
+    isa::Fields f;
+    bool has_rd = s.format != isa::FMT_S && s.format != isa::FMT_B;
+    bool has_rs1 = s.format != isa::FMT_U && s.format != isa::FMT_J && s.format != isa::FMT_CSR;
+    bool has_rs2 = s.format == isa::FMT_R || s.format == isa::FMT_S || s.format == isa::FMT_B;
+    f.rd = has_rd ? bits(5) : 0;
+    f.rs1 = has_rs1 ? bits(5) : 0;
+    f.rs2 = has_rs2 ? bits(5) : 0;
+    switch (s.format) {
+    case isa::FMT_I:
+    case isa::FMT_S:
+        f.imm = isa::sext(bits(12), 12);
+        break;
+    case isa::FMT_B:
+        f.imm = isa::sext(bits(12), 12) & ~1; // 偏移量必须2字节对齐
+        break;
+    case isa::FMT_U:
+        f.imm = isa::sext(bits(20), 20);
+        break;
+    case isa::FMT_J:
+        f.imm = isa::sext(bits(20), 20) & ~1;
+        break;
+    case isa::FMT_CSR:
+        f.imm = bits(12);
+        break;
+    default:
+        break;
+    }
+    return f;
+}
+
+/**
+ * @brief 把反汇编的文本重新汇编
+ */
+uint32_t reassemble(const string& text, int addr) {
+    lexer::Lexer lex(text);
+    lexer::Tokens tok;
+    if (!lex.next(tok))
+        throw runtime_error("空的反汇编文本");
+    const isa::Spec* spec = isa::lookup(tok[0]);
+    if (!spec)
+        throw runtime_error("未知指令: " + string(tok[0]));
+    return isa::assemble(*spec, tok, addr, [](string_view label) -> int {
+        throw runtime_error("未定义标签: " + string(label));
+    });
+}
+
+/**
+ * @brief 按cpu的语义执行li展开得到的指令序列，返回x[rd]的值
+ */
+uint64_t run_li(const vector<uint32_t>& seq, uint32_t rd) {
+    uint64_t x[32] = {};
+    for (uint32_t code : seq) {
+        isa::Decoded d = isa::decode(code);
+        const isa::Fields& f = d.fields;
+        string_view m = d.spec ? d.spec->mnemonic : "unknown";
+        uint64_t a = x[f.rs1], b = x[f.rs2], imm = uint64_t(int64_t(f.imm));
+        uint64_t v;
+        if (m == "addi")
+            v = a + imm;
+        else if (m == "xori")
+            v = a ^ imm;
+        else if (m == "lui")
+            v = uint64_t(int64_t(int32_t(uint32_t(f.imm) << 12)));
+        else if (m == "add")
+            v = a + b;
+        else if (m == "sll")
+            v = a << (b & 0x3F);
+        else if (m == "srl")
+            v = a >> (b & 0x3F);
+        else
+            throw runtime_error("li 展开出了意外的指令: " + string(m));
+        if (f.rd)
+            x[f.rd] = v;
+    }
+    return x[rd];
+}
+
+int main(int argc, char** argv) {
+    uint32_t seed = argc > 1 ? stoul(argv[1]) : 1;
+    mt19937 rng(seed);
+    const int RANDOM_PER_SPEC = 2000;
+    int pass_count = 0, total = 0;
+
+    // 每条指令：助记符查找、编码->译码、编码->反汇编->汇编 都必须回到原处
+    for (const isa::Spec& s : isa::SPECS) {
+        total++;
+        bool ok = isa::lookup(s.mnemonic) == &s;
+        string failure;
+        for (int i = 0; i < RANDOM_PER_SPEC && ok; i++) {
+            isa::Fields f = random_fields(s, rng);
+            int addr = int(rng() & 0xFFFFFC) + 4;
+            uint32_t code = isa::encode(s, f);
+
+            isa::Decoded d = isa::decode(code);
+            string text = isa::disassemble(code, addr);
+            uint32_t again = 0;
+            try {
+                again = reassemble(text, addr);
+            } catch (exception& e) {
+                failure = e.what();
+            }
+            if (d.spec != &s || !(d.fields == f) || again != code) {
+                ok = false;
+                cout << "FAIL: " << s.mnemonic << " code=0x" << hex << code
+                     << " reassembled=0x" << again << dec << " text=\"" << text
+                     << "\" " << failure << endl;
+            }
+        }
+        if (ok)
+            pass_count++;
+    }
+
+    // 不在表中的助记符和编码（0x00008067是标准RISC-V的ret，这里jalr的funct3为010）
+    total++;
+    if (!isa::lookup("blt") && !isa::lookup("ad") && !isa::lookup("addii") &&
+        !isa::decode(0x00000000).spec && !isa::decode(0x0000C067).spec &&
+        !isa::decode(0x00008067).spec &&
+        !isa::decode(0xC00120F3).spec) {
+        pass_count++;
+    } else {
+        cout << "FAIL: unknown mnemonic or encoding accepted" << endl;
+    }
+
+    // li：随机的常数（各种有效位数，以及单独的一段1或0）展开之后必须得到原值，
+    // 12位的常数只需要1条指令；32位的常数不超过3条（lui的结果按32位符号扩展，
+    // 0x7FFFF800附近的值需要先合成按位取反的值）
+    total++;
+    bool li_ok = true;
+    for (int i = 0; i < 200000 && li_ok; i++) {
+        uint64_t value = uint64_t(rng()) << 32 | rng();
+        int bits = 1 + int(rng() % 64);
+        if (bits < 64)
+            value = uint64_t(int64_t(value << (64 - bits)) >> (64 - bits));
+        if (i % 4 == 1)
+            value = ~uint64_t(0) >> (rng() % 64) << (rng() % 64);
+        if (i % 4 == 2)
+            value = ~value;
+        vector<uint32_t> seq;
+        opt::li(int64_t(value), 5, i % 2 ? 6 : 0, seq);
+        uint64_t got = 0;
+        try {
+            got = run_li(seq, 5);
+        } catch (exception& e) {
+            cout << "FAIL: " << e.what() << endl;
+        }
+        int64_t sv = int64_t(value);
+        size_t limit = opt::fits12(sv) ? 1 : sv == int64_t(int32_t(sv)) ? 3 : seq.size();
+        if (got != value || seq.size() > limit) {
+            li_ok = false;
+            cout << "FAIL: li 0x" << hex << value << " -> 0x" << got << dec << " ("
+                 << seq.size() << " instructions)" << endl;
+        }
+    }
+    pass_count += li_ok;
+
+    // 压缩指令：每个合法的16位编码都展开为指令表中的指令，并且能压缩回展开前的样子；
+    // 随机的32位指令能压缩时，展开之后必须得到原来的编码
+    total++;
+    bool rvc_ok = true;
+    for (uint32_t c = 0; c < 0x10000 && rvc_ok; c++) {
+        uint32_t code = rvc::expand(uint16_t(c));
+        if (code && (!isa::decode(code).spec || rvc::expand(rvc::compress(code)) != code)) {
+            rvc_ok = false;
+            cout << "FAIL: compressed 0x" << hex << c << " -> 0x" << code << dec << endl;
+        }
+    }
+    for (const isa::Spec& s : isa::SPECS) {
+        for (int i = 0; i < RANDOM_PER_SPEC && rvc_ok; i++) {
+            isa::Fields f = random_fields(s, rng);
+            // 让寄存器和立即数常落在压缩指令能表示的范围内
+            if (i % 2) {
+                f.rd = f.rd ? 8 + f.rd % 8 : 0;
+                f.rs1 = i % 4 == 1 ? 2 : f.rs1 ? 8 + f.rs1 % 8 : 0;
+                f.rs2 = f.rs2 ? 8 + f.rs2 % 8 : 0;
+                f.imm = s.format == isa::FMT_CSR ? f.imm : f.imm % 64 & ~7;
+            }
+            uint32_t code = isa::encode(s, f);
+            uint16_t c = rvc::compress(code);
+            if (c && rvc::expand(c) != code) {
+                rvc_ok = false;
+                cout << "FAIL: " << isa::disassemble(code, 0) << " compressed to 0x" << hex << c
+                     << " -> 0x" << rvc::expand(c) << dec << endl;
+            }
+        }
+    }
+    pass_count += rvc_ok;
+
+    cout << "ISA Test: " << pass_count << "/" << total << " pass_count\n";
+    return pass_count == total ? 0 : 1;
+}
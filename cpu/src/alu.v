@@ -1,21 +1,34 @@
 /*
  * 模块：ALU模块
  * 简述：提供64位运算单元，支持加减乘除、位移、逻辑运算。
+ *       加减、位移和逻辑运算在en的上升沿完成；
+ *       乘法和除法由多周期的mul.v和div.v完成，不再决定整个cpu的关键路径：
+ *          start在clk上升沿有效时开始运算，done有效后result才是运算结果；
+ *          乘法固定在start之后的第3个上升沿完成，
+ *          除法在start之后的第n个上升沿完成（n为被除数的有效2位数字个数，见div.v）。
  * 输入：
- *      en   ：使能信号
- *      opcode ：操作码
+ *      clk      ：时钟信号（乘法和除法）
+ *      en       ：使能信号
+ *      start    ：开始一次乘法或除法（由opcode选择）
+ *      opcode   ：操作码
  *      operand1 ：操作数A
  *      operand2 ：操作数B
  * 输出：
- *      result ：运算结果
+ *      result   ：运算结果
+ *      busy     ：乘法器或除法器正在运算
+ *      done     ：opcode对应的运算已经完成（乘除法以外的运算恒为1）
  */
 module alu(
+    input clk,
     input en,
+    input start,
     input [7:0]  opcode,
     input [63:0] operand1,
     input [63:0] operand2,
 
-    output reg [63:0] result
+    output [63:0] result,
+    output busy,
+    output done
 );
 
 // 操作码定义
@@ -36,26 +49,57 @@ localparam [7:0]
     
     OP_LUI  = OP_XOR + 1;
 
+// 单周期运算的结果
+reg [63:0] alu_result;
+
 always @(posedge en) begin
     case(opcode)
-        OP_ADD:  result = operand1 + operand2;
-        OP_ADDI: result = operand1 + operand2;
-        OP_SUB:  result = operand1 - operand2;
-        OP_MUL:  result = operand1 * operand2;
-        OP_DIV:  result = operand1 / operand2;
-
-        OP_SLL:  result = operand1 << operand2[5:0];  // 移位量取低6位
-        OP_SRL:  result = operand1 >> operand2[5:0];
+        OP_ADD:  alu_result = operand1 + operand2;
+        OP_ADDI: alu_result = operand1 + operand2;
+        OP_SUB:  alu_result = operand1 - operand2;
+
+        OP_SLL:  alu_result = operand1 << operand2[5:0];  // 移位量取低6位
+        OP_SRL:  alu_result = operand1 >> operand2[5:0];
         
-        OP_AND:  result = operand1 & operand2;
-        OP_OR:   result = operand1 | operand2;
-        OP_NOT:  result = ~(operand1);
-        OP_XOR:  result = operand1 ^ operand2;
+        OP_AND:  alu_result = operand1 & operand2;
+        OP_OR:   alu_result = operand1 | operand2;
+        OP_NOT:  alu_result = ~(operand1);
+        OP_XOR:  alu_result = operand1 ^ operand2;
 
-        OP_LUI:  result = operand2<<12;
+        OP_LUI:  alu_result = operand2<<12;
 
-        default: result = 64'b0;
+        default: alu_result = 64'b0;
     endcase
 end
 
+// 乘法器和除法器
+wire is_mul = (opcode == OP_MUL);
+wire is_div = (opcode == OP_DIV);
+wire mul_busy, mul_done, div_busy, div_done;
+wire [63:0] mul_result, div_result;
+
+mul mul_inst(
+    .clk(clk),
+    .start(start && is_mul),
+    .a(operand1),
+    .b(operand2),
+    .busy(mul_busy),
+    .done(mul_done),
+    .result(mul_result)
+);
+
+div div_inst(
+    .clk(clk),
+    .start(start && is_div),
+    .a(operand1),
+    .b(operand2),
+    .busy(div_busy),
+    .done(div_done),
+    .result(div_result)
+);
+
+assign result = is_mul ? mul_result : is_div ? div_result : alu_result;
+assign busy = mul_busy || div_busy;
+assign done = is_mul ? mul_done : is_div ? div_done : 1'b1;
+
 endmodule
\ No newline at end of file
@@ -6,7 +6,21 @@ module cpu (
     output [63:0] bus_addr, // 地址总线
     output ram_cs, // ram的使能信号
     output ram_we, // ram的写使能信号
-    output ram_oe // ram的读使能信号
+    output ram_oe, // ram的读使能信号
+    output [7:0] ram_be, // ram写入的字节使能
+    input mem_ready, // 本周期ram的读写可以完成（见membus.v）
+    output mem_restart, // 本周期的请求不是上一个周期等待的那一次（见membus.v）
+
+    // 观测接口，供仿真程序统计指令和判断停机
+    output dbg_retire, // 一条指令执行完毕（持续一个时钟周期）
+    output [63:0] dbg_pc, // 当前（或刚退休的）指令的地址
+    output [31:0] dbg_instr, // 当前（或刚退休的）指令
+    output dbg_store, // 刚退休的指令写了内存（sb/sh/sw/sd）
+    output [63:0] dbg_store_addr, // 写入的地址
+    output [63:0] dbg_store_data, // 写入的数据（x[rs2]的低位字节，零扩展）
+    output [63:0] dbg_fetch_hits, // 取指缓冲命中次数
+    output [63:0] dbg_fetch_misses, // 取指缓冲未命中次数
+    output dbg_halt // 控制器遇到未知指令而停机
 );
 
     // 程序计数器相关
@@ -18,6 +32,16 @@ module cpu (
     // 指令寄存器相关
     wire ir_en;
     wire [31:0] instr_raw;
+
+    // 取指缓冲相关
+    wire fb_hit;
+    wire [31:0] fb_instr;
+    wire [31:0] fetch_word; // 从pc开始的4个字节
+    wire fetch_rvc; // pc处是一条压缩指令（见rvc.v）
+    wire [31:0] rvc_instr; // 压缩指令展开之后的指令
+    reg instr_rvc; // IR中的指令是压缩指令，离开取指状态时pc+2
+    wire fb_inv;
+    wire fetch_done; // 本周期的取指完成：取指缓冲命中，或ram的读取可以完成
     
     // 寄存器文件相关
     wire reg_en;
@@ -31,8 +55,31 @@ module cpu (
     wire [63:0] alu_result;
     wire [7:0] alu_op;
     wire [1:0] op2_dir;
+    wire alu_start, alu_done;
     wire alu_zero;
 
+    // 分支比较器：beq比较是否相等，bge为有符号比较
+    wire br_eq, br_ge;
+    wire br_taken, jump; // 本周期beq/bge跳转，本周期执行jal/jalr
+
+    // 访存相关：读出数据的扩展，写入数据的对齐和字节使能
+    wire [63:0] load_value, store_bus, store_value;
+
+    // 性能计数器相关
+    wire [63:0] csr_value;
+    wire mem_wait; // 本周期等待ram完成读写
+
+    // 观测接口相关
+    wire fetch;
+    reg instr_valid; // IR中已经装入过指令
+    reg [63:0] instr_pc; // IR中指令的地址
+    reg fetch_stalled; // 上一个周期在FETCH状态等待ram，本周期仍是同一次取指
+
+    initial begin
+        fetch_stalled = 1'b0;
+        instr_rvc = 1'b0;
+    end
+
     pc pc_inst(
         .clk(clk),
         .en(pc_en),
@@ -43,18 +90,48 @@ module cpu (
             // jalr
             pc_in_dir==2'b10 ? reg_data1+{{52{instr_raw[31]}}, instr_raw[31:20]} : 
             // beq
-            pc_in_dir==2'b00 && alu_result == 64'b0 ? pc_addr+{{52{instr_raw[31]}}, {instr_raw[31],instr_raw[7],instr_raw[30:25],instr_raw[11:8]}} :
+            pc_in_dir==2'b00 && br_eq ? pc_addr+{{52{instr_raw[31]}}, {instr_raw[31],instr_raw[7],instr_raw[30:25],instr_raw[11:8]}} :
             // bge
-            pc_in_dir==2'b11 && alu_result[63] == 1'b0 ? pc_addr+{{52{instr_raw[31]}}, {instr_raw[31],instr_raw[7],instr_raw[30:25],instr_raw[11:8]}} :
+            pc_in_dir==2'b11 && br_ge ? pc_addr+{{52{instr_raw[31]}}, {instr_raw[31],instr_raw[7],instr_raw[30:25],instr_raw[11:8]}} :
             pc_addr + 64'b0
         ),
         .sign(pc_sign),
+        .half(instr_rvc),
         .pc_addr(pc_addr)
     );
 
+    // 取指缓冲在取指完成、离开FETCH状态的时钟上升沿更新，因此整个FETCH状态中fb_hit保持不变；
+    // 跳转或sd在离开执行状态的时钟上升沿作废缓冲
+    fetchbuf fetchbuf_inst(
+        .clk(clk),
+        .en(fetch && fetch_done),
+        .inv(fb_inv),
+        .addr(pc_addr),
+        .ram_data(bus_data),
+        .hit(fb_hit),
+        .instr(fb_instr),
+        .hit_count(dbg_fetch_hits),
+        .miss_count(dbg_fetch_misses)
+    );
+
+    assign fb_inv = ram_we || br_taken || jump;
+    assign fetch_done = fb_hit || mem_ready;
+    assign mem_wait = (ram_oe || ram_we) && !mem_ready;
+    // 每个状态一直保持请求直到完成，请求不会在等待中被替换
+    assign mem_restart = 1'b0;
+
+    // 取指缓冲命中时使用缓冲中的指令，否则使用bus_data的高32位；压缩指令在装入IR之前展开
+    assign fetch_word = fb_hit ? fb_instr : bus_data[63:32];
+    assign fetch_rvc = pc_addr[1] || fetch_word[1:0] != 2'b11;
+
+    rvc rvc_inst(
+        .c(fetch_word[31:16]),
+        .instr(rvc_instr)
+    );
+
     ir ir_inst(
         .en(ir_en),
-        .instr_in(bus_data[63:32]), // 将bus_data的高32位作为指令缓存
+        .instr_in(fetch_rvc ? rvc_instr : fetch_word),
         .instr_out(instr_raw)
     );
 
@@ -70,29 +147,87 @@ module cpu (
 
         .we(reg_we), // 写输入数据到rd寄存器
         // rd寄存器的值，只可能来自ALU/RAM/PC
-        .write_data(reg_in_dir==2'b01 ? bus_data : 
+        .write_data(reg_in_dir==2'b01 ? load_value : 
                     reg_in_dir==2'b10 ? alu_result :
                     reg_in_dir==2'b11 ? pc_addr :
-                    64'bZ
+                    csr_value
                     )
     );
 
+    // IR在取指状态的时钟下降沿装入指令，此时pc尚未+4（压缩指令+2）
+    always @(posedge ir_en) begin
+        instr_valid <= 1'b1;
+        instr_pc <= pc_addr;
+        instr_rvc <= fetch_rvc;
+    end
+
+    always @(posedge clk) begin
+        fetch_stalled <= fetch && !fetch_done;
+    end
+
+    assign br_eq = (reg_data1 == reg_data2);
+    assign br_ge = ($signed(reg_data1) >= $signed(reg_data2));
+    assign br_taken = pc_sign && ((pc_in_dir == 2'b00 && br_eq) || (pc_in_dir == 2'b11 && br_ge));
+    assign jump = pc_sign && (pc_in_dir == 2'b01 || pc_in_dir == 2'b10);
+
+    // 性能计数器：在离开状态的时钟上升沿计数
+    perf perf_inst(
+        .clk(clk),
+        .en(!dbg_halt),
+        .retire(dbg_retire),
+        // 执行状态的最后一个周期：IR中的指令已经装入、不处于取指状态，且乘除法和访存已经完成
+        .exec(instr_valid && !fetch && alu_done && !mem_wait),
+        .instr(instr_raw),
+        // 整个FETCH状态中fb_hit不变，ram_oe即是否从ram取指；访存在mem_ready有效的周期完成
+        .mem_read(ram_oe && mem_ready),
+        .mem_write(ram_we && mem_ready),
+        .br_taken(br_taken),
+        // 多周期cpu没有流水线的停顿和冲刷
+        .stall_load(1'b0),
+        .stall_mem(1'b0),
+        .flush(1'b0),
+        .stall_bus(mem_wait),
+        .csr(instr_raw[31:20]),
+        .value(csr_value)
+    );
+
+    // 回到取指状态时，IR中的指令已经执行完毕；取指等待ram时只在FETCH状态的第一个周期退休
+    assign dbg_retire = fetch && instr_valid && !fetch_stalled;
+    assign dbg_pc = instr_pc;
+    assign dbg_instr = instr_raw;
+    // 取指状态下IR和寄存器文件的输出仍对应刚退休的指令，写内存的指令不改变寄存器
+    assign dbg_store = instr_raw[14] == 1'b0 && instr_raw[6:0] == 7'b0100011;
+    assign dbg_store_addr = reg_data1+{{52{instr_raw[31]}}, instr_raw[31:25], instr_raw[11:7]};
+    assign dbg_store_data = store_value;
+
     // 向数据总线写数据，ram信号由controller控制
     assign bus_addr = 
     // 从ram读取pc地址指向的指令到ir
-    (ram_oe && pc_en) ? pc_addr : 
+    (ram_oe && fetch) ? pc_addr : 
     
-    // 从ram的x[rs1]+sign-extend(offset)地址出读取8个字节的数据到x[rd]   ld指令
+    // 从ram的x[rs1]+sign-extend(offset)地址处读取数据到x[rd]   lb/lh/lw/ld/lbu/lhu/lwu指令
     (ram_oe) ? reg_data1+{{52{instr_raw[31]}}, instr_raw[31:20]} : 
     
-    // 将x[rs2]写入ram的x[rs1]+sign-extend(offset)地址   sd指令
+    // 将x[rs2]写入ram的x[rs1]+sign-extend(offset)地址   sb/sh/sw/sd指令
     (ram_we) ? reg_data1+{{52{instr_raw[31]}}, instr_raw[31:25], instr_raw[11:7]} : 
     64'bZ;
-    assign bus_data = (ram_we) ? reg_data2 : 64'bZ;
+    assign bus_data = (ram_we) ? store_bus : 64'bZ;
+
+    lsu lsu_inst(
+        .funct3(instr_raw[14:12]),
+        .ram_data(bus_data),
+        .store_data(reg_data2),
+        .load_value(load_value),
+        .bus_data(store_bus),
+        .be(ram_be),
+        .store_value(store_value)
+    );
 
     // alu 只对来自寄存器的数据/立即数进行运算
     alu alu_inst(
+        .clk(clk),
         .en(alu_en),
+        .start(alu_start),
         .opcode(alu_op),
         .operand1(reg_data1), // 操作数1,只会是寄存器rs1的值
         .operand2((op2_dir == 2'b00) ? reg_data2 :
@@ -101,13 +236,17 @@ module cpu (
                   // 来自 addi/xori
                   (op2_dir == 2'b10) ? {{52{instr_raw[31]}}, instr_raw[31:20]} : 
                   64'bZ), // 操作数2,可能是寄存器rs2的值，也可能是立即数
-        .result(alu_result)
+        .result(alu_result),
+        .busy(),
+        .done(alu_done)
     );
 
     ctrl ctrl_inst(
         .clk(clk),
         // 根据instr_raw，控制各个模块的使能信号
         .instr(instr_raw),
+        .fb_hit(fb_hit),
+        .mem_ready(mem_ready),
 
         // ram的控制信号
         .ram_cs(ram_cs),
@@ -129,7 +268,13 @@ module cpu (
 
         // alu的控制信号
         .alu_en(alu_en),
+        .alu_start(alu_start),
+        .alu_done(alu_done),
         .alu_op(alu_op),
-        .op2_dir(op2_dir)
+        .op2_dir(op2_dir),
+
+        // 观测信号
+        .fetch(fetch),
+        .halt(dbg_halt)
     );
 endmodule
\ No newline at end of file
@@ -0,0 +1,552 @@
+/*
+ * 模块：五级流水线CPU
+ * 简述：IF/ID/EX/MEM/WB五级流水线的cpu，指令语义和端口与多周期的cpu.v相同，
+ *       编译时在hardware.v中定义CORE_PIPELINE宏即可替换cpu.v（见Makefile中的CORE变量）。
+ *       复用alu.v、regfile.v和pc.v：
+ *          alu在时钟下降沿计算，EX/MEM在下一个上升沿锁存其结果；
+ *          regfile在WB级的时钟下降沿写入，同一周期内ID级读出的已经是新值；
+ *          pc在IF级取指或EX级跳转时更新。
+ *       压缩指令（见rvc.v）在IF级展开，之后各级处理的都是32位的指令；
+ *       顺序执行时pc+2，跳转的偏移量和jal/jalr写入x[rd]的地址都相对于pc+2。
+ *       冒险处理：
+ *          数据冒险：EX/MEM、MEM/WB向EX级前递；ld之后紧跟使用其结果的指令时停顿一个周期；
+ *                    mul/div在EX级启动alu的乘法器/除法器，EX级及之前的各级停顿到alu_done有效；
+ *          控制冒险：总是预测不跳转，分支和跳转在EX级确定，跳转时冲刷IF/ID和ID/EX（代价两个周期）；
+ *          结构冒险：指令和数据共用一个ram，MEM级访存的周期IF级只能从取指缓冲（fetchbuf.v）取指，
+ *                    MEM级为sd时不取指。
+ *       ram在时钟下降沿（片选信号的上升沿）完成读写，每个周期最多完成一次访存；
+ *       总线的mem_ready无效时访存尚未完成（见membus.v）：MEM级的读写未完成时整条流水线停顿，
+ *       MEM/WB插入气泡；IF级的取指未完成时pc保持不变，IF/ID插入气泡。
+ *       sd改写已经进入流水线的指令（自修改代码）时不会冲刷流水线。
+ * 输入：
+ *      clk      ：时钟信号
+ *      reset    ：复位信号（未使用，与cpu.v保持一致）
+ *      bus_data ：数据总线
+ *      mem_ready：本周期ram的读写可以完成
+ * 输出：
+ *      bus_data ：数据总线
+ *      bus_addr ：地址总线
+ *      ram_cs, ram_we, ram_oe ：ram的片选、写使能和读使能信号
+ *      ram_be   ：ram写入的字节使能
+ *      mem_restart：MEM级接替了正在等待的取指，总线重新开始计算延迟
+ *      dbg_*    ：观测接口，含义与cpu.v相同
+ */
+module cpu_pipe (
+    input clk,
+    input reset,
+
+    inout [63:0] bus_data, // 数据总线
+    output [63:0] bus_addr, // 地址总线
+    output ram_cs, // ram的使能信号
+    output ram_we, // ram的写使能信号
+    output ram_oe, // ram的读使能信号
+    output [7:0] ram_be, // ram写入的字节使能
+    input mem_ready, // 本周期ram的读写可以完成（见membus.v）
+    output mem_restart, // 本周期的请求不是上一个周期等待的那一次（见membus.v）
+
+    // 观测接口，供仿真程序统计指令和判断停机
+    output dbg_retire, // 一条指令执行完毕（持续一个时钟周期）
+    output [63:0] dbg_pc, // 刚退休的指令的地址
+    output [31:0] dbg_instr, // 刚退休的指令
+    output dbg_store, // 刚退休的指令写了内存（sb/sh/sw/sd）
+    output [63:0] dbg_store_addr, // 写入的地址
+    output [63:0] dbg_store_data, // 写入的数据（x[rs2]的低位字节，零扩展）
+    output [63:0] dbg_fetch_hits, // 取指缓冲命中次数
+    output [63:0] dbg_fetch_misses, // 取指缓冲未命中次数
+    output dbg_halt // 遇到未知指令而停机
+);
+
+localparam [7:0]
+    OP_ADD  = 8'b0000_0000,
+    OP_ADDI = OP_ADD + 1,
+    OP_SUB  = OP_ADDI + 1,
+    OP_MUL  = OP_SUB + 1,
+    OP_DIV  = OP_MUL + 1,
+
+    OP_SLL  = OP_DIV + 1,
+    OP_SRL  = OP_SLL + 1,
+
+    OP_AND  = OP_SRL + 1,
+    OP_OR   = OP_AND + 1,
+    OP_NOT  = OP_OR  + 1,
+    OP_XOR  = OP_NOT + 1,
+
+    OP_LUI  = OP_XOR + 1;
+
+    // 第一个时钟上升沿之前不访问ram（相当于ctrl.v的PREPARE状态）
+    reg running;
+
+    // 停机：未知指令到达WB级后置位
+    reg halted;
+
+    /* IF/ID流水线寄存器 */
+    reg if_id_valid;
+    reg [63:0] if_id_pc;
+    reg [31:0] if_id_instr;
+    reg if_id_rvc; // 压缩指令：下一条指令在pc+2
+
+    /* ID/EX流水线寄存器 */
+    reg id_ex_valid;
+    reg [63:0] id_ex_pc;
+    reg [31:0] id_ex_instr;
+    reg id_ex_rvc;
+    reg [4:0] id_ex_rd, id_ex_rs1, id_ex_rs2;
+    reg [63:0] id_ex_a, id_ex_b; // x[rs1]和x[rs2]
+    reg [63:0] id_ex_imm; // alu的立即数操作数，或jalr的偏移
+    reg [63:0] id_ex_target; // beq/bge/jal的跳转地址
+    reg [7:0] id_ex_alu_op;
+    reg id_ex_op2_imm; // alu的操作数2是否为立即数
+    reg id_ex_reg_write, id_ex_link; // 写x[rd]，写入的是否为下一条指令的地址
+    reg id_ex_mem_read, id_ex_mem_write;
+    reg id_ex_beq, id_ex_bge, id_ex_jal, id_ex_jalr;
+    reg id_ex_csr; // 写入x[rd]的是性能计数器的值
+    reg id_ex_halt; // 未知指令
+
+    /* EX/MEM流水线寄存器 */
+    reg ex_mem_valid;
+    reg [63:0] ex_mem_pc;
+    reg [31:0] ex_mem_instr;
+    reg [4:0] ex_mem_rd;
+    reg [63:0] ex_mem_result; // alu的结果（ld/sd的地址）或下一条指令的地址
+    reg [63:0] ex_mem_store_data;
+    reg ex_mem_reg_write, ex_mem_mem_read, ex_mem_mem_write;
+    reg ex_mem_halt;
+
+    /* MEM/WB流水线寄存器 */
+    reg mem_wb_valid;
+    reg [63:0] mem_wb_pc;
+    reg [31:0] mem_wb_instr;
+    reg [4:0] mem_wb_rd;
+    reg [63:0] mem_wb_value; // 写入x[rd]的值
+    reg mem_wb_reg_write;
+    reg mem_wb_store;
+    reg [63:0] mem_wb_store_addr, mem_wb_store_data;
+    reg mem_wb_halt;
+
+    /* 退休寄存器：WB之后一个周期，此时寄存器的写入已经完成 */
+    reg ret_valid;
+    reg [63:0] ret_pc;
+    reg [31:0] ret_instr;
+    reg ret_store;
+    reg [63:0] ret_store_addr, ret_store_data;
+
+    initial begin
+        running = 1'b0;
+        halted = 1'b0;
+        if_id_valid = 1'b0;
+        id_ex_valid = 1'b0;
+        ex_mem_valid = 1'b0;
+        mem_wb_valid = 1'b0;
+        ret_valid = 1'b0;
+    end
+
+    /* ---------------- ID：译码 ---------------- */
+    wire [31:0] id_instr = if_id_instr;
+    wire [6:0] id_opcode = id_instr[6:0];
+    wire [2:0] id_funct3 = id_instr[14:12];
+    wire [6:0] id_funct7 = id_instr[31:25];
+    wire [4:0] id_rd = id_instr[11:7];
+    wire [4:0] id_rs1 = id_instr[19:15];
+    wire [4:0] id_rs2 = id_instr[24:20];
+
+    wire [63:0] imm_i = {{52{id_instr[31]}}, id_instr[31:20]};
+    wire [63:0] imm_s = {{52{id_instr[31]}}, id_instr[31:25], id_instr[11:7]};
+    wire [63:0] imm_b = {{52{id_instr[31]}}, id_instr[31], id_instr[7], id_instr[30:25], id_instr[11:8]};
+    wire [63:0] imm_j = {{44{id_instr[31]}}, id_instr[31], id_instr[19:12], id_instr[20], id_instr[30:21]};
+    wire [63:0] imm_u = {{44{id_instr[31]}}, id_instr[31:12]}; // alu的OP_LUI再左移12位
+
+    reg id_known;
+    reg [7:0] id_alu_op;
+    reg id_op2_imm;
+    reg [63:0] id_imm;
+    reg id_reg_write, id_link;
+    reg id_mem_read, id_mem_write;
+    reg id_beq, id_bge, id_jal, id_jalr;
+    reg id_csr;
+    reg id_use_rs1, id_use_rs2;
+
+    // 译码规则与ctrl.v的FETCH状态相同
+    always @(*) begin
+        id_known = 1'b1;
+        id_alu_op = OP_ADD;
+        id_op2_imm = 1'b0;
+        id_imm = imm_i;
+        id_reg_write = 1'b0;
+        id_link = 1'b0;
+        id_mem_read = 1'b0;
+        id_mem_write = 1'b0;
+        id_beq = 1'b0;
+        id_bge = 1'b0;
+        id_jal = 1'b0;
+        id_jalr = 1'b0;
+        id_csr = 1'b0;
+        id_use_rs1 = 1'b1;
+        id_use_rs2 = 1'b0;
+
+        // ADDI指令
+        if (id_funct3 == 3'b000 && id_opcode == 7'b0010011) begin
+            id_alu_op = OP_ADDI;
+            id_op2_imm = 1'b1;
+            id_reg_write = 1'b1;
+        end
+        // ADD/SUB/MUL/DIV/SLL/SRL/OR/AND/XOR指令
+        else if (id_opcode == 7'b0110011) begin
+            id_reg_write = 1'b1;
+            id_use_rs2 = 1'b1;
+            case ({id_funct7, id_funct3})
+                {7'b0000000, 3'b000}: id_alu_op = OP_ADD;
+                {7'b0100000, 3'b000}: id_alu_op = OP_SUB;
+                {7'b0000001, 3'b000}: id_alu_op = OP_MUL;
+                {7'b0000001, 3'b100}: id_alu_op = OP_DIV;
+                {7'b0000000, 3'b001}: id_alu_op = OP_SLL;
+                {7'b0000000, 3'b101}: id_alu_op = OP_SRL;
+                {7'b0000000, 3'b110}: id_alu_op = OP_OR;
+                {7'b0000000, 3'b111}: id_alu_op = OP_AND;
+                {7'b0000000, 3'b100}: id_alu_op = OP_XOR;
+                default: id_known = 1'b0;
+            endcase
+        end
+        // LB/LH/LW/LD/LBU/LHU/LWU指令：alu计算x[rs1]+sext(offset)，MEM级按funct3扩展读出的数据
+        else if (id_funct3 != 3'b111 && id_opcode == 7'b0000011) begin
+            id_op2_imm = 1'b1;
+            id_reg_write = 1'b1;
+            id_mem_read = 1'b1;
+        end
+        // SB/SH/SW/SD指令：alu计算x[rs1]+sext(offset)，x[rs2]为写入的数据
+        else if (id_funct3[2] == 1'b0 && id_opcode == 7'b0100011) begin
+            id_op2_imm = 1'b1;
+            id_imm = imm_s;
+            id_mem_write = 1'b1;
+            id_use_rs2 = 1'b1;
+        end
+        // BEQ指令
+        else if (id_funct3 == 3'b000 && id_opcode == 7'b1100011) begin
+            id_beq = 1'b1;
+            id_use_rs2 = 1'b1;
+        end
+        // BGE指令
+        else if (id_funct3 == 3'b101 && id_opcode == 7'b1100011) begin
+            id_bge = 1'b1;
+            id_use_rs2 = 1'b1;
+        end
+        // JAL指令
+        else if (id_opcode == 7'b1101111) begin
+            id_jal = 1'b1;
+            id_reg_write = 1'b1;
+            id_link = 1'b1;
+            id_use_rs1 = 1'b0;
+        end
+        // JALR指令
+        else if (id_funct3 == 3'b010 && id_opcode == 7'b1100111) begin
+            id_jalr = 1'b1;
+            id_reg_write = 1'b1;
+            id_link = 1'b1;
+        end
+        // XORI指令
+        else if (id_funct3 == 3'b100 && id_opcode == 7'b0010011) begin
+            id_alu_op = OP_XOR;
+            id_op2_imm = 1'b1;
+            id_reg_write = 1'b1;
+        end
+        // LUI指令
+        else if (id_opcode == 7'b0110111) begin
+            id_alu_op = OP_LUI;
+            id_op2_imm = 1'b1;
+            id_imm = imm_u;
+            id_reg_write = 1'b1;
+            id_use_rs1 = 1'b0;
+        end
+        // CSRR指令（csrrs rd csr x0）：在EX级读取性能计数器
+        else if (id_rs1 == 5'b0 && id_funct3 == 3'b010 && id_opcode == 7'b1110011) begin
+            id_csr = 1'b1;
+            id_reg_write = 1'b1;
+            id_use_rs1 = 1'b0;
+        end
+        else begin
+            id_known = 1'b0;
+        end
+
+        if (!id_known) begin
+            id_reg_write = 1'b0;
+            id_use_rs1 = 1'b0;
+            id_use_rs2 = 1'b0;
+        end
+    end
+
+    // beq/bge/jal的跳转地址：与cpu.v相同，偏移相对于下一条指令且不左移
+    wire [63:0] id_target = if_id_pc + (if_id_rvc ? 64'd2 : 64'd4) + (id_jal ? imm_j : imm_b);
+
+    // 寄存器文件：ID级读，WB级在时钟下降沿写
+    wire [63:0] reg_data1, reg_data2;
+    wire reg_en = mem_wb_valid && mem_wb_reg_write && !clk;
+
+    regfile regfile_inst(
+        .en(reg_en),
+        .rd(mem_wb_rd),
+        .rs1(id_rs1),
+        .rs2(id_rs2),
+        .data1(reg_data1),
+        .data2(reg_data2),
+        .we(mem_wb_reg_write),
+        .write_data(mem_wb_value)
+    );
+
+    // ld的结果要到MEM级结束才能得到，紧跟其后使用该结果的指令停顿一个周期
+    wire load_use = if_id_valid && id_ex_valid && id_ex_mem_read && id_ex_rd != 5'b0 &&
+                    ((id_use_rs1 && id_rs1 == id_ex_rd) || (id_use_rs2 && id_rs2 == id_ex_rd));
+
+    /* ---------------- EX：执行 ---------------- */
+    // 前递：优先使用较新的EX/MEM的结果（ld除外），其次是MEM/WB
+    wire fwd_mem_ok = ex_mem_valid && ex_mem_reg_write && !ex_mem_mem_read && ex_mem_rd != 5'b0;
+    wire fwd_wb_ok = mem_wb_valid && mem_wb_reg_write && mem_wb_rd != 5'b0;
+
+    wire [63:0] ex_a = (fwd_mem_ok && ex_mem_rd == id_ex_rs1) ? ex_mem_result :
+                       (fwd_wb_ok && mem_wb_rd == id_ex_rs1) ? mem_wb_value :
+                       id_ex_a;
+    wire [63:0] ex_b = (fwd_mem_ok && ex_mem_rd == id_ex_rs2) ? ex_mem_result :
+                       (fwd_wb_ok && mem_wb_rd == id_ex_rs2) ? mem_wb_value :
+                       id_ex_b;
+
+    // alu在时钟下降沿计算；乘除法在进入EX级之后的第一个上升沿启动，之后等待alu_done
+    wire alu_en = !clk;
+    wire [63:0] alu_result;
+    wire alu_done;
+
+    reg md_issued; // EX级的乘除法已经启动
+    initial md_issued = 1'b0;
+    wire ex_muldiv = id_ex_valid && (id_ex_alu_op == OP_MUL || id_ex_alu_op == OP_DIV);
+    wire md_wait = ex_muldiv && !(md_issued && alu_done);
+
+    // MEM级的访存尚未完成，EX级及之前的各级停顿（在下面MEM级的部分定义）
+    wire mem_wait;
+
+    alu alu_inst(
+        .clk(clk),
+        .en(alu_en),
+        .start(ex_muldiv && !md_issued),
+        .opcode(id_ex_alu_op),
+        .operand1(ex_a),
+        .operand2(id_ex_op2_imm ? id_ex_imm : ex_b),
+        .result(alu_result),
+        .busy(),
+        .done(alu_done)
+    );
+
+    // 分支比较器：bge为有符号比较
+    wire ex_eq = (ex_a == ex_b);
+    wire ex_ge = ($signed(ex_a) >= $signed(ex_b));
+
+    wire [63:0] ex_link = id_ex_pc + (id_ex_rvc ? 64'd2 : 64'd4);
+    // jalr先写x[rd]再读x[rs1]（与cpu.v相同），因此rd与rs1相同时基址为下一条指令的地址
+    wire [63:0] ex_jalr_base = (id_ex_rd == id_ex_rs1 && id_ex_rd != 5'b0) ? ex_link : ex_a;
+    wire [63:0] ex_target = id_ex_jalr ? ex_jalr_base + id_ex_imm : id_ex_target;
+
+    // 跳转在停顿结束、指令离开EX级时才生效
+    wire ex_taken = id_ex_valid && !mem_wait &&
+                    ((id_ex_beq && ex_eq) || (id_ex_bge && ex_ge) || id_ex_jal || id_ex_jalr);
+
+    /* ---------------- MEM：访存 ---------------- */
+    wire mem_access = ex_mem_valid && (ex_mem_mem_read || ex_mem_mem_write);
+    assign mem_wait = mem_access && !mem_ready;
+
+    wire ex_redirect = ex_taken;
+
+    // 读出数据的扩展，写入数据的对齐和字节使能
+    wire [63:0] mem_load_value, mem_store_bus, mem_store_value;
+
+    lsu lsu_inst(
+        .funct3(ex_mem_instr[14:12]),
+        .ram_data(bus_data),
+        .store_data(ex_mem_store_data),
+        .load_value(mem_load_value),
+        .bus_data(mem_store_bus),
+        .be(ram_be),
+        .store_value(mem_store_value)
+    );
+
+    /* ---------------- IF：取指 ---------------- */
+    wire halt_pending = (if_id_valid && !id_known) || (id_ex_valid && id_ex_halt) ||
+                        (ex_mem_valid && ex_mem_halt) || (mem_wb_valid && mem_wb_halt) || halted;
+    wire if_active = running && !load_use && !md_wait && !mem_wait && !ex_redirect && !halt_pending;
+
+    wire [63:0] pc_addr;
+    wire fb_hit;
+    wire [31:0] fb_instr;
+
+    // 取指缓冲命中时使用缓冲中的指令，否则使用bus_data的高32位；压缩指令在进入IF/ID之前展开
+    wire [31:0] if_word = fb_hit ? fb_instr : bus_data[63:32];
+    wire if_rvc = pc_addr[1] || if_word[1:0] != 2'b11;
+    wire [31:0] if_rvc_instr;
+
+    rvc rvc_inst(
+        .c(if_word[31:16]),
+        .instr(if_rvc_instr)
+    );
+
+    // MEM级访存时ram被占用，只有取指缓冲命中时才能取指；
+    // sd所在的周期不使用缓冲，保证sd之后第三条指令取到的是写入后的内容
+    wire mem_store = mem_access && ex_mem_mem_write;
+    wire if_fetch = if_active && (!mem_access || (fb_hit && !mem_store));
+    wire if_ram = if_fetch && !fb_hit;
+    // 取指完成：取指缓冲命中，或ram的读取可以完成；否则pc保持不变，下一个周期再取
+    wire if_done = if_fetch && (fb_hit || mem_ready);
+
+    fetchbuf fetchbuf_inst(
+        .clk(clk),
+        .en(if_done),
+        .inv(ex_redirect || mem_store),
+        .addr(pc_addr),
+        .ram_data(bus_data),
+        .hit(fb_hit),
+        .instr(fb_instr),
+        .hit_count(dbg_fetch_hits),
+        .miss_count(dbg_fetch_misses)
+    );
+
+    pc pc_inst(
+        .clk(clk),
+        .en(ex_redirect || if_done),
+        .reset(1'b0),
+        .tar(ex_target),
+        .sign(ex_redirect),
+        .half(if_rvc),
+        .pc_addr(pc_addr)
+    );
+
+    // ram：MEM级优先，其次是IF级取指（取指缓冲未命中时）
+    assign ram_oe = mem_access ? ex_mem_mem_read : if_ram;
+    assign ram_we = mem_store;
+    assign ram_cs = (mem_access || if_ram) && !clk;
+    assign bus_addr = mem_access ? ex_mem_result : pc_addr;
+    assign bus_data = ram_we ? mem_store_bus : 64'bZ;
+
+    // 取指等待ram时ld/sd进入MEM级：总线上的请求换成了MEM级的访存，它不能继承取指已经等待的周期。
+    // 跳转时IF级不取指，取指的请求被撤回，总线自己放弃已经等待的周期
+    reg bus_mem; // 上一个周期总线上的请求来自MEM级
+    initial bus_mem = 1'b0;
+    always @(posedge clk) bus_mem <= mem_access;
+    assign mem_restart = mem_access && !bus_mem;
+
+    /* ---------------- 性能计数器 ---------------- */
+    // 指令离开EX级之后一定会完成，因此在EX级计入instret和指令类别：
+    // csrr在EX级读取计数器时，比它早的指令都已经计入
+    wire ex_commit = id_ex_valid && !id_ex_halt && !md_wait && !mem_wait;
+    wire [63:0] csr_value;
+
+    perf perf_inst(
+        .clk(clk),
+        .en(!halted),
+        .retire(ex_commit),
+        .exec(ex_commit),
+        .instr(id_ex_instr),
+        .mem_read(((mem_access && ex_mem_mem_read) || if_ram) && mem_ready),
+        .mem_write(mem_store && mem_ready),
+        .br_taken(id_ex_valid && !mem_wait && ((id_ex_beq && ex_eq) || (id_ex_bge && ex_ge))),
+        .stall_load(load_use && !mem_wait),
+        .stall_mem(if_active && mem_access && !if_fetch),
+        .flush(ex_redirect),
+        .stall_bus((mem_access || if_ram) && !mem_ready),
+        .csr(id_ex_instr[31:20]),
+        .value(csr_value)
+    );
+
+    /* ---------------- 流水线寄存器的更新 ---------------- */
+    always @(posedge clk) begin
+        running <= 1'b1;
+
+        // MEM级停顿时EX级的乘除法保持已经启动的状态
+        md_issued <= ex_muldiv && (md_wait || mem_wait);
+
+        // IF/ID
+        if (load_use || md_wait || mem_wait) begin
+            // 保持
+        end else if (if_done) begin
+            if_id_valid <= 1'b1;
+            if_id_pc <= pc_addr;
+            if_id_instr <= if_rvc ? if_rvc_instr : if_word;
+            if_id_rvc <= if_rvc;
+        end else begin
+            if_id_valid <= 1'b0;
+        end
+
+        // ID/EX
+        if (md_wait || mem_wait) begin
+            // 保持；停顿期间MEM/WB中的指令会离开，先把前递得到的操作数保存下来
+            id_ex_a <= ex_a;
+            id_ex_b <= ex_b;
+        end else if (!if_id_valid || load_use || ex_redirect) begin
+            id_ex_valid <= 1'b0;
+        end else begin
+            id_ex_valid <= 1'b1;
+            id_ex_pc <= if_id_pc;
+            id_ex_instr <= if_id_instr;
+            id_ex_rvc <= if_id_rvc;
+            id_ex_rd <= id_rd;
+            id_ex_rs1 <= id_rs1;
+            id_ex_rs2 <= id_rs2;
+            id_ex_a <= reg_data1;
+            id_ex_b <= reg_data2;
+            id_ex_imm <= id_imm;
+            id_ex_target <= id_target;
+            id_ex_alu_op <= id_alu_op;
+            id_ex_op2_imm <= id_op2_imm;
+            id_ex_reg_write <= id_reg_write;
+            id_ex_link <= id_link;
+            id_ex_mem_read <= id_mem_read;
+            id_ex_mem_write <= id_mem_write;
+            id_ex_beq <= id_beq;
+            id_ex_bge <= id_bge;
+            id_ex_jal <= id_jal;
+            id_ex_jalr <= id_jalr;
+            id_ex_csr <= id_csr;
+            id_ex_halt <= !id_known;
+        end
+
+        // EX/MEM：MEM级的访存未完成时保持，乘除法未完成时插入气泡
+        if (!mem_wait) begin
+            ex_mem_valid <= id_ex_valid && !md_wait;
+            ex_mem_pc <= id_ex_pc;
+            ex_mem_instr <= id_ex_instr;
+            ex_mem_rd <= id_ex_rd;
+            ex_mem_result <= id_ex_link ? ex_link : id_ex_csr ? csr_value : alu_result;
+            ex_mem_store_data <= ex_b;
+            ex_mem_reg_write <= id_ex_reg_write;
+            ex_mem_mem_read <= id_ex_mem_read;
+            ex_mem_mem_write <= id_ex_mem_write;
+            ex_mem_halt <= id_ex_halt;
+        end
+
+        // MEM/WB：访存未完成时插入气泡
+        mem_wb_valid <= ex_mem_valid && !mem_wait;
+        mem_wb_pc <= ex_mem_pc;
+        mem_wb_instr <= ex_mem_instr;
+        mem_wb_rd <= ex_mem_rd;
+        mem_wb_value <= ex_mem_mem_read ? mem_load_value : ex_mem_result;
+        mem_wb_reg_write <= ex_mem_reg_write;
+        mem_wb_store <= ex_mem_mem_write;
+        mem_wb_store_addr <= ex_mem_result;
+        mem_wb_store_data <= mem_store_value;
+        mem_wb_halt <= ex_mem_halt;
+
+        // 退休
+        ret_valid <= mem_wb_valid && !mem_wb_halt;
+        if (mem_wb_valid) begin
+            ret_pc <= mem_wb_pc;
+            ret_instr <= mem_wb_instr;
+            ret_store <= mem_wb_store;
+            ret_store_addr <= mem_wb_store_addr;
+            ret_store_data <= mem_wb_store_data;
+        end
+        if (mem_wb_valid && mem_wb_halt)
+            halted <= 1'b1;
+    end
+
+    assign dbg_retire = ret_valid;
+    assign dbg_pc = ret_pc;
+    assign dbg_instr = ret_instr;
+    assign dbg_store = ret_store;
+    assign dbg_store_addr = ret_store_addr;
+    assign dbg_store_data = ret_store_data;
+    assign dbg_halt = halted;
+
+endmodule
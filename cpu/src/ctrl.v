@@ -1,6 +1,33 @@
+/*
+ * 模块：控制器
+ * 简述：多周期cpu的状态机。每条指令只需两个状态：
+ *          FETCH：进入状态时（时钟上升沿）从ram读取pc处的指令，时钟下降沿写入IR，离开时pc+4（压缩指令pc+2）；
+ *                 指令已经在取指缓冲中时不访问ram；
+ *          执行状态：进入状态时完成alu运算或访存，时钟下降沿写回x[rd]，离开时更新pc（跳转指令）。
+ *       mul/div例外：FETCH译码出乘除法时即启动alu的乘法器/除法器（alu_start），
+ *       MUL/DIV状态一直保持到alu_done有效，再在时钟下降沿写回x[rd]。
+ *       访问ram的状态（取指缓冲未命中的FETCH、LD、SD）同样一直保持到总线的mem_ready有效（见membus.v），
+ *       IR、x[rd]和pc只在mem_ready有效的周期更新。
+ *       因此各模块的使能信号由状态和时钟相位共同决定：
+ *          ram_cs、alu_en在进入状态时产生上升沿；ir_en、reg_en在时钟下降沿产生上升沿。
+ *       每条指令的周期数见test/ctrl.cpp中的周期表。
+ * 输入：
+ *      clk   ：时钟信号
+ *      instr ：IR中的指令
+ *      fb_hit：pc处的指令在取指缓冲中
+ *      alu_done：alu的乘法或除法已经完成
+ *      mem_ready：本周期ram的读写可以完成
+ * 输出：
+ *      各模块的控制信号
+ *      fetch ：处于取指状态（上一条指令已经执行完毕）
+ *      halt  ：遇到未知指令，控制器停机
+ */
 module ctrl (
     input clk,
     input [31:0] instr,
+    input fb_hit,
+    input alu_done,
+    input mem_ready,
 
     output reg ram_cs,
     output reg ram_we,
@@ -17,8 +44,12 @@ module ctrl (
     output reg [1:0] reg_in_dir,
 
     output reg alu_en,
+    output reg alu_start,
     output reg [7:0] alu_op,
-    output reg [1:0] op2_dir
+    output reg [1:0] op2_dir,
+
+    output fetch, // 处于取指状态（上一条指令已经执行完毕）
+    output halt   // 遇到未知指令，控制器停机
 );
     reg [7:0] state;
     reg [7:0] next_state;
@@ -26,104 +57,50 @@ module ctrl (
     parameter 
         /* PREPARE状态：  用于初始化cpu中部件的控制信号 */
         PREPARE = 8'b0,
-        /* S1状态：       从Ram中读取指令 */
-        S1      = PREPARE+1,
-        /* S2状态：       将S1状态中读取的指令写入到IR */
-        S2      = S1+1,
-
-        /* ADD_S1状态：   控制alu进行行x[rs1]+x[rs2]的计算 */
-        ADD_S1  = S2+1,
-        /* ADD_S2状态：   将ADD_S1状态中计算的结果写入到x[rd] */
-        ADD_S2  = ADD_S1+1,
-
-        /* ADDI_S1状态：  控制alu进行x[rs1]+setx(imm)的计算 */
-        ADDI_S1 = ADD_S2+1,
-        /* ADDI_S2状态：  将ADDI_S1状态中计算的结果写入到x[rd] */
-        ADDI_S2 = ADDI_S1+1,
-
-        /* SUB_S1状态：   控制alu进行x[rs1]-x[rs2]的计算 */
-        SUB_S1  = ADDI_S2+1,
-        /* SUB_S2状态：   将SUB_S1状态中计算的结果写入到x[rd] */
-        SUB_S2  = SUB_S1+1,
-
-        /* MUL_S1状态：   控制alu进行x[rs1]*x[rs2]的计算 */
-        MUL_S1 = SUB_S2+1,
-        /* MUL_S2状态：   将MUL_S1状态中计算的结果写入到x[rd] */
-        MUL_S2 = MUL_S1+1,
-
-        /* DIV_S1状态：   控制alu进行x[rs1]/x[rs2]计算，其中商的结果向0舍入 */
-        DIV_S1 = MUL_S2+1,
-        /* DIV_S2状态：   将DIV_S1状态中计算的结果写入到x[rd] */
-        DIV_S2 = DIV_S1+1,
-
-        /* SLL_S1状态：   控制alu进行x[rs1]<<x[rs2]的计算 */
-        SLL_S1 = DIV_S2+1,
-        /* SLL_S2状态：   将SLL_S1状态中计算结果写入到x[rd] */
-        SLL_S2 = SLL_S1+1,
-
-        /* SRL_S1状态：   控制alu进行x[rs1]>>x[rs2]的计算 */
-        SRL_S1 = SLL_S2+1,
-        /* SRL_S2状态：   将SRL_S1状态中计算结果写入到x[rd] */
-        SRL_S2 = SRL_S1+1,
-
-        /* LUI_S1状态：   控制alu进行sext(imm[31:12])<<12的计算 */
-        LUI_S1 = SRL_S2+1,
-        /* LUI_S2状态：   将LUI_S1状态中计算结果写入到x[rd] */
-        LUI_S2 = LUI_S1+1,
-
-        /* OR_S1状态：   控制alu进行x[rs1]|x[rs2]的计算 */
-        OR_S1 = LUI_S2+1,
-        /* OR_S2状态：   将OR_S1状态中计算结果写入到x[rd] */
-        OR_S2 = OR_S1+1,
-
-        /* AND_S1状态：   控制alu进行x[rs1]&x[rs2]的计算 */
-        AND_S1 = OR_S2+1,
-        /* AND_S2状态：   将AND_S1状态中计算结果写入到x[rd] */
-        AND_S2 = AND_S1+1,
-
-        /* XOR_S1状态：   控制alu进行x[rs1]^x[rs2]的计算 */
-        XOR_S1 = AND_S2+1,
-        /* XOR_S2状态：   将XOR_S1状态中计算结果写入到x[rd] */
-        XOR_S2 = XOR_S1+1,
-
-        /* LD_S1状态：    从ram中读取x[rs1]+setx(offset)地址处的64位数据 */
-        LD_S1 = XOR_S2+1,
-        /* LD_S2状态：    将LD_S1状态中读取的64位数据写入到x[rd] */
-        LD_S2 = LD_S1+1,
-
-        /* SD_S1状态：    通知ram释放数据总线 */
-        SD_S1 = LD_S2+1,
-        /* SD_S2状态：    拉低ram的片选信号，为SD_S3状态准备 */
-        SD_S2 = SD_S1+1,
-        /* SD_S3状态：    拉高ram的片选信号，正式开始写入数据 */
-        SD_S3 = SD_S2+1,
-        /* SD_S4状态：    拉低ram的片选信号，稳定总线状态 */
-        SD_S4 = SD_S3+1,
-
-        /* BEQ_S1状态：    控制alu进行x[rs1]-x[rs2]的计算 */
-        BEQ_S1 = SD_S4+1,
-        /* BEQ_S2状态：    根据alu的计算结果（alu_result==0），判断是否跳转 */
-        BEQ_S2 = BEQ_S1+1,
-
-        /* BGE_S1状态：    控制alu进行x[rs1]-x[rs2]的计算 */
-        BGE_S1 = BEQ_S2+1,
-        /* BGE_S2状态：    根据alu的计算结果（alu_result[63]==1'b0），判断是否跳转 */
-        BGE_S2 = BGE_S1+1,
-
-        /* JAL_S1状态：    将pc(已经+4)的值写入x[rd] */
-        JAL_S1 = BGE_S2+1,
-        /* JAL_S2状态：    pc+=setx(offset) */
-        JAL_S2 = JAL_S1+1,
-
-        /* JALR_S1状态：   将pc(已经+4)的值写入x[rd] */
-        JALR_S1 = JAL_S2+1,
-        /* JALT_S2状态：   pc=x[rs1]+setx(offset) */
-        JALR_S2 = JALR_S1+1,
-
-        /* XORI_S1状态：   控制alu进行x[rs1]^setx(imm)的计算*/
-        XORI_S1 = JALR_S2+1,
-        /* XORI_S2状态：   将XORI_S1状态中计算的结果写入到x[rd] */
-        XORI_S2 = XORI_S1+1,
+        /* FETCH状态：    从Ram中读取指令并写入IR，pc+4（压缩指令pc+2） */
+        FETCH   = PREPARE+1,
+
+        /* ADD状态：      控制alu进行x[rs1]+x[rs2]的计算，并将结果写入到x[rd] */
+        ADD     = FETCH+1,
+        /* ADDI状态：     控制alu进行x[rs1]+setx(imm)的计算，并将结果写入到x[rd] */
+        ADDI    = ADD+1,
+        /* SUB状态：      控制alu进行x[rs1]-x[rs2]的计算，并将结果写入到x[rd] */
+        SUB     = ADDI+1,
+        /* MUL状态：      等待alu完成x[rs1]*x[rs2]的计算，并将结果写入到x[rd] */
+        MUL     = SUB+1,
+        /* DIV状态：      等待alu完成x[rs1]/x[rs2]计算（商向0舍入），并将结果写入到x[rd] */
+        DIV     = MUL+1,
+        /* SLL状态：      控制alu进行x[rs1]<<x[rs2]的计算，并将结果写入到x[rd] */
+        SLL     = DIV+1,
+        /* SRL状态：      控制alu进行x[rs1]>>x[rs2]的计算，并将结果写入到x[rd] */
+        SRL     = SLL+1,
+        /* LUI状态：      控制alu进行sext(imm[31:12])<<12的计算，并将结果写入到x[rd] */
+        LUI     = SRL+1,
+        /* OR状态：       控制alu进行x[rs1]|x[rs2]的计算，并将结果写入到x[rd] */
+        OR      = LUI+1,
+        /* AND状态：      控制alu进行x[rs1]&x[rs2]的计算，并将结果写入到x[rd] */
+        AND     = OR+1,
+        /* XOR状态：      控制alu进行x[rs1]^x[rs2]的计算，并将结果写入到x[rd] */
+        XOR     = AND+1,
+        /* XORI状态：     控制alu进行x[rs1]^setx(imm)的计算，并将结果写入到x[rd] */
+        XORI    = XOR+1,
+
+        /* LD状态：       从ram中读取x[rs1]+setx(offset)地址处的数据，扩展后写入到x[rd]（lb/lh/lw/ld/lbu/lhu/lwu） */
+        LD      = XORI+1,
+        /* SD状态：       将x[rs2]的低1/2/4/8个字节写入ram的x[rs1]+setx(offset)地址处（sb/sh/sw/sd，写入时ram释放数据总线） */
+        SD      = LD+1,
+
+        /* BEQ状态：      根据比较器的结果（x[rs1]==x[rs2]），判断是否跳转 */
+        BEQ     = SD+1,
+        /* BGE状态：      根据比较器的结果（有符号x[rs1]>=x[rs2]），判断是否跳转 */
+        BGE     = BEQ+1,
+        /* JAL状态：      将pc(已经指向下一条指令)的值写入x[rd]，然后pc+=setx(offset) */
+        JAL     = BGE+1,
+        /* JALR状态：     将pc(已经指向下一条指令)的值写入x[rd]，然后pc=x[rs1]+setx(offset) */
+        JALR    = JAL+1,
+
+        /* CSR状态：      将CSR地址对应的性能计数器的值写入x[rd] */
+        CSR     = JALR+1,
 
         /* UNKNOWN_INSTR状态：   遇到未知指令时，直接跳转到此状态，并在此状态循环 */
         UNKNOWN_INSTR = 8'b1111_1111;
@@ -145,585 +122,235 @@ localparam [7:0]
     
     OP_LUI  = OP_XOR + 1;
 
+    assign fetch = (state == FETCH);
+    assign halt = (state == UNKNOWN_INSTR);
+
     // 更新状态
     always @(posedge clk) begin
         state <= next_state;
     end
 
+    // 取指缓冲命中，或ram的读取可以完成，本周期的取指完成
+    wire fetch_done = fb_hit || mem_ready;
+
     // 确定下一状态
     always @(*) begin
         case (state)
-            PREPARE: next_state = S1;
-            S1: next_state = S2;
-            S2:
-            // 根据指令内容确定之后执行的内容
+            PREPARE: next_state = FETCH;
+            FETCH:
+            // ram尚未完成读取，继续等待
+            if (!fetch_done) begin
+                next_state = FETCH;
+            end
+            // IR在本状态的时钟下降沿已经装入指令，根据指令内容确定之后执行的内容
             // ADDI指令
-            if (instr[14:12] == 3'b000 && instr[6:0] == 7'b0010011) begin
-                next_state = ADDI_S1;
+            else if (instr[14:12] == 3'b000 && instr[6:0] == 7'b0010011) begin
+                next_state = ADDI;
             end 
             // ADD指令
             else if (instr[31:25] == 7'b0 && instr[14:12] == 3'b0 && instr[6:0] == 7'b0110011) begin
-                next_state = ADD_S1;
+                next_state = ADD;
             end
             // SUB指令
             else if (instr[31:25] == 7'b0100000 && instr[14:12] == 3'b0 && instr[6:0] == 7'b0110011) begin
-                next_state = SUB_S1;
+                next_state = SUB;
             end
             // MUL指令
             else if (instr[31:25] == 7'b0000001 && instr[14:12] == 3'b0 && instr[6:0] == 7'b0110011) begin
-                next_state = MUL_S1;
+                next_state = MUL;
             end
             // DIV指令
             else if (instr[31:25] == 7'b0000001 && instr[14:12] == 3'b100 && instr[6:0] == 7'b0110011) begin
-                next_state = DIV_S1;
+                next_state = DIV;
             end
             // SLL指令
             else if (instr[31:25] == 7'b0 && instr[14:12] == 3'b001 && instr[6:0] == 7'b0110011) begin
-                next_state = SLL_S1;
+                next_state = SLL;
             end
             // SRL指令
             else if (instr[31:25] == 7'b0 && instr[14:12] == 3'b101 && instr[6:0] == 7'b0110011) begin
-                next_state = SRL_S1;
+                next_state = SRL;
             end
             // OR指令
             else if (instr[31:25] == 7'b0 && instr[14:12] == 3'b110 && instr[6:0] == 7'b0110011) begin
-                next_state = OR_S1;
+                next_state = OR;
             end
             // AND指令
             else if (instr[31:25] == 7'b0 && instr[14:12] == 3'b111 && instr[6:0] == 7'b0110011) begin
-                next_state = AND_S1;
+                next_state = AND;
             end
             // XOR指令
             else if (instr[31:25] == 7'b0 && instr[14:12] == 3'b100 && instr[6:0] == 7'b0110011) begin
-                next_state = XOR_S1;
+                next_state = XOR;
             end
-            // LD指令
-            else if (instr[14:12] == 3'b011 && instr[6:0] == 7'b0000011) begin
-                next_state = LD_S1;
+            // LB/LH/LW/LD/LBU/LHU/LWU指令，数据的宽度和扩展方式由lsu.v按funct3决定
+            else if (instr[14:12] != 3'b111 && instr[6:0] == 7'b0000011) begin
+                next_state = LD;
             end
-            // SD指令
-            else if (instr[14:12] == 3'b011 && instr[6:0] == 7'b0100011) begin
-                next_state = SD_S1;
+            // SB/SH/SW/SD指令
+            else if (instr[14] == 1'b0 && instr[6:0] == 7'b0100011) begin
+                next_state = SD;
             end
             // BEQ指令
             else if (instr[14:12] == 3'b000 && instr[6:0] == 7'b1100011) begin
-                next_state = BEQ_S1;
+                next_state = BEQ;
             end
             // BGE指令
             else if (instr[14:12] == 3'b101 && instr[6:0] == 7'b1100011) begin
-                next_state = BGE_S1;
+                next_state = BGE;
             end
             // JAL指令
             else if (instr[6:0] == 7'b1101111) begin
-                next_state = JAL_S1;
+                next_state = JAL;
             end
             // JALR指令
             else if (instr[14:12] == 3'b010 && instr[6:0] == 7'b1100111) begin
-                next_state = JALR_S1;
+                next_state = JALR;
             end
             // XORI指令
             else if (instr[14:12] == 3'b100 && instr[6:0] == 7'b0010011) begin
-                next_state = XORI_S1;
+                next_state = XORI;
             end
             // LUI指令
             else if (instr[6:0] == 7'b0110111) begin
-                next_state = LUI_S1;
+                next_state = LUI;
+            end
+            // CSRR指令（csrrs rd csr x0）
+            else if (instr[19:15] == 5'b0 && instr[14:12] == 3'b010 && instr[6:0] == 7'b1110011) begin
+                next_state = CSR;
             end
             else begin
                 next_state = UNKNOWN_INSTR;
             end
 
-            /* ADD指令的状态转移 */
-            ADD_S1: next_state = ADD_S2;
-            ADD_S2: next_state = S1;
-
-            /* ADDI指令的状态转移 */
-            ADDI_S1: next_state = ADDI_S2;
-            ADDI_S2: next_state = S1;
-
-            /* SUB指令的状态转移 */
-            SUB_S1: next_state = SUB_S2;
-            SUB_S2: next_state = S1;
-
-            /* MUL指令的状态转移 */
-            MUL_S1: next_state = MUL_S2;
-            MUL_S2: next_state = S1;
-
-            /* DIV指令的状态转移 */
-            DIV_S1: next_state = DIV_S2;
-            DIV_S2: next_state = S1;
-
-            /* SLL指令的状态转移 */
-            SLL_S1: next_state = SLL_S2;
-            SLL_S2: next_state = S1;
-
-            /* SRL指令的状态转移 */
-            SRL_S1: next_state = SRL_S2;
-            SRL_S2: next_state = S1;
-
-            /* LUI指令的状态转移 */
-            LUI_S1: next_state = LUI_S2;
-            LUI_S2: next_state = S1;
-
-            /* OR指令的状态转移 */
-            OR_S1: next_state = OR_S2;
-            OR_S2: next_state = S1;
-
-            /* AND指令的状态转移 */
-            AND_S1: next_state = AND_S2;
-            AND_S2: next_state = S1;
-
-            /* XOR指令的状态转移 */
-            XOR_S1: next_state = XOR_S2;
-            XOR_S2: next_state = S1;
-
-            /* LD指令的状态转移 */
-            LD_S1: next_state = LD_S2;
-            LD_S2: next_state = S1;
-
-            /* SD指令的状态转移 */
-            SD_S1: next_state = SD_S2;
-            SD_S2: next_state = SD_S3;
-            SD_S3: next_state = SD_S4;
-            SD_S4: next_state = S1;
-
-            /* BEQ指令的状态转移 */
-            BEQ_S1: next_state = BEQ_S2;
-            BEQ_S2: next_state = S1;
-
-            /* BGE指令的状态转移 */
-            BGE_S1: next_state = BGE_S2;
-            BGE_S2: next_state = S1;
-
-            /* JAL指令的状态转移 */
-            JAL_S1: next_state = JAL_S2;
-            JAL_S2: next_state = S1;
+            /* 未知指令的状态转移 */
+            UNKNOWN_INSTR: next_state = UNKNOWN_INSTR;
 
-            /* JALR指令的状态转移 */
-            JALR_S1: next_state = JALR_S2;
-            JALR_S2: next_state = S1;
+            /* 乘除法等待alu完成 */
+            MUL, DIV: next_state = alu_done ? FETCH : state;
 
-            /* XORI指令的状态转移 */
-            XORI_S1: next_state = XORI_S2;
-            XORI_S2: next_state = S1;
+            /* 访存等待ram完成 */
+            LD, SD: next_state = mem_ready ? FETCH : state;
 
-            /* 未知指令的状态转移 */
-            UNKNOWN_INSTR: next_state = UNKNOWN_INSTR;
+            /* 其余的执行状态都只持续一个周期 */
+            default: next_state = FETCH;
         endcase
     end
 
     // 执行状态操作
     always @(*) begin
-        case (state)
-            PREPARE: begin
-            end
+        // 所有控制信号的复位
+        ram_cs = 1'b0;
+        ram_we = 1'b0;
+        ram_oe = 1'b0;
+        pc_en = 1'b0;
+        pc_in_dir = 2'b0;
+        pc_sign = 1'b0;
+        ir_en = 1'b0;
+        reg_en = 1'b0;
+        reg_we  = 1'b0;
+        reg_in_dir = 2'b00;
+        alu_en = 1'b0;
+        alu_start = 1'b0;
+        alu_op  = 8'b0;
+        op2_dir = 2'b00;
 
-            S1: begin
-                // 所有控制信号的复位
-                ram_cs = 1'b0;
-                ram_we = 1'b0;
-                ram_oe = 1'b0;
-                pc_en = 1'b0;
-                pc_in_dir = 2'b0;
-                pc_sign = 1'b0;
-                ir_en = 1'b0;
-                reg_en = 1'b0;
-                reg_we  = 1'b0;
-                reg_in_dir = 2'b00;
-                alu_en = 1'b0;
-                alu_op  = 8'b0;
-                op2_dir = 2'b00;
-                // S1状态启用
-                ram_cs = 1'b1;
-                ram_oe = 1'b1;
-                pc_en = 1'b1;
-            end
-            S2:  begin
-                // S1状态复位
-                ram_cs = 1'b0;
-                ram_oe = 1'b0;
-                pc_en = 1'b0;
-
-                // S2状态启用
-                ir_en = 1'b1;
-            end
-
-            /* ADD指令 */
-            ADD_S1: begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // ADD_S2状态启用
-                alu_op = OP_ADD;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
-            end
-            ADD_S2: begin
-                // ADD_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // ADD_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* ADD指令 */
-
-            /* ADDI指令 */
-            ADDI_S1: begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // ADDI_S1状态启用
-                alu_op = OP_ADDI;
-                op2_dir = 2'b10;
-                alu_en = 1'b1;
-            end
-            ADDI_S2: begin
-                // ADDI_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // ADDI_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b0;
-                alu_en = 1'b0;
-            end
-            /* ADDI指令 */
-
-            /* SUB指令 */
-            SUB_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // SUB_S1状态启用
-                alu_op = OP_SUB;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
-            end
-            SUB_S2: begin
-                // SUB_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // SUB_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* SUB指令 */
-
-            /* MUL指令 */
-            MUL_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // MUL_S1状态启用
-                alu_op = OP_MUL;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
-            end
-            MUL_S2: begin
-                // MUL_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // MUL_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* MUL指令 */
-
-            /* DIV指令 */
-            DIV_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // DIV_S1状态启用
-                alu_op = OP_DIV;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
-            end
-            DIV_S2: begin
-                // DIV_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // DIV_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* DIV指令 */
-
-            /* SLL指令 */
-            SLL_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // SLL_S1状态启用
-                alu_op = OP_SLL;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
-            end
-            SLL_S2: begin
-                // SLL_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // SLL_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* SLL指令 */
-
-            /* SRL指令 */
-            SRL_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // SRL_S1状态启用
-                alu_op = OP_SRL;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
-            end
-            SRL_S2: begin
-                // SRL_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // SRL_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* SRL指令 */
-
-            /* LUI指令 */
-            LUI_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // LUI_S1状态启用
-                alu_op = OP_LUI;
-                op2_dir = 2'b01;
-                alu_en = 1'b1;
-            end
-            LUI_S2: begin
-                // LUI_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // LUI_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* LUI指令 */
-
-            /* OR指令 */
-            OR_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // OR_S1状态启用
-                alu_op = OP_OR;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
-            end
-            OR_S2: begin
-                // OR_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // OR_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* OR指令 */
-
-            /* AND指令 */
-            AND_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // AND_S1状态启用
-                alu_op = OP_AND;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
-            end
-            AND_S2: begin
-                // AND_S2状态启用
-                reg_in_dir = 2'b10;
-                reg_we = 1'b1;
-                reg_en = 1'b1;
-                // AND_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* AND指令 */
-
-            /* XOR指令 */
-            XOR_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // XOR_S1状态启用
-                alu_op = OP_XOR;
-                op2_dir = 2'b00;
+        case (state)
+            FETCH: begin
+                // 进入状态时读取指令（取指缓冲命中时不访问ram），时钟下降沿写入IR，离开状态时pc+4；
+                // 等待ram的周期不写入IR，pc也保持不变
+                ram_cs = clk && !fb_hit;
+                ram_oe = !fb_hit;
+                pc_en = fetch_done;
+                ir_en = !clk && fetch_done;
+                // 译码出乘除法时，离开状态的时钟上升沿启动乘法器/除法器
+                if (next_state == MUL || next_state == DIV) begin
+                    alu_op = (next_state == MUL) ? OP_MUL : OP_DIV;
+                    alu_start = 1'b1;
+                end
+            end
+
+            /* 运算指令：进入状态时alu计算，时钟下降沿将结果写入x[rd] */
+            ADD, ADDI, SUB, MUL, DIV, SLL, SRL, LUI, OR, AND, XOR, XORI: begin
+                case (state)
+                    ADD:  alu_op = OP_ADD;
+                    ADDI: alu_op = OP_ADDI;
+                    SUB:  alu_op = OP_SUB;
+                    MUL:  alu_op = OP_MUL;
+                    DIV:  alu_op = OP_DIV;
+                    SLL:  alu_op = OP_SLL;
+                    SRL:  alu_op = OP_SRL;
+                    LUI:  alu_op = OP_LUI;
+                    OR:   alu_op = OP_OR;
+                    AND:  alu_op = OP_AND;
+                    default: alu_op = OP_XOR; // XOR、XORI
+                endcase
+                // 操作数2：lui为imm[31:12]，addi/xori为imm[11:0]，其余为x[rs2]
+                op2_dir = (state == LUI) ? 2'b01 :
+                          (state == ADDI || state == XORI) ? 2'b10 : 2'b00;
                 alu_en = 1'b1;
-            end
-            XOR_S2: begin
-                // XOR_S2状态启用
                 reg_in_dir = 2'b10;
                 reg_we = 1'b1;
-                reg_en = 1'b1;
-                // XOR_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
+                // 乘除法在alu_done有效的周期写回
+                reg_en = !clk && ((state != MUL && state != DIV) || alu_done);
             end
-            /* XOR指令 */
 
-            /* LD指令 */
-            LD_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // LD_S1状态启用
+            /* 读内存的指令：进入状态时读取数据，时钟下降沿写入x[rd]（mem_ready有效的周期） */
+            LD: begin
+                ram_cs = clk;
                 ram_oe = 1'b1;
-                ram_we = 1'b0;
-                pc_en = 1'b0;
-                ram_cs = 1'b1;
-            end
-            LD_S2: begin
-                // LD_S2状态启用
                 reg_in_dir = 2'b01;
                 reg_we = 1'b1;
-                reg_en = 1'b1;
-                // LD_S1状态复位
-                ram_cs = 1'b0;
-                ram_oe = 1'b0;
+                reg_en = !clk && mem_ready;
             end
-            /* LD指令 */
 
-            /* SD指令 */
-            SD_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // SD_S1状态启用
+            /* 写内存的指令：进入状态时按字节使能写入数据（mem_ready有效的周期） */
+            SD: begin
+                ram_cs = clk;
                 ram_we = 1'b1;
-                ram_cs = 1'b1; // 通知ram释放数据总线
-            end
-            SD_S2:  begin
-                ram_cs = 1'b0;
-            end
-            SD_S3:  begin
-                ram_cs = 1'b1;
-            end
-            SD_S4: begin
-                ram_cs = 1'b0;
-            end
-            /* SD指令 */
-            
-            /* BEQ指令 */
-            BEQ_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // BEQ_S1状态启用
-                alu_op = OP_SUB;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
             end
-            BEQ_S2: begin
-                // BEQ_S2状态启用
+
+            /* BEQ/BGE指令：由比较器决定跳转与否，离开状态时更新pc */
+            BEQ: begin
                 pc_in_dir = 2'b00;
                 pc_sign = 1'b1;
-                pc_en = 1;
-                // BEQ_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
-            end
-            /* BEQ指令 */
-
-            /* BGE指令 */
-            BGE_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // BGE_S1状态启用
-                alu_op = OP_SUB;
-                op2_dir = 2'b00;
-                alu_en = 1'b1;
+                pc_en = 1'b1;
             end
-            BGE_S2: begin
-                // BGE_S2状态启用
+            BGE: begin
                 pc_in_dir = 2'b11;
                 pc_sign = 1'b1;
-                pc_en = 1;
-                // BGE_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
+                pc_en = 1'b1;
             end
-            /* BGE指令 */
 
-            /* JAL指令 */
-            JAL_S1: begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // JAL_S1状态启用
+            /* JAL/JALR指令：时钟下降沿将pc(已经指向下一条指令)写入x[rd]，离开状态时跳转 */
+            JAL: begin
                 reg_in_dir = 2'b11;
                 reg_we = 1'b1;
-                reg_en = 1'b1;
-            end
-            JAL_S2: begin
-                // JAL_S2状态启用
+                reg_en = !clk;
                 pc_in_dir = 2'b01;
                 pc_sign = 1'b1;
-                pc_en = 1;
-                // JAL_S1状态复位
-                reg_in_dir = 2'b00;
-                reg_we = 1'b0;
-                reg_en = 1'b0;
+                pc_en = 1'b1;
             end
-            /* JAL指令 */
-
-            /* JALR指令 */
-            JALR_S1: begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // JALR_S1状态启用
+            JALR: begin
+                // x[rd]先于pc写入，rd与rs1相同时跳转的基址为下一条指令的地址
                 reg_in_dir = 2'b11;
                 reg_we = 1'b1;
-                reg_en = 1'b1;
-            end
-            JALR_S2: begin
-                // JALR_S2状态启用
+                reg_en = !clk;
                 pc_in_dir = 2'b10;
                 pc_sign = 1'b1;
-                pc_en = 1;
-                // JALR_S1状态复位
-                reg_in_dir = 2'b00;
-                reg_we = 1'b0;
-                reg_en = 1'b0;
-            end
-            /* JALR指令 */
-
-            /* XORI指令 */
-            XORI_S1:  begin
-                // S2状态复位
-                ir_en = 1'b0;
-                // XORI_S1状态启用
-                alu_op = OP_XOR;
-                op2_dir = 2'b10;
-                alu_en = 1'b1;
+                pc_en = 1'b1;
             end
-            XORI_S2: begin
-                // XORI_S2状态启用
-                reg_in_dir = 2'b10;
+
+            CSR: begin
+                // 时钟下降沿将计数器的值写入x[rd]
+                reg_in_dir = 2'b00;
                 reg_we = 1'b1;
-                reg_en = 1'b1;
-                // XORI_S1状态复位
-                alu_op = 8'b0;
-                op2_dir  = 2'b00;
-                alu_en = 1'b0;
+                reg_en = !clk;
+            end
+
+            default: begin
             end
-            /* XORI指令 */
         endcase
     end
     
-endmodule
\ No newline at end of file
+endmodule
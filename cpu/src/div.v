@@ -0,0 +1,87 @@
+/*
+ * 模块：基4迭代除法器
+ * 简述：64位无符号除法，每个周期求出2位商（基4恢复余数法）：
+ *          r = {rem, 被除数的下2位}，与d、2d、3d比较得到商位q（0~3），rem = r - q*d
+ *       start时跳过被除数开头为0的2位数字，因此迭代次数n等于被除数的有效2位数字个数
+ *       （被除数为0或除数为0时n=0，结果为0，与原先的组合除法一致）。
+ *       start在clk上升沿有效时锁存操作数，之后的第n个上升沿结果有效并置位done。
+ * 输入：
+ *      clk    ：时钟信号
+ *      start  ：开始一次除法（上升沿采样）
+ *      a      ：被除数
+ *      b      ：除数
+ * 输出：
+ *      busy   ：正在迭代
+ *      done   ：最近一次开始的除法已经完成，保持到下一次start
+ *      result ：商
+ */
+module div (
+    input clk,
+    input start,
+    input [63:0] a,
+    input [63:0] b,
+
+    output reg busy,
+    output reg done,
+    output [63:0] result
+);
+    reg [5:0] count; // 剩余的迭代次数
+    reg [63:0] d;    // 除数
+    reg [63:0] rem;  // 部分余数
+    reg [63:0] quo;  // 高位是尚未移入余数的被除数，低位是已经求出的商
+
+    initial begin
+        busy = 1'b0;
+        done = 1'b0;
+    end
+
+    // 被除数的有效2位数字个数
+    reg [5:0] digits;
+    integer i;
+    always @(*) begin
+        digits = 6'd0;
+        for (i = 0; i < 32; i = i + 1)
+            if (a[2*i +: 2] != 2'b0)
+                digits = i[5:0] + 6'd1;
+    end
+
+    // 一次迭代：比较{rem, 下2位}与d、2d、3d
+    wire [65:0] r4 = {rem, quo[63:62]};
+    wire [65:0] d1 = {2'b0, d};
+    wire [65:0] d2 = {1'b0, d, 1'b0};
+    wire [65:0] d3 = d1 + d2;
+    wire [1:0] q = (r4 >= d3) ? 2'd3 :
+                   (r4 >= d2) ? 2'd2 :
+                   (r4 >= d1) ? 2'd1 : 2'd0;
+    wire [65:0] r_next = r4 - (q == 2'd3 ? d3 : q == 2'd2 ? d2 : q == 2'd1 ? d1 : 66'b0);
+
+    always @(posedge clk) begin
+        if (start) begin
+            d <= b;
+            rem <= 64'b0;
+            if (b == 64'b0 || digits == 6'd0) begin
+                quo <= 64'b0;
+                count <= 6'd0;
+                busy <= 1'b0;
+                done <= 1'b1;
+            end else begin
+                // 有效数字移到最高位
+                quo <= a << (7'd64 - {digits, 1'b0});
+                count <= digits;
+                busy <= 1'b1;
+                done <= 1'b0;
+            end
+        end else if (busy) begin
+            rem <= r_next[63:0];
+            quo <= {quo[61:0], q};
+            count <= count - 6'd1;
+            if (count == 6'd1) begin
+                busy <= 1'b0;
+                done <= 1'b1;
+            end
+        end
+    end
+
+    assign result = quo;
+
+endmodule
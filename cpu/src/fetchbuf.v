@@ -0,0 +1,69 @@
+/*
+ * 模块：取指缓冲
+ * 简述：ram每次读出8个字节，而一条指令只有4个字节（压缩指令2个字节）。
+ *       取指缓冲保存最近一次取指时ram读出的8个字节，顺序取指时每两条（压缩指令最多四条）指令只需访问一次ram。
+ *       取指地址在缓冲的地址之后0、2或4字节处时命中，输出从该地址开始的4个字节；
+ *       在之后6字节处时缓冲中只剩2个字节，只有地址的第1位为1（一定是压缩指令，见rvc.v）时命中，低16位补0。
+ *       命中时直接输出缓冲中的指令，不访问ram；未命中时由cpu从ram读取，并在clk上升沿把读出的8个字节装入缓冲。
+ *       发生跳转或sd写内存时作废缓冲（sd可能改写了缓冲中的指令）。
+ * 输入：
+ *      clk        ：时钟信号，所有操作在上升沿完成
+ *      en         ：本周期取指（命中时计数，未命中时装入ram_data）
+ *      inv        ：作废缓冲（优先于en）
+ *      addr       ：取指地址
+ *      ram_data   ：未命中时ram读出的8个字节
+ * 输出：
+ *      hit        ：取指地址在缓冲中
+ *      instr      ：命中时从addr开始的4个字节
+ *      hit_count  ：命中次数
+ *      miss_count ：未命中次数
+ */
+module fetchbuf (
+    input clk,
+    input en,
+    input inv,
+    input [63:0] addr,
+    input [63:0] ram_data,
+
+    output hit,
+    output [31:0] instr,
+    output reg [63:0] hit_count,
+    output reg [63:0] miss_count
+);
+    reg valid;
+    reg [63:0] tag; // 缓冲中第一条指令的地址
+    reg [63:0] data;
+
+    initial begin
+        valid = 1'b0;
+        hit_count = 64'b0;
+        miss_count = 64'b0;
+    end
+
+    // 取指地址在缓冲中的偏移量：必须是偶数且小于8
+    wire [63:0] offset = addr - tag;
+    wire in_buf = (offset[63:3] == 61'b0) && !offset[0];
+
+    assign hit = valid && in_buf && (offset[2:1] != 2'b11 || addr[1]);
+    // ram使用大端序，地址较低的字节在高位
+    assign instr = offset[2:1] == 2'b00 ? data[63:32] :
+                   offset[2:1] == 2'b01 ? data[47:16] :
+                   offset[2:1] == 2'b10 ? data[31:0] :
+                   {data[15:0], 16'b0};
+
+    always @(posedge clk) begin
+        if (inv) begin
+            valid <= 1'b0;
+        end else if (en) begin
+            if (hit) begin
+                hit_count <= hit_count + 64'd1;
+            end else begin
+                miss_count <= miss_count + 64'd1;
+                valid <= 1'b1;
+                tag <= addr;
+                data <= ram_data;
+            end
+        end
+    end
+
+endmodule
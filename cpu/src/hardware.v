@@ -7,29 +7,69 @@ module hardware (
     input test_we,
     input test_oe,
     input [63:0] test_addr,
-    input [63:0] test_data
+    input [63:0] test_data,
+
+    // cpu的观测接口
+    output dbg_retire,
+    output [63:0] dbg_pc,
+    output [31:0] dbg_instr,
+    output dbg_store,
+    output [63:0] dbg_store_addr,
+    output [63:0] dbg_store_data,
+    output [63:0] dbg_fetch_hits,
+    output [63:0] dbg_fetch_misses,
+    output dbg_halt
 );
 
     wire [63:0] bus_addr;
     wire [63:0] bus_data;
     wire ram_cs, ram_we, ram_oe;
+    wire [7:0] ram_be;
+    wire mem_ready; // 访存总线：本周期cpu的读写可以完成
+    wire mem_restart; // 访存总线：本周期的请求不是上一个周期等待的那一次
     wire [63:0] ram_data;  // 中间信号
 
+    // 编译时选择cpu的实现：多周期（cpu.v，默认）或五级流水线（cpu_pipe.v）
+`ifdef CORE_PIPELINE
+    cpu_pipe cpu_inst (
+`else
     cpu cpu_inst (
+`endif
         .clk(clk),
         .reset(1'b0),
         .bus_addr(bus_addr),
         .bus_data(ram_data),
         .ram_cs(ram_cs),
         .ram_we(ram_we),
-        .ram_oe(ram_oe)
+        .ram_oe(ram_oe),
+        .ram_be(ram_be),
+        .mem_ready(mem_ready),
+        .mem_restart(mem_restart),
+        .dbg_retire(dbg_retire),
+        .dbg_pc(dbg_pc),
+        .dbg_instr(dbg_instr),
+        .dbg_store(dbg_store),
+        .dbg_store_addr(dbg_store_addr),
+        .dbg_store_data(dbg_store_data),
+        .dbg_fetch_hits(dbg_fetch_hits),
+        .dbg_fetch_misses(dbg_fetch_misses),
+        .dbg_halt(dbg_halt)
+    );
+
+    // cpu与ram之间的valid/ready握手和延迟模型，ram只在mem_ready有效时收到片选信号
+    membus membus_inst (
+        .clk(clk),
+        .valid(ram_oe || ram_we),
+        .restart(mem_restart),
+        .ready(mem_ready)
     );
 
     ram ram_inst (
-        .cs(test_en ? test_cs : ram_cs),
+        .cs(test_en ? test_cs : ram_cs && mem_ready),
         .we(test_en ? test_we : ram_we),
         .oe(test_en ? test_oe : ram_oe),
         .addr(test_en ? test_addr : bus_addr),
+        .be(test_en ? 8'hFF : ram_be),
         .data(ram_data)  // 使用中间信号
     );
 
@@ -0,0 +1,66 @@
+/*
+ * 模块：访存格式转换
+ * 简述：组合逻辑，按访存指令的funct3转换ram的数据总线与寄存器之间的数据，供cpu.v和cpu_pipe.v共用。
+ *       ram按大端序读出addr起的8个字节，addr处的字节在最高位，因此：
+ *          读：lb/lh/lw取总线的高1/2/4个字节，按符号位扩展；lbu/lhu/lwu零扩展；ld取整个字；
+ *          写：sb/sh/sw把x[rs2]的低1/2/4个字节移到总线的高位，字节使能只选中这几个字节。
+ *       funct3的编码：000 b、001 h、010 w、011 d，最高位为1时为无符号的读（lbu/lhu/lwu）。
+ * 输入：
+ *      funct3     ：访存指令的funct3
+ *      ram_data   ：从ram读出的64位数据
+ *      store_data ：要写入的数据x[rs2]
+ * 输出：
+ *      load_value ：扩展之后写入x[rd]的值
+ *      bus_data   ：写入时驱动到数据总线上的数据
+ *      be         ：写入的字节使能，be[7]对应bus_data[63:56]
+ *      store_value：实际写入的数据（x[rs2]的低位字节，零扩展），供观测接口使用
+ */
+module lsu (
+    input [2:0] funct3,
+    input [63:0] ram_data,
+    input [63:0] store_data,
+
+    output reg [63:0] load_value,
+    output reg [63:0] bus_data,
+    output reg [7:0] be,
+    output reg [63:0] store_value
+);
+
+    always @(*) begin
+        case (funct3)
+            3'b000: load_value = {{56{ram_data[63]}}, ram_data[63:56]}; // lb
+            3'b001: load_value = {{48{ram_data[63]}}, ram_data[63:48]}; // lh
+            3'b010: load_value = {{32{ram_data[63]}}, ram_data[63:32]}; // lw
+            3'b100: load_value = {56'b0, ram_data[63:56]}; // lbu
+            3'b101: load_value = {48'b0, ram_data[63:48]}; // lhu
+            3'b110: load_value = {32'b0, ram_data[63:32]}; // lwu
+            default: load_value = ram_data; // ld
+        endcase
+    end
+
+    always @(*) begin
+        case (funct3[1:0])
+            2'b00: begin // sb
+                bus_data = {store_data[7:0], 56'b0};
+                be = 8'b1000_0000;
+                store_value = {56'b0, store_data[7:0]};
+            end
+            2'b01: begin // sh
+                bus_data = {store_data[15:0], 48'b0};
+                be = 8'b1100_0000;
+                store_value = {48'b0, store_data[15:0]};
+            end
+            2'b10: begin // sw
+                bus_data = {store_data[31:0], 32'b0};
+                be = 8'b1111_0000;
+                store_value = {32'b0, store_data[31:0]};
+            end
+            default: begin // sd
+                bus_data = store_data;
+                be = 8'b1111_1111;
+                store_value = store_data;
+            end
+        endcase
+    end
+
+endmodule
@@ -0,0 +1,85 @@
+/*
+ * 模块：访存总线
+ * 简述：cpu与ram之间的valid/ready握手，以及访存的延迟和带宽模型。
+ *       cpu读写ram时在整个周期内保持请求（valid，即ram_oe或ram_we），ready有效的周期访存完成：
+ *       ram的片选信号只在ready有效时传给ram；ready无效时多周期cpu停在原状态，
+ *       流水线cpu停顿发出请求的级，直到ready有效。
+ *       每次访存的延迟（请求发出之后还要等待的周期数）由DPI-C实现的延迟模型给出
+ *       （test/bus_model.hpp：固定、随机或按文件给出），下一次访存的延迟在上一次访存完成时取得；
+ *       相邻两次访存完成之间至少间隔interval个周期，用来限制带宽。
+ *       延迟为0且不限制带宽时ready恒有效，cpu的时序与直接连接ram时完全相同。
+ *       请求在完成之前被撤回（valid无效）时放弃已经等待的周期；流水线cpu在等待中换了发出请求的级时
+ *       （取指等待时MEM级开始访存）给出restart，本周期的请求重新开始等待。
+ *       被放弃的请求没有完成，不取新的延迟：下一次请求仍使用它的延迟。
+ * 输入：
+ *      clk     ：时钟信号，在上升沿更新等待的状态
+ *      valid   ：本周期cpu请求读或写ram
+ *      restart ：本周期的请求不是上一个周期等待的那一次
+ * 输出：
+ *      ready ：本周期的请求可以完成
+ */
+module membus (
+    input clk,
+    input valid,
+    input restart,
+
+    output ready
+);
+
+    import "DPI-C" function longint bus_dpi_open();
+    import "DPI-C" function void bus_dpi_close(input longint handle);
+    import "DPI-C" function int bus_dpi_latency(input longint handle);
+    import "DPI-C" function int bus_dpi_interval(input longint handle);
+
+    /* 延迟模型的句柄（public：供仿真程序在仿真开始之前设置延迟模型） */
+    reg [63:0] handle /*verilator public*/;
+
+    initial handle = bus_dpi_open();
+    final bus_dpi_close(handle);
+
+    reg primed;           // 已经从延迟模型取得了第一次访存的延迟
+    reg waiting;          // 当前的请求已经等待过至少一个周期（请求撤回或restart时作废）
+    reg [31:0] latency;   // 下一次请求的延迟（当前请求尚未开始等待时即为它的延迟）
+    reg [31:0] remaining; // 当前的请求还要等待的周期数
+    reg [31:0] interval;  // 相邻两次访存完成之间的最小间隔
+    reg [31:0] since;     // 上一次访存完成之后经过的周期数，达到interval之后不再增加
+
+    initial begin
+        primed = 1'b0;
+        waiting = 1'b0;
+        since = 32'hFFFF_FFFF;
+    end
+
+    wire pending = waiting && !restart; // 本周期的请求就是正在等待的那一次
+
+    assign ready = primed && (pending ? remaining == 32'b0 : latency == 32'b0) &&
+                   since >= interval;
+
+    // 延迟模型在仿真程序构造模型之后才设置，因此在第一个上升沿才取第一次访存的延迟，
+    // cpu在第一个周期不访问ram（多周期cpu的PREPARE状态，流水线cpu的running）
+    always @(posedge clk) begin
+        if (!primed) begin
+            primed <= 1'b1;
+            latency <= bus_dpi_latency(handle);
+            interval <= bus_dpi_interval(handle);
+        end else if (valid && ready) begin
+            // 访存完成，取下一次访存的延迟
+            waiting <= 1'b0;
+            latency <= bus_dpi_latency(handle);
+            since <= 32'd1;
+        end else begin
+            if (!valid) begin
+                // 请求撤回：已经等待的周期不计入下一次请求
+                waiting <= 1'b0;
+            end else if (!pending) begin
+                waiting <= 1'b1;
+                remaining <= (latency == 32'b0) ? 32'b0 : latency - 32'd1;
+            end else if (remaining != 32'b0) begin
+                remaining <= remaining - 32'd1;
+            end
+            if (since < interval)
+                since <= since + 32'd1;
+        end
+    end
+
+endmodule
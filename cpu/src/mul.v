@@ -0,0 +1,78 @@
+/*
+ * 模块：流水线乘法器
+ * 简述：计算64位乘积的低64位，分为4级流水线，每一级只做64x16位的乘法和一次加法：
+ *          第k级（k=0~3）：acc += (a * b[16k+15:16k]) << 16k
+ *       start在clk上升沿有效时锁存操作数，之后的第3个上升沿结果有效并置位done，
+ *       每个周期都可以开始一次新的乘法。
+ * 输入：
+ *      clk    ：时钟信号
+ *      start  ：开始一次乘法（上升沿采样）
+ *      a, b   ：操作数
+ * 输出：
+ *      busy   ：流水线中有尚未完成的乘法
+ *      done   ：最近一次开始的乘法已经完成，保持到下一次start
+ *      result ：乘积的低64位
+ */
+module mul (
+    input clk,
+    input start,
+    input [63:0] a,
+    input [63:0] b,
+
+    output busy,
+    output reg done,
+    output [63:0] result
+);
+    // 各级流水线寄存器：有效位、部分和以及操作数
+    reg v0, v1, v2;
+    reg [63:0] acc0, acc1, acc2, acc3;
+    reg [63:0] a0, a1, a2;
+    reg [63:0] b0, b1, b2;
+
+    initial begin
+        v0 = 1'b0;
+        v1 = 1'b0;
+        v2 = 1'b0;
+        done = 1'b0;
+    end
+
+    always @(posedge clk) begin
+        // 第0级
+        v0 <= start;
+        if (start) begin
+            acc0 <= a * {48'b0, b[15:0]};
+            a0 <= a;
+            b0 <= b;
+        end
+
+        // 第1级
+        v1 <= v0;
+        if (v0) begin
+            acc1 <= acc0 + ((a0 * {48'b0, b0[31:16]}) << 16);
+            a1 <= a0;
+            b1 <= b0;
+        end
+
+        // 第2级
+        v2 <= v1;
+        if (v1) begin
+            acc2 <= acc1 + ((a1 * {48'b0, b1[47:32]}) << 32);
+            a2 <= a1;
+            b2 <= b1;
+        end
+
+        // 第3级
+        if (v2)
+            acc3 <= acc2 + ((a2 * {48'b0, b2[63:48]}) << 48);
+
+        // 第3级完成的是流水线中最新的一次乘法时，才置位done
+        if (start)
+            done <= 1'b0;
+        else if (v2 && !v1 && !v0)
+            done <= 1'b1;
+    end
+
+    assign busy = v0 || v1 || v2;
+    assign result = acc3;
+
+endmodule
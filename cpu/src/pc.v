@@ -6,7 +6,8 @@
  *      en             ：使能信号（高电平有效）
  *      reset          ：同步复位信号（高电平有效）
  *      tar            ：跳转目标地址（64位）
- *      sign           ：PC更新选择信号（0=PC+4，1=跳转地址）
+ *      sign           ：PC更新选择信号（0=顺序执行，1=跳转地址）
+ *      half           ：当前指令是压缩指令，顺序执行时PC+2（否则PC+4）
  * 输出：
  *      pc_addr        ：当前指令地址（64位）
  */
@@ -16,14 +17,15 @@
     input               reset,
     input       [63:0]  tar,
     input               sign,
-    output reg  [63:0]  pc_addr
+    input               half,
+    output reg  [63:0]  pc_addr /*verilator public*/ // public：仿真程序装载映像时设为入口地址
 );
 
 //复位地址
 localparam reset_add = 64'h00000000;
 
 //组合逻辑计算下一个PC值
-wire [63:0] next_pc = sign ? tar : (pc_addr + 64'd4);
+wire [63:0] next_pc = sign ? tar : (pc_addr + (half ? 64'd2 : 64'd4));
 
 //时序逻辑更新PC
 always @(posedge clk) begin
@@ -0,0 +1,132 @@
+/*
+ * 模块：性能计数器
+ * 简述：17个64位计数器，在时钟上升沿根据本周期发生的事件计数，
+ *       可由csrr指令按CSR地址0xC00~0xC10读取（其余地址读出0）：
+ *          0xC00 cycle      ：时钟周期数
+ *          0xC01 time       ：未实现，恒为0
+ *          0xC02 instret    ：完成的指令数
+ *          0xC03 mem_read   ：ram读次数（取指和ld）
+ *          0xC04 mem_write  ：ram写次数（sd）
+ *          0xC05 br_taken   ：跳转的beq/bge条数
+ *          0xC06 cls_alu    ：add/addi/sub/sll/srl/and/or/xor/xori/lui条数
+ *          0xC07 cls_muldiv ：mul/div条数
+ *          0xC08 cls_load   ：ld条数
+ *          0xC09 cls_store  ：sd条数
+ *          0xC0A cls_branch ：beq/bge条数
+ *          0xC0B cls_jump   ：jal/jalr条数
+ *          0xC0C cls_csr    ：csrr条数
+ *          0xC0D stall_load ：ld之后使用其结果而停顿的周期数（流水线）
+ *          0xC0E stall_mem  ：ram被MEM级占用而不能取指的周期数（流水线）
+ *          0xC0F flush      ：跳转冲刷流水线的次数（流水线）
+ *          0xC10 stall_bus  ：等待ram完成读写的周期数（见membus.v）
+ *       一条指令在读instret时，之前的指令都已经计入，自身尚未计入。
+ * 输入：
+ *      clk        ：时钟信号
+ *      en         ：计数使能（cpu开始运行之后有效）
+ *      retire     ：本周期完成了一条指令
+ *      exec       ：本周期执行了instr（按instr的类别计数，不属于任何类别的指令不计数）
+ *      instr      ：执行的指令
+ *      mem_read   ：本周期读了ram
+ *      mem_write  ：本周期写了ram
+ *      br_taken   ：本周期beq/bge跳转
+ *      stall_load ：本周期因ld之后使用其结果而停顿
+ *      stall_mem  ：本周期因ram被占用而不能取指
+ *      flush      ：本周期跳转冲刷了流水线
+ *      stall_bus  ：本周期等待ram完成读写
+ *      csr        ：读取的CSR地址
+ * 输出：
+ *      value      ：CSR地址对应的计数值
+ */
+module perf (
+    input clk,
+    input en,
+    input retire,
+    input exec,
+    input [31:0] instr,
+    input mem_read,
+    input mem_write,
+    input br_taken,
+    input stall_load,
+    input stall_mem,
+    input flush,
+    input stall_bus,
+    input [11:0] csr,
+    output [63:0] value
+);
+
+localparam [4:0]
+    CNT_CYCLE      = 5'h00,
+    CNT_INSTRET    = 5'h02,
+    CNT_MEM_READ   = 5'h03,
+    CNT_MEM_WRITE  = 5'h04,
+    CNT_BR_TAKEN   = 5'h05,
+    CNT_CLS_ALU    = 5'h06,
+    CNT_CLS_MULDIV = 5'h07,
+    CNT_CLS_LOAD   = 5'h08,
+    CNT_CLS_STORE  = 5'h09,
+    CNT_CLS_BRANCH = 5'h0A,
+    CNT_CLS_JUMP   = 5'h0B,
+    CNT_CLS_CSR    = 5'h0C,
+    CNT_STALL_LOAD = 5'h0D,
+    CNT_STALL_MEM  = 5'h0E,
+    CNT_FLUSH      = 5'h0F,
+    CNT_STALL_BUS  = 5'h10,
+    CNT_LAST       = CNT_STALL_BUS;
+
+    // 计数器（public：供仿真程序在结束时输出）
+    reg [63:0] counters [CNT_LAST:0] /*verilator public*/;
+
+    integer i;
+    initial begin
+        for (i = 0; i <= CNT_LAST; i = i + 1)
+            counters[i] = 64'b0;
+    end
+
+    // 按操作码确定指令的类别；未知的操作码没有类别（has_cls为0）
+    wire [6:0] opcode = instr[6:0];
+    reg [4:0] cls;
+    reg has_cls;
+    always @(*) begin
+        has_cls = 1'b1;
+        case (opcode)
+            7'b0110011: cls = (instr[31:25] == 7'b0000001) ? CNT_CLS_MULDIV : CNT_CLS_ALU;
+            7'b0010011, 7'b0110111: cls = CNT_CLS_ALU;
+            7'b0000011: cls = CNT_CLS_LOAD;
+            7'b0100011: cls = CNT_CLS_STORE;
+            7'b1100011: cls = CNT_CLS_BRANCH;
+            7'b1101111, 7'b1100111: cls = CNT_CLS_JUMP;
+            7'b1110011: cls = CNT_CLS_CSR;
+            default: begin
+                cls = CNT_CYCLE;
+                has_cls = 1'b0;
+            end
+        endcase
+    end
+
+    always @(posedge clk) begin
+        if (en) begin
+            counters[CNT_CYCLE] <= counters[CNT_CYCLE] + 64'd1;
+            if (retire)
+                counters[CNT_INSTRET] <= counters[CNT_INSTRET] + 64'd1;
+            if (mem_read)
+                counters[CNT_MEM_READ] <= counters[CNT_MEM_READ] + 64'd1;
+            if (mem_write)
+                counters[CNT_MEM_WRITE] <= counters[CNT_MEM_WRITE] + 64'd1;
+            if (br_taken)
+                counters[CNT_BR_TAKEN] <= counters[CNT_BR_TAKEN] + 64'd1;
+            if (exec && has_cls)
+                counters[cls] <= counters[cls] + 64'd1;
+            if (stall_load)
+                counters[CNT_STALL_LOAD] <= counters[CNT_STALL_LOAD] + 64'd1;
+            if (stall_mem)
+                counters[CNT_STALL_MEM] <= counters[CNT_STALL_MEM] + 64'd1;
+            if (flush)
+                counters[CNT_FLUSH] <= counters[CNT_FLUSH] + 64'd1;
+            if (stall_bus)
+                counters[CNT_STALL_BUS] <= counters[CNT_STALL_BUS] + 64'd1;
+        end
+    end
+
+    assign value = (csr >= 12'hC00 && csr <= 12'hC00 + CNT_LAST) ? counters[csr[4:0]] : 64'b0;
+
+endmodule
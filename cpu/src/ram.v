@@ -1,11 +1,17 @@
 /*
  * 模块：RAM模块
  * 简述：提供 256M x 8bit 的RAM模块，支持读写操作，使用大端序存储。
+ *       存储阵列由DPI-C实现（test/sparse_ram.cpp），按4KB页在首次写入时分配，
+ *       因此模型构造时不再需要分配和初始化完整的256MB。
+ *       每次访问addr起的8个字节（一个64位字）：读出整个字，写入时只写be使能的字节，
+ *       sb/sh/sw因此不需要先读出再写回。
+ *       读操作之后ram一直驱动数据总线，直到写使能有效时才释放。
  * 输入：
  *      cs   ：片选信号（1使能）
  *      we   ：写使能信号（1使能）
  *      oe   ：读使能信号（1使能）
  *      addr ：地址总线，保持64bit输入，但实际使用低28位（256M地址空间）
+ *      be   ：写入的字节使能，be[7]对应data[63:56]（addr处的字节），be[0]对应data[7:0]
  *      data ：数据总线，64位
  * 输出：
  *      data ：数据总线，64位
@@ -15,12 +21,21 @@ module ram (
     input        we,     
     input        oe,     
     input  [63:0] addr,   
+    input  [7:0]  be,
 
     inout  [63:0] data   
 );
 
-    /* 256M x 8bit 的存储空间，即256MB */
-    reg [7:0] mem [0:268435455];
+    import "DPI-C" function longint ram_dpi_open();
+    import "DPI-C" function void ram_dpi_close(input longint handle);
+    import "DPI-C" function longint ram_dpi_read(input longint handle, input longint addr);
+    import "DPI-C" function void ram_dpi_write(input longint handle, input longint addr, input longint data, input byte be);
+
+    /* 256M x 8bit 的存储空间的句柄（public：供仿真程序通过后门直接访问存储） */
+    reg [63:0] handle /*verilator public*/;
+
+    initial handle = ram_dpi_open();
+    final ram_dpi_close(handle);
     
     // 三态控制逻辑
     reg [63:0] data_out;
@@ -29,25 +44,16 @@ module ram (
     // 大端序实现
     always @(posedge cs) begin
         if (we) begin
-            mem[addr[27:0]+0] <= data[63:56];
-            mem[addr[27:0]+1] <= data[55:48];
-            mem[addr[27:0]+2] <= data[47:40];
-            mem[addr[27:0]+3] <= data[39:32];
-            mem[addr[27:0]+4] <= data[31:24];
-            mem[addr[27:0]+5] <= data[23:16];
-            mem[addr[27:0]+6] <= data[15:8];
-            mem[addr[27:0]+7] <= data[7:0];
+            ram_dpi_write(handle, {36'b0, addr[27:0]}, data, be);
             data_dir <= 0;
         end
         else if (oe) begin
-            data_out <= {mem[addr[27:0]+0], mem[addr[27:0]+1],
-                        mem[addr[27:0]+2], mem[addr[27:0]+3],
-                        mem[addr[27:0]+4], mem[addr[27:0]+5],
-                        mem[addr[27:0]+6], mem[addr[27:0]+7]};
+            data_out <= ram_dpi_read(handle, {36'b0, addr[27:0]});
             data_dir <= 1;
         end
     end
     
-    assign data = data_dir ? data_out : 64'bz;
+    // 写使能有效时释放数据总线，写入的数据只来自总线上的其他驱动者
+    assign data = (data_dir && !we) ? data_out : 64'bz;
 
-endmodule
\ No newline at end of file
+endmodule
@@ -21,8 +21,8 @@ module regfile (
     input [63:0] write_data
 );
 
-    // 寄存器堆定义（x0恒为0）
-    reg [63:0] registers [31:0];
+    // 寄存器堆定义（x0恒为0；public：供仿真程序与参考模型比对）
+    reg [63:0] registers [31:0] /*verilator public*/;
 
     // 写操作由en上升沿触发
     always @(posedge en) begin 
@@ -0,0 +1,123 @@
+/*
+ * 模块：压缩指令展开
+ * 简述：把一条16位的压缩指令展开为32位的指令，编码和支持的指令与as/src/rvc.hpp的expand()相同：
+ *          c.addi4spn c.lw c.ld c.sw c.sd
+ *          c.nop c.addi c.li c.addi16sp c.lui c.sub c.xor c.or c.and c.j c.beqz
+ *          c.lwsp c.ldsp c.jr c.mv c.jalr c.add c.swsp c.sdsp
+ *       c.j和c.beqz展开后的偏移量不左移，相对于下一条指令的地址（pc+2）。
+ *       压缩指令两条一组占据一个4字节对齐的字（高16位是第一条），取指时地址的第1位为1，
+ *       或者该地址处32位的低2位不为11，就是一条压缩指令，编码为这32位的高16位。
+ *       组合逻辑，展开在取指的路径上完成，IR和流水线寄存器中保存的是展开之后的指令。
+ * 输入：
+ *      c     ：压缩指令
+ * 输出：
+ *      instr ：展开之后的指令，保留的编码和不支持的压缩指令输出0（未知指令）
+ */
+module rvc (
+    input [15:0] c,
+    output reg [31:0] instr
+);
+    // 寄存器：rd/rs1和rs2，以及x8~x15的3位编码
+    wire [4:0] rd = c[11:7];
+    wire [4:0] rs2 = c[6:2];
+    wire [4:0] rd_s = {2'b01, c[4:2]};
+    wire [4:0] rs1_s = {2'b01, c[9:7]};
+
+    // 各种立即数在编码中的位置与RV64C相同，统一扩展为12位
+    wire [11:0] imm6 = {{6{c[12]}}, c[12], c[6:2]};
+    wire [11:0] uimm_4spn = {2'b0, c[10:7], c[12:11], c[5], c[6], 2'b0};
+    wire [11:0] uimm_w = {5'b0, c[5], c[12:10], c[6], 2'b0};
+    wire [11:0] uimm_d = {4'b0, c[6:5], c[12:10], 3'b0};
+    wire [11:0] uimm_lwsp = {4'b0, c[3:2], c[12], c[6:4], 2'b0};
+    wire [11:0] uimm_ldsp = {3'b0, c[4:2], c[12], c[6:5], 3'b0};
+    wire [11:0] uimm_swsp = {4'b0, c[8:7], c[12:9], 2'b0};
+    wire [11:0] uimm_sdsp = {3'b0, c[9:7], c[12:10], 3'b0};
+    wire [11:0] imm_16sp = {{2{c[12]}}, c[12], c[4:3], c[5], c[2], c[6], 4'b0};
+    wire [11:0] off_j = {c[12], c[8], c[10:9], c[6], c[7], c[2], c[11], c[5:3], 1'b0};
+    wire [11:0] off_b = {{3{c[12]}}, c[12], c[6:5], c[2], c[11:10], c[4:3], 1'b0};
+    wire [19:0] off_jal = {{8{off_j[11]}}, off_j};
+
+    // 展开后的指令：格式与as/src/isa.hpp的encode()相同
+    function [31:0] i_type(input [11:0] imm, input [4:0] src1, input [2:0] funct3,
+                           input [4:0] dst, input [6:0] opcode);
+        i_type = {imm, src1, funct3, dst, opcode};
+    endfunction
+
+    function [31:0] s_type(input [11:0] imm, input [4:0] src2, input [4:0] src1, input [2:0] funct3);
+        s_type = {imm[11:5], src2, src1, funct3, imm[4:0], 7'b0100011};
+    endfunction
+
+    function [31:0] r_type(input [6:0] funct7, input [4:0] src2, input [4:0] src1,
+                           input [2:0] funct3, input [4:0] dst);
+        r_type = {funct7, src2, src1, funct3, dst, 7'b0110011};
+    endfunction
+
+    always @(*) begin
+        instr = 32'b0;
+        case ({c[1:0], c[15:13]})
+            // c.addi4spn rd' nzuimm：addi rd' x2 nzuimm
+            5'b00_000: if (uimm_4spn != 12'b0) instr = i_type(uimm_4spn, 5'd2, 3'b000, rd_s, 7'b0010011);
+            // c.lw/c.ld rd' uimm(rs1')
+            5'b00_010: instr = i_type(uimm_w, rs1_s, 3'b010, rd_s, 7'b0000011);
+            5'b00_011: instr = i_type(uimm_d, rs1_s, 3'b011, rd_s, 7'b0000011);
+            // c.sw/c.sd rs2' uimm(rs1')
+            5'b00_110: instr = s_type(uimm_w, rd_s, rs1_s, 3'b010);
+            5'b00_111: instr = s_type(uimm_d, rd_s, rs1_s, 3'b011);
+
+            // c.nop / c.addi rd nzimm：addi rd rd nzimm
+            5'b01_000: begin
+                if (rd == 5'b0 && imm6 == 12'b0)
+                    instr = i_type(12'b0, 5'd0, 3'b000, 5'd0, 7'b0010011);
+                else if (rd != 5'b0 && imm6 != 12'b0)
+                    instr = i_type(imm6, rd, 3'b000, rd, 7'b0010011);
+            end
+            // c.li rd imm：addi rd x0 imm
+            5'b01_010: if (rd != 5'b0) instr = i_type(imm6, 5'd0, 3'b000, rd, 7'b0010011);
+            // c.addi16sp nzimm：addi x2 x2 nzimm；c.lui rd nzimm：lui rd nzimm
+            5'b01_011: begin
+                if (rd == 5'd2) begin
+                    if (imm_16sp != 12'b0)
+                        instr = i_type(imm_16sp, 5'd2, 3'b000, 5'd2, 7'b0010011);
+                end else if (rd != 5'b0 && imm6 != 12'b0) begin
+                    instr = {{8{imm6[11]}}, imm6, rd, 7'b0110111};
+                end
+            end
+            // c.sub/c.xor/c.or/c.and rd' rs2'：op rd' rd' rs2'；c.srli/c.srai/c.andi/c.subw/c.addw不支持
+            5'b01_100: begin
+                if (c[12:10] == 3'b011) begin
+                    case (c[6:5])
+                        2'b00: instr = r_type(7'b0100000, rd_s, rs1_s, 3'b000, rs1_s);
+                        2'b01: instr = r_type(7'b0000000, rd_s, rs1_s, 3'b100, rs1_s);
+                        2'b10: instr = r_type(7'b0000000, rd_s, rs1_s, 3'b110, rs1_s);
+                        2'b11: instr = r_type(7'b0000000, rd_s, rs1_s, 3'b111, rs1_s);
+                    endcase
+                end
+            end
+            // c.j offset：jal x0 offset（偏移量不左移）
+            5'b01_101: instr = {off_jal[19], off_jal[9:0], off_jal[10], off_jal[18:11], 5'd0, 7'b1101111};
+            // c.beqz rs1' offset：beq rs1' x0 offset（偏移量不左移）
+            5'b01_110: instr = {off_b[11], off_b[9:4], 5'd0, rs1_s, 3'b000, off_b[3:0], off_b[10], 7'b1100011};
+
+            // c.lwsp/c.ldsp rd uimm(x2)
+            5'b10_010: if (rd != 5'b0) instr = i_type(uimm_lwsp, 5'd2, 3'b010, rd, 7'b0000011);
+            5'b10_011: if (rd != 5'b0) instr = i_type(uimm_ldsp, 5'd2, 3'b011, rd, 7'b0000011);
+            // c.jr/c.mv/c.jalr/c.add：jalr的funct3为010；rd为0时是c.ebreak和保留的编码
+            5'b10_100: begin
+                if (rd != 5'b0) begin
+                    if (!c[12])
+                        instr = rs2 != 5'b0 ? r_type(7'b0, rs2, 5'd0, 3'b000, rd)
+                                            : i_type(12'b0, rd, 3'b010, 5'd0, 7'b1100111);
+                    else
+                        instr = rs2 != 5'b0 ? r_type(7'b0, rs2, rd, 3'b000, rd)
+                                            : i_type(12'b0, rd, 3'b010, 5'd1, 7'b1100111);
+                end
+            end
+            // c.swsp/c.sdsp rs2 uimm(x2)
+            5'b10_110: instr = s_type(uimm_swsp, rs2, 5'd2, 3'b010);
+            5'b10_111: instr = s_type(uimm_sdsp, rs2, 5'd2, 3'b011);
+
+            default: instr = 32'b0;
+        endcase
+    end
+
+endmodule
@@ -1,73 +1,11 @@
-#include "Valu.h"
+#include "alu.hpp"
 #include <cstdint>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 
-enum ALU_OP {
-    ALU_OP_ADD,
-    ALU_OP_ADDI,
-    ALU_OP_SUB,
-    ALU_OP_MUL,
-    ALU_OP_DIV,
-
-    ALU_OP_SLL,
-    ALU_OP_SRL,
-
-    ALU_OP_AND,
-    ALU_OP_OR,
-    ALU_OP_NOT,
-    ALU_OP_XOR,
-
-    ALU_OP_LUI
-};
-
-uint64_t alu_verilog(Valu* alu, uint8_t op, uint64_t a, uint64_t b) {
-    // 设置模块输入
-    alu->opcode = op;
-    alu->operand1 = a;
-    alu->operand2 = b;
-
-    // 仿真使能触发
-    alu->en = 0;
-    alu->eval();
-    alu->en = 1;
-    alu->eval();
-
-    return alu->result;
-}
-
-uint64_t alu_cpp(uint8_t op, uint64_t a, uint64_t b) {
-    switch (op) {
-    case ALU_OP_ADD:
-        return a + b;
-    case ALU_OP_ADDI:
-        return a + b;
-    case ALU_OP_SUB:
-        return a - b;
-    case ALU_OP_MUL:
-        return a * b;
-    case ALU_OP_DIV:
-        return b != 0 ? a / b : 0;
-
-    case ALU_OP_SLL:
-        return a << (b & 0x3F); // 取低6位
-    case ALU_OP_SRL:
-        return a >> (b & 0x3F); // 取低6位
-
-    case ALU_OP_AND:
-        return a & b;
-    case ALU_OP_OR:
-        return a | b;
-    case ALU_OP_NOT:
-        return ~a;
-    case ALU_OP_XOR:
-        return a ^ b;
-
-    case ALU_OP_LUI:
-        return b << 12;
-    default:
-        return 0;
-    }
-}
+using namespace alu;
 
 struct OP {
     uint8_t op;
@@ -75,9 +13,16 @@ struct OP {
     uint64_t b;
 };
 
-int main() {
+int main(int argc, char** argv) {
     Valu top;
     int test_count = 0, pass_count = 0;
+    top.clk = 0;
+    top.start = 0;
+
+    // 随机测试的种子，可由命令行指定以便复现
+    uint64_t seed = argc > 1 ? std::stoull(argv[1]) : 1;
+    std::mt19937_64 rng(seed);
+    const int RANDOM_PER_OP = 1000;
 
     // 测试用例数组 {op, a, b}
     const OP TestCases[] = {
@@ -90,25 +35,56 @@ int main() {
         {ALU_OP_AND, 0xFF, 0x0F},     {ALU_OP_OR, 0xF0, 0x0F},
         {ALU_OP_NOT, 0xFF1C, 0},      {ALU_OP_XOR, 0xAA, 0x55},
 
-        {ALU_OP_LUI, 0, 0x5678}};
+        {ALU_OP_LUI, 0, 0x5678},
 
-    for (const auto& test : TestCases) {
+        // 乘除法的边界
+        {ALU_OP_MUL, ~0ULL, ~0ULL},   {ALU_OP_MUL, 0x123456789ABCDEF, 0},
+        {ALU_OP_DIV, 0, 7},           {ALU_OP_DIV, 7, 0},
+        {ALU_OP_DIV, 3, 7},           {ALU_OP_DIV, ~0ULL, 1},
+        {ALU_OP_DIV, ~0ULL, 3},       {ALU_OP_DIV, 1ULL << 63, ~0ULL}};
+
+    // 先测固定用例，再对每种运算测随机操作数
+    std::vector<OP> tests(std::begin(TestCases), std::end(TestCases));
+    for (uint8_t op = ALU_OP_ADD; op <= ALU_OP_LUI; op++)
+        for (int i = 0; i < RANDOM_PER_OP; i++)
+            tests.push_back({op, random_operand(rng), random_operand(rng)});
+
+    int mul_cycles = 0, mul_count = 0, div_cycles = 0, div_count = 0;
+    for (const auto& test : tests) {
         test_count++;
 
         // 计算
-        uint64_t hw_result = alu_verilog(&top, test.op, test.a, test.b);
+        int latency;
+        uint64_t hw_result =
+            alu_verilog(&top, test.op, test.a, test.b, latency);
         uint64_t sw_result = alu_cpp(test.op, test.a, test.b);
+        int sw_latency = (test.op == ALU_OP_MUL || test.op == ALU_OP_DIV)
+                             ? latency_cpp(test.op, test.a, test.b)
+                             : 0;
+        if (test.op == ALU_OP_MUL) {
+            mul_cycles += latency;
+            mul_count++;
+        } else if (test.op == ALU_OP_DIV) {
+            div_cycles += latency;
+            div_count++;
+        }
 
-        // 结果比对
-        if (hw_result == sw_result) {
+        // 结果和延迟比对
+        if (hw_result == sw_result && latency == sw_latency) {
             pass_count++;
         } else {
             std::cerr << "FAIL op=" << int(test.op) << " a=0x" << std::hex
                       << test.a << " b=0x" << test.b << " HW=0x" << hw_result
-                      << " SW=0x" << sw_result << std::endl;
+                      << " SW=0x" << sw_result << std::dec
+                      << " latency=" << latency << " expected=" << sw_latency
+                      << std::endl;
         }
     }
 
+    std::cout << "Seed " << seed << ", mul latency avg "
+              << double(mul_cycles) / mul_count << ", div latency avg "
+              << double(div_cycles) / div_count << std::endl;
+
     std::cout << "Tests completed: " << test_count << " Passed: " << pass_count
               << " (" << (pass_count * 100 / test_count) << "%)" << std::endl;
     return pass_count == test_count ? 0 : 1;
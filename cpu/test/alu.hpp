@@ -0,0 +1,144 @@
+#ifndef __ALU_HPP__
+#define __ALU_HPP__
+
+#include "Valu.h"
+#include <cstdint>
+#include <random>
+
+using namespace std;
+
+/*
+ * ALU的驱动和C++参考模型，供alu.cpp的定向测试和fuzz.cpp的随机差分测试共用。
+ */
+namespace alu {
+
+/* 操作码，与alu.v中的定义一致 */
+enum ALU_OP {
+    ALU_OP_ADD,
+    ALU_OP_ADDI,
+    ALU_OP_SUB,
+    ALU_OP_MUL,
+    ALU_OP_DIV,
+
+    ALU_OP_SLL,
+    ALU_OP_SRL,
+
+    ALU_OP_AND,
+    ALU_OP_OR,
+    ALU_OP_NOT,
+    ALU_OP_XOR,
+
+    ALU_OP_LUI
+};
+
+/**
+ * @brief 乘法器/除法器预期的延迟：start之后第几个时钟上升沿完成
+ */
+inline int latency_cpp(uint8_t op, uint64_t a, uint64_t b) {
+    if (op == ALU_OP_MUL)
+        return 3;
+    // 除法：被除数的有效2位数字个数，被除数或除数为0时立即完成
+    if (a == 0 || b == 0)
+        return 0;
+    int digits = 0;
+    for (; a != 0; a >>= 2)
+        digits++;
+    return digits;
+}
+
+/**
+ * @brief 在ALU上执行一次运算
+ *
+ * @param latency 乘除法实际用了几个时钟上升沿（其余运算为0）
+ */
+inline uint64_t alu_verilog(Valu* alu, uint8_t op, uint64_t a, uint64_t b,
+                            int& latency) {
+    // 设置模块输入
+    alu->opcode = op;
+    alu->operand1 = a;
+    alu->operand2 = b;
+    latency = 0;
+
+    if (op == ALU_OP_MUL || op == ALU_OP_DIV) {
+        // 乘除法：start在一个上升沿有效，之后数上升沿直到done
+        alu->start = 1;
+        alu->clk = 0;
+        alu->eval();
+        alu->clk = 1;
+        alu->eval();
+        alu->start = 0;
+        // 开始之后操作数可以改变，不影响结果
+        alu->operand1 = ~a;
+        alu->operand2 = ~b;
+        while (!alu->done && latency < 64) {
+            alu->clk = 0;
+            alu->eval();
+            alu->clk = 1;
+            alu->eval();
+            latency++;
+        }
+        return alu->result;
+    }
+
+    // 仿真使能触发
+    alu->en = 0;
+    alu->eval();
+    alu->en = 1;
+    alu->eval();
+
+    return alu->result;
+}
+
+inline uint64_t alu_cpp(uint8_t op, uint64_t a, uint64_t b) {
+    switch (op) {
+    case ALU_OP_ADD:
+        return a + b;
+    case ALU_OP_ADDI:
+        return a + b;
+    case ALU_OP_SUB:
+        return a - b;
+    case ALU_OP_MUL:
+        return a * b;
+    case ALU_OP_DIV:
+        return b != 0 ? a / b : 0;
+
+    case ALU_OP_SLL:
+        return a << (b & 0x3F); // 取低6位
+    case ALU_OP_SRL:
+        return a >> (b & 0x3F); // 取低6位
+
+    case ALU_OP_AND:
+        return a & b;
+    case ALU_OP_OR:
+        return a | b;
+    case ALU_OP_NOT:
+        return ~a;
+    case ALU_OP_XOR:
+        return a ^ b;
+
+    case ALU_OP_LUI:
+        return b << 12;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief 随机操作数：混合全范围的随机数、小整数和2的幂附近的边界值
+ */
+inline uint64_t random_operand(mt19937_64& rng) {
+    switch (rng() % 4) {
+    case 0:
+        return rng() & 0xFF;
+    case 1:
+        return (uint64_t(1) << (rng() % 64)) - (rng() % 2);
+    case 2:
+        return rng() >> (rng() % 64);
+    default:
+        return rng();
+    }
+}
+
+} // namespace alu
+
+#endif
@@ -0,0 +1,200 @@
+#include "batch.hpp"
+#include "Vhardware.h"
+#include "hardware.hpp"
+#include "loader.hpp"
+#include "monitor.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * 批量回归：在一个进程中用多个线程并行运行许多程序，检查每个程序的停止原因和寄存器。
+ * 每个线程从工作窃取队列中取程序，为每个程序新建一个VerilatedContext和Vhardware
+ * （hardware.v没有复位信号，新建模型即可得到干净的cpu和RAM），模型只在该线程中求值。
+ */
+
+/* 一个程序的运行结果 */
+struct Result {
+    bool pass = false;
+    string message;            // 失败的原因
+    monitor::Monitor monitor;  // 周期数、退休指令数和停止原因
+    double seconds = 0;        // 仿真所用的主机时间
+};
+
+/* 命令行参数 */
+struct Options {
+    vector<batch::Job> jobs;
+    unsigned threads = 0;         // 工作线程数，0表示主机的核数
+    uint64_t max_cycles = 100000000; // 默认的最大仿真周期数
+    string stats_file;            // CSV格式的统计结果
+    string mem_latency;           // 访存总线的延迟模型，所有程序相同，为空表示fixed:0
+    uint32_t mem_interval = 0;    // 相邻两次访存完成之间的最小间隔
+};
+
+/**
+ * @brief 运行一个程序并与期望比较
+ */
+void run_job(const batch::Job& job, const Options& opts, Result& result) {
+    unique_ptr<VerilatedContext> context(new VerilatedContext);
+    unique_ptr<Vhardware> hardware(new Vhardware(context.get(), "TOP"));
+
+    uint64_t entry;
+    if (!hardware::configure_bus(hardware.get(), opts.mem_latency, opts.mem_interval)) {
+        result.message = "invalid latency model " + opts.mem_latency;
+        hardware->final();
+        return;
+    }
+    if (!loader::load_program(hardware.get(), job.bin_file, entry)) {
+        result.message = "cannot load " + job.bin_file;
+        hardware->final();
+        return;
+    }
+
+    result.monitor = monitor::Monitor(job.halt_instr, job.use_halt_instr);
+    monitor::Monitor& monitor = result.monitor;
+    uint64_t cycles = job.max_cycles ? job.max_cycles : opts.max_cycles;
+    auto begin = chrono::steady_clock::now();
+    hardware->clk = 1;
+    bool stopped = false;
+    for (uint64_t i = 0; i < 2 * cycles && !stopped; i++) {
+        hardware->clk = !hardware->clk;
+        hardware->eval();
+        if (hardware->clk)
+            stopped = monitor.step(hardware.get());
+    }
+    if (!stopped)
+        monitor.exhausted(hardware.get());
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    ostringstream why;
+    if (monitor.reason() != job.stop)
+        why << "stopped by " << monitor::reason_name(monitor.reason()) << ", expected "
+            << monitor::reason_name(job.stop) << "; ";
+    for (const auto& [idx, value] : job.regs) {
+        uint64_t actual = hardware::reg(hardware.get(), idx);
+        if (actual != value)
+            why << "x" << idx << " = 0x" << hex << actual << ", expected 0x" << value
+                << dec << "; ";
+    }
+    result.message = why.str();
+    if (!result.message.empty())
+        result.message.resize(result.message.size() - 2);
+    result.pass = result.message.empty();
+    hardware->final();
+}
+
+/**
+ * @brief 解析命令行参数
+ *
+ * @return true 解析成功
+ */
+bool parse_options(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--list" && i + 1 < argc) {
+            if (!batch::read_list(argv[++i], opts.jobs))
+                return false;
+        } else if (arg == "-j" && i + 1 < argc) {
+            opts.threads = unsigned(strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            opts.max_cycles = strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--stats" && i + 1 < argc) {
+            opts.stats_file = argv[++i];
+        } else if (arg == "--mem-latency" && i + 1 < argc) {
+            // 先检查一次，避免每个程序都报告同样的错误
+            opts.mem_latency = argv[++i];
+            bus::LatencyModel model;
+            string error;
+            if (!model.configure(opts.mem_latency, error)) {
+                cerr << "Error: " << error << endl;
+                return false;
+            }
+        } else if (arg == "--mem-interval" && i + 1 < argc) {
+            opts.mem_interval = uint32_t(strtoul(argv[++i], nullptr, 0));
+        } else if (arg.rfind("--", 0) == 0) {
+            cerr << "Unknown option: " << arg << endl;
+            return false;
+        } else {
+            // 直接给出的程序：期望以原地循环结束
+            batch::Job job;
+            job.name = job.bin_file = arg;
+            opts.jobs.push_back(job);
+        }
+    }
+    return !opts.jobs.empty();
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parse_options(argc, argv, opts)) {
+        cerr << "Usage: Vbatch [-j <threads>] [--cycles <max_cycles>] "
+                "[--stats <csv_file>] [--mem-latency <model>] [--mem-interval <cycles>] "
+                "[--list <list_file> ...] [<bin_file> ...]"
+             << endl;
+        return 1;
+    }
+
+    unsigned threads = opts.threads ? opts.threads : thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (threads > opts.jobs.size())
+        threads = unsigned(opts.jobs.size());
+
+    batch::StealQueue queue(threads);
+    for (size_t i = 0; i < opts.jobs.size(); i++)
+        queue.push(i);
+
+    // 每个线程只写自己取到的结果，不需要额外的同步
+    vector<Result> results(opts.jobs.size());
+    auto begin = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (unsigned w = 0; w < threads; w++) {
+        workers.emplace_back([&, w] {
+            size_t job;
+            while (queue.pop(w, job))
+                run_job(opts.jobs[job], opts, results[job]);
+        });
+    }
+    for (thread& t : workers)
+        t.join();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+
+    // 按清单的顺序输出
+    size_t passed = 0;
+    double total = 0;
+    for (size_t i = 0; i < opts.jobs.size(); i++) {
+        const Result& r = results[i];
+        passed += r.pass;
+        total += r.seconds;
+        cout << (r.pass ? "PASS  " : "FAIL  ") << left << setw(28) << opts.jobs[i].name
+             << right << setw(12) << r.monitor.cycles() << " cycles " << fixed
+             << setprecision(3) << setw(8) << r.seconds << " s" << defaultfloat;
+        if (!r.pass)
+            cout << "  " << r.message;
+        cout << endl;
+    }
+    cout << "Passed: " << passed << "/" << opts.jobs.size() << endl;
+    cout << "Host time: " << fixed << setprecision(3) << elapsed.count() << " s with "
+         << threads << " threads (" << total << " s of simulation)" << defaultfloat
+         << endl;
+
+    if (!opts.stats_file.empty()) {
+        ofstream stats(opts.stats_file);
+        if (!stats) {
+            cerr << "Cannot open stats file: " << opts.stats_file << endl;
+            return 1;
+        }
+        stats << monitor::Monitor::CSV_HEADER << endl;
+        for (size_t i = 0; i < opts.jobs.size(); i++)
+            results[i].monitor.report_csv(stats, opts.jobs[i].name, results[i].seconds);
+    }
+    return passed == opts.jobs.size() ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#ifndef __BATCH_HPP__
+#define __BATCH_HPP__
+
+#include "monitor.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace batch {
+
+/* 一个回归程序及其期望的结果 */
+struct Job {
+    string name;                                    // 清单中的程序名
+    string bin_file;                                // 程序映像
+    monitor::StopReason stop = monitor::StopReason::SELF_LOOP; // 期望的停止原因
+    vector<pair<int, uint64_t>> regs;               // 停止时期望的寄存器值
+    uint32_t halt_instr = 0;                        // 停机指令的编码
+    bool use_halt_instr = false;
+    uint64_t max_cycles = 0;                        // 最大仿真周期数，0表示使用默认值
+};
+
+/**
+ * @brief 解析停止原因的简写：self、unknown、halt、budget
+ *
+ * @return true 解析成功
+ */
+inline bool parse_stop(const string& text, monitor::StopReason& stop) {
+    if (text == "self")
+        stop = monitor::StopReason::SELF_LOOP;
+    else if (text == "unknown")
+        stop = monitor::StopReason::UNKNOWN_INSTR;
+    else if (text == "halt")
+        stop = monitor::StopReason::HALT_INSTR;
+    else if (text == "budget")
+        stop = monitor::StopReason::BUDGET;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief 解析一个完整的无符号数（支持0x前缀，负数按64位补码）
+ *
+ * @return true 解析成功
+ */
+inline bool parse_value(const string& text, uint64_t& value) {
+    char* end = nullptr;
+    value = strtoull(text.c_str(), &end, 0);
+    return !text.empty() && *end == '\0';
+}
+
+/**
+ * @brief 解析程序的一个期望：stop=<原因>、x<n>=<值>、halt=<指令编码>、cycles=<周期数>
+ *
+ * @return true 解析成功
+ */
+inline bool parse_expect(const string& item, Job& job) {
+    size_t eq = item.find('=');
+    if (eq == string::npos)
+        return false;
+    string key = item.substr(0, eq);
+    string text = item.substr(eq + 1);
+    uint64_t value;
+
+    if (key == "stop")
+        return parse_stop(text, job.stop);
+    if (!parse_value(text, value))
+        return false;
+    if (key == "halt") {
+        job.halt_instr = uint32_t(value);
+        job.use_halt_instr = true;
+        job.stop = monitor::StopReason::HALT_INSTR;
+        return true;
+    }
+    if (key == "cycles") {
+        job.max_cycles = value;
+        return true;
+    }
+    if (key.size() >= 2 && key[0] == 'x') {
+        uint64_t idx;
+        if (!parse_value(key.substr(1), idx) || idx >= 32)
+            return false;
+        job.regs.push_back({int(idx), value});
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 读取回归清单，每行为一个程序和若干期望，'#'之后为注释：
+ *
+ *      <程序> [stop=self|unknown|halt|budget] [x<n>=<值> ...] [halt=<指令编码>] [cycles=<周期数>]
+ *
+ * 程序的路径相对于清单所在的目录；以.asm结尾时使用汇编器输出的<程序>.bin
+ * （与make FILE=...的约定相同）。没有给出stop时期望程序以原地循环结束。
+ *
+ * @param path 清单文件
+ * @param jobs 追加解析得到的程序
+ * @return true 解析成功
+ */
+inline bool read_list(const string& path, vector<Job>& jobs) {
+    ifstream in(path);
+    if (!in) {
+        cerr << "Error opening list: " << path << endl;
+        return false;
+    }
+    size_t slash = path.find_last_of('/');
+    string dir = slash == string::npos ? "" : path.substr(0, slash + 1);
+
+    string line;
+    for (int line_no = 1; getline(in, line); line_no++) {
+        line = line.substr(0, line.find('#'));
+        istringstream items(line);
+        Job job;
+        if (!(items >> job.name))
+            continue;
+        job.bin_file = dir + job.name;
+        if (job.name.size() > 4 && job.name.compare(job.name.size() - 4, 4, ".asm") == 0)
+            job.bin_file += ".bin";
+
+        string item;
+        while (items >> item) {
+            if (!parse_expect(item, job)) {
+                cerr << path << ":" << line_no << ": invalid expectation: " << item
+                     << endl;
+                return false;
+            }
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+/**
+ * @brief 工作窃取队列：每个工作线程有自己的双端队列
+ *
+ * 线程先从自己队列的头部取任务，取空后从其他线程队列的尾部窃取，
+ * 运行时间差别很大的程序因此不会集中拖慢某一个线程。
+ */
+class StealQueue {
+  public:
+    explicit StealQueue(size_t workers) : queues_(workers) {}
+
+    /**
+     * @brief 加入任务，按轮转分配给各个工作线程
+     */
+    void push(size_t job) {
+        Queue& q = queues_[next_++ % queues_.size()];
+        lock_guard<mutex> guard(q.lock);
+        q.jobs.push_back(job);
+    }
+
+    /**
+     * @brief 为worker取一个任务
+     *
+     * @return false 所有队列都已经取空
+     */
+    bool pop(size_t worker, size_t& job) {
+        {
+            Queue& own = queues_[worker];
+            lock_guard<mutex> guard(own.lock);
+            if (!own.jobs.empty()) {
+                job = own.jobs.front();
+                own.jobs.pop_front();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues_.size(); i++) {
+            Queue& victim = queues_[(worker + i) % queues_.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.jobs.empty()) {
+                job = victim.jobs.back();
+                victim.jobs.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    struct Queue {
+        mutex lock;
+        deque<size_t> jobs;
+    };
+
+    vector<Queue> queues_;
+    size_t next_ = 0;
+};
+
+} // namespace batch
+
+#endif
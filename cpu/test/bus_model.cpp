@@ -0,0 +1,24 @@
+/*
+ * membus.v的DPI-C实现：每个membus实例在initial中申请一个LatencyModel，
+ * 并将其地址作为句柄保存，每次访存完成时通过句柄取下一次访存的延迟。
+ */
+#include "bus_model.hpp"
+
+extern "C" {
+
+long long bus_dpi_open() {
+    return static_cast<long long>(reinterpret_cast<uintptr_t>(new bus::LatencyModel));
+}
+
+void bus_dpi_close(long long handle) {
+    delete &bus::from_handle(handle);
+}
+
+int bus_dpi_latency(long long handle) {
+    return static_cast<int>(bus::from_handle(handle).next());
+}
+
+int bus_dpi_interval(long long handle) {
+    return static_cast<int>(bus::from_handle(handle).interval);
+}
+}
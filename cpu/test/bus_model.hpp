@@ -0,0 +1,186 @@
+#ifndef __BUS_MODEL_HPP__
+#define __BUS_MODEL_HPP__
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace bus {
+
+/**
+ * @brief 访存延迟模型，作为membus.v的DPI-C后端
+ *
+ * 每次访存完成时，membus.v向模型取下一次访存的延迟：cpu发出请求之后还要等待的周期数，
+ * 0表示请求所在的周期即可完成（与没有总线模型时的时序相同）。延迟的来源：
+ *
+ *      fixed:<n>                   每次访存都等待n个周期
+ *      random:<min>:<max>[:<seed>] 在[min, max]中均匀分布，seed默认为1
+ *      trace:<file>                按顺序取文件中的数（空白分隔，'#'之后为注释），用完后从头开始
+ *
+ * 下一次访存的延迟在上一次访存完成时就已确定，因此延迟不依赖于访存的地址和类型。
+ * interval是相邻两次访存完成之间至少间隔的周期数，用来限制带宽（每interval个周期8个字节），
+ * 0和1表示不限制。
+ */
+class LatencyModel {
+  public:
+    /**
+     * @brief 按描述设置延迟的来源
+     *
+     * @param spec 延迟模型的描述，格式见类的说明
+     * @param error 失败时返回错误信息
+     * @return true 设置成功
+     */
+    bool configure(const string& spec, string& error) {
+        vector<string> fields;
+        istringstream in(spec);
+        for (string field; getline(in, field, ':');)
+            fields.push_back(field);
+        if (fields.empty()) {
+            error = "empty latency model";
+            return false;
+        }
+
+        const string& kind = fields[0];
+        if (kind == "fixed" && fields.size() == 2) {
+            uint64_t n;
+            if (!parse(fields[1], n))
+                return invalid(spec, error);
+            kind_ = Kind::FIXED;
+            fixed_ = uint32_t(n);
+        } else if (kind == "random" && (fields.size() == 3 || fields.size() == 4)) {
+            uint64_t lo, hi, seed = 1;
+            if (!parse(fields[1], lo) || !parse(fields[2], hi) || lo > hi ||
+                (fields.size() == 4 && !parse(fields[3], seed)))
+                return invalid(spec, error);
+            kind_ = Kind::RANDOM;
+            dist_ = uniform_int_distribution<uint32_t>(uint32_t(lo), uint32_t(hi));
+            rng_.seed(seed);
+        } else if (kind == "trace" && fields.size() >= 2) {
+            // 文件名中可能含有':'
+            string path = spec.substr(kind.size() + 1);
+            if (!load_trace(path, error))
+                return false;
+            kind_ = Kind::TRACE;
+        } else {
+            return invalid(spec, error);
+        }
+        spec_ = spec;
+        return true;
+    }
+
+    /**
+     * @brief 下一次访存的延迟
+     */
+    uint32_t next() {
+        switch (kind_) {
+        case Kind::RANDOM:
+            return dist_(rng_);
+        case Kind::TRACE: {
+            uint32_t latency = trace_[pos_];
+            pos_ = (pos_ + 1) % trace_.size();
+            return latency;
+        }
+        default:
+            return fixed_;
+        }
+    }
+
+    /* 延迟模型的描述，用于输出统计结果 */
+    const string& spec() const { return spec_; }
+
+    /**
+     * @brief 延迟序列当前的位置（随机数发生器的状态和trace中的下标），供检查点保存
+     */
+    string position() const {
+        ostringstream out;
+        out << rng_ << ' ' << pos_;
+        return out.str();
+    }
+
+    /**
+     * @brief 恢复position()保存的位置，之后取得的延迟与保存时的模型相同
+     *
+     * @return false 位置的格式错误，或超出了trace的长度
+     */
+    bool set_position(const string& text) {
+        istringstream in(text);
+        mt19937_64 rng;
+        size_t pos;
+        if (!(in >> rng >> pos) || (kind_ == Kind::TRACE && pos >= trace_.size()))
+            return false;
+        rng_ = rng;
+        pos_ = pos;
+        return true;
+    }
+
+    /* 相邻两次访存完成之间至少间隔的周期数 */
+    uint32_t interval = 0;
+
+  private:
+    enum class Kind { FIXED, RANDOM, TRACE };
+
+    static bool parse(const string& text, uint64_t& value) {
+        char* end = nullptr;
+        value = strtoull(text.c_str(), &end, 0);
+        return !text.empty() && *end == '\0' && value <= UINT32_MAX;
+    }
+
+    static bool invalid(const string& spec, string& error) {
+        error = "invalid latency model: " + spec +
+                " (fixed:<n>, random:<min>:<max>[:<seed>] or trace:<file>)";
+        return false;
+    }
+
+    bool load_trace(const string& path, string& error) {
+        ifstream in(path);
+        if (!in) {
+            error = "cannot open latency trace: " + path;
+            return false;
+        }
+        vector<uint32_t> trace;
+        string line;
+        while (getline(in, line)) {
+            istringstream words(line.substr(0, line.find('#')));
+            for (string word; words >> word;) {
+                uint64_t value;
+                if (!parse(word, value)) {
+                    error = "invalid latency in " + path + ": " + word;
+                    return false;
+                }
+                trace.push_back(uint32_t(value));
+            }
+        }
+        if (trace.empty()) {
+            error = "latency trace is empty: " + path;
+            return false;
+        }
+        trace_ = move(trace);
+        pos_ = 0;
+        return true;
+    }
+
+    Kind kind_ = Kind::FIXED;
+    string spec_ = "fixed:0";
+    uint32_t fixed_ = 0;
+    mt19937_64 rng_;
+    uniform_int_distribution<uint32_t> dist_;
+    vector<uint32_t> trace_;
+    size_t pos_ = 0;
+};
+
+/**
+ * @brief 根据membus.v中保存的句柄取得对应的LatencyModel
+ */
+inline LatencyModel& from_handle(uint64_t handle) {
+    return *reinterpret_cast<LatencyModel*>(handle);
+}
+
+} // namespace bus
+
+#endif
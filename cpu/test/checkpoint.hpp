@@ -0,0 +1,180 @@
+#ifndef __CHECKPOINT_HPP__
+#define __CHECKPOINT_HPP__
+
+#include "Vhardware.h"
+#include "hardware.hpp"
+#include "monitor.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+/*
+ * 检查点需要Verilator的--savable选项生成模型的序列化代码（见Makefile），
+ * 此时编译选项中定义HARDWARE_SAVABLE=1；否则检查点相关的代码都不参与编译。
+ */
+#ifndef HARDWARE_SAVABLE
+#define HARDWARE_SAVABLE 0
+#endif
+
+#if HARDWARE_SAVABLE
+#include <verilated_save.h>
+#endif
+
+using namespace std;
+
+/*
+ * 检查点文件的内容（整数为主机字节序，只能由同一个仿真程序恢复）：
+ *
+ *      魔数 "RVCK"、版本号(4)
+ *      仿真的时间步数(8)、Monitor的统计状态
+ *      RAM中内容不全为0的页数n(8)，之后n个页：页的起始地址(8) 页的内容(4096)
+ *      访存延迟模型：描述的长度(8)和描述、interval(4)、位置的长度(8)和位置
+ *      Verilator模型的全部状态
+ *
+ * ram.v的存储阵列在DPI-C一侧的SparseRam中，不属于模型的状态，因此按页单独保存；
+ * 全为0的页与未分配的页读出的结果相同，不需要保存，检查点的大小只与程序实际写过的内存有关。
+ * membus.v的延迟模型同样在DPI-C一侧，保存随机数发生器的状态和trace中的下标，
+ * 恢复之后的访存延迟与不中断的仿真相同。
+ */
+namespace checkpoint {
+
+constexpr char MAGIC[4] = {'R', 'V', 'C', 'K'};
+constexpr uint32_t VERSION = 2;
+
+/* 仿真程序中除模型和RAM以外需要保存的状态 */
+struct State {
+    uint64_t step;                 // 已经仿真的时间步数（下一步从step+1开始）
+    monitor::Monitor::State stats; // 周期数、退休指令数等
+};
+
+/* 当前编译的仿真程序是否支持检查点 */
+constexpr bool supported() { return HARDWARE_SAVABLE; }
+
+#if HARDWARE_SAVABLE
+/* 页的内容是否全为0 */
+inline bool zero_page(const uint8_t* data) {
+    static const uint8_t zero[ram::SparseRam::PAGE_SIZE] = {};
+    return memcmp(data, zero, ram::SparseRam::PAGE_SIZE) == 0;
+}
+
+/* 写入一个字符串：长度(8)和内容 */
+inline void write_string(VerilatedSave& os, const string& text) {
+    uint64_t size = text.size();
+    os.write(&size, sizeof(size));
+    os.write(text.data(), size);
+}
+
+/* 读取write_string()写入的字符串 */
+inline string read_string(VerilatedRestore& is) {
+    uint64_t size;
+    is.read(&size, sizeof(size));
+    string text(size, '\0');
+    is.read(&text[0], size);
+    return text;
+}
+
+/**
+ * @brief 在时钟上升沿求值之后保存检查点
+ *
+ * @param hardware 需要保存的硬件
+ * @param path 检查点文件
+ * @param state 仿真程序的状态
+ */
+inline void save(Vhardware* hardware, const string& path, const State& state) {
+    const ram::SparseRam& mem = hardware::memory(hardware);
+    uint64_t pages = 0;
+    mem.for_each_page([&](uint64_t, const uint8_t* data) { pages += !zero_page(data); });
+
+    VerilatedSave os;
+    os.open(path.c_str());
+    os.write(MAGIC, sizeof(MAGIC));
+    os.write(&VERSION, sizeof(VERSION));
+    os.write(&state, sizeof(state));
+    os.write(&pages, sizeof(pages));
+    mem.for_each_page([&](uint64_t addr, const uint8_t* data) {
+        if (zero_page(data))
+            return;
+        os.write(&addr, sizeof(addr));
+        os.write(data, ram::SparseRam::PAGE_SIZE);
+    });
+    const bus::LatencyModel& bus = hardware::bus_model(hardware);
+    write_string(os, bus.spec());
+    os.write(&bus.interval, sizeof(bus.interval));
+    write_string(os, bus.position());
+    os << *hardware;
+    os.close();
+}
+
+/**
+ * @brief 从检查点恢复模型、RAM和仿真程序的状态
+ *
+ * 应在新建模型之后、仿真开始之前调用。模型中ram.v的句柄指向保存时的进程中的存储，
+ * 因此恢复模型之后换回本进程中新申请的存储，再把保存的页写入其中。
+ * membus.v的延迟模型同样换回本进程中的模型，它必须与保存时的模型相同（命令行参数
+ * --mem-latency和--mem-interval与保存时一致），之后从保存时的位置继续取延迟；
+ * 正在等待的访存保持保存时的剩余周期数。
+ *
+ * @param hardware 需要恢复的硬件
+ * @param path 检查点文件
+ * @param state 返回仿真程序的状态
+ * @return true 恢复成功
+ * @return false 不是检查点文件、版本不符，或访存延迟模型与保存时不同
+ */
+inline bool restore(Vhardware* hardware, const string& path, State& state) {
+    ram::SparseRam& mem = hardware::memory(hardware);
+    auto handle = hardware->rootp->hardware__DOT__ram_inst__DOT__handle;
+    auto bus_handle = hardware->rootp->hardware__DOT__membus_inst__DOT__handle;
+
+    VerilatedRestore is;
+    is.open(path.c_str());
+    if (!is.isOpen()) {
+        cerr << "Error opening checkpoint: " << path << endl;
+        return false;
+    }
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    is.read(magic, sizeof(magic));
+    is.read(&version, sizeof(version));
+    if (memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) {
+        cerr << "Error: " << path << " is not a checkpoint of this simulator" << endl;
+        return false;
+    }
+    is.read(&state, sizeof(state));
+
+    uint64_t pages;
+    is.read(&pages, sizeof(pages));
+    uint8_t data[ram::SparseRam::PAGE_SIZE];
+    for (uint64_t i = 0; i < pages; i++) {
+        uint64_t addr;
+        is.read(&addr, sizeof(addr));
+        is.read(data, sizeof(data));
+        mem.write(addr, data, sizeof(data));
+    }
+
+    bus::LatencyModel& bus = bus::from_handle(bus_handle);
+    string spec = read_string(is);
+    uint32_t interval;
+    is.read(&interval, sizeof(interval));
+    string position = read_string(is);
+    if (spec != bus.spec() || interval != bus.interval) {
+        cerr << "Error: " << path << " was saved with --mem-latency " << spec
+             << " --mem-interval " << interval << endl;
+        return false;
+    }
+    if (!bus.set_position(position)) {
+        cerr << "Error: invalid latency model state in " << path << endl;
+        return false;
+    }
+    is >> *hardware;
+    is.close();
+
+    hardware->rootp->hardware__DOT__ram_inst__DOT__handle = handle;
+    hardware->rootp->hardware__DOT__membus_inst__DOT__handle = bus_handle;
+    return true;
+}
+#endif
+
+} // namespace checkpoint
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef __COSIM_HPP__
+#define __COSIM_HPP__
+
+#include "../../iss/src/iss.hpp"
+#include "Vhardware.h"
+#include "hardware.hpp"
+#include "loader.hpp"
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace cosim {
+
+/**
+ * @brief 以指令集模拟器为参考模型，与cpu逐条指令锁步比对
+ *
+ * cpu每退休一条指令，参考模型也执行一条指令，然后比较：
+ *      指令地址与指令编码
+ *      写入x[rd]的值（csrr读取的计数器中只比较instret）
+ *      sb/sh/sw/sd写入内存的地址和数据（cpu的观测接口dbg_store_*，数据为写入的低位字节）
+ * cpu进入UNKNOWN_INSTR时，参考模型也必须停在同一条未知指令上。
+ * 出现第一处不一致即停止，并保留不一致的描述供report()输出。
+ *
+ * 参考模型也用于快速前进：先由model()单独执行程序的前一部分，再用transfer()
+ * 把状态交给cpu；锁步比对保证参考模型的状态始终与cpu最近退休的指令对齐，
+ * 因此任何时候都可以停止cpu，由model()继续执行程序的其余部分。
+ */
+class Cosim {
+  public:
+    /**
+     * @brief 将文件装载到参考模型的addr处，与loader::load_file对应
+     */
+    bool load_file(const string& path, uint64_t addr) {
+        loader::MappedFile file(path);
+        if (!file.valid()) {
+            cerr << "Error opening file: " << path << endl;
+            return false;
+        }
+        if (ref_.mem.write(addr, file.data(), file.size()) != file.size()) {
+            cerr << "Error: " << path << " does not fit in RAM at address 0x"
+                 << hex << addr << dec << endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 装载程序映像并从入口地址开始执行，与loader::load_program对应
+     */
+    bool load_program(const string& path) {
+        loader::MappedFile file(path);
+        if (!file.valid()) {
+            cerr << "Error opening file: " << path << endl;
+            return false;
+        }
+
+        uint64_t entry;
+        string error;
+        auto write = [&](uint64_t addr, const uint8_t* data, size_t size) {
+            return ref_.mem.write(addr, data, size);
+        };
+        if (!image::load(file.data(), file.size(), write, entry, error)) {
+            cerr << "Error loading " << path << ": " << error << endl;
+            return false;
+        }
+        ref_.pc = entry;
+        return true;
+    }
+
+    /**
+     * @brief 装载形如<file>@<addr>的数据文件，与loader::load_spec对应
+     */
+    bool load_spec(const string& spec) {
+        string path;
+        uint64_t addr;
+        return loader::parse_spec(spec, path, addr) && load_file(path, addr);
+    }
+
+    /**
+     * @brief 在每个时钟上升沿求值之后调用一次
+     *
+     * @return true cpu与参考模型一致
+     * @return false 出现了不一致，仿真应当停止
+     */
+    bool check(Vhardware* hardware) {
+        if (hardware->dbg_halt)
+            return check_halt(hardware);
+        if (!hardware->dbg_retire)
+            return true;
+
+        uint64_t pc = hardware->dbg_pc;
+        uint32_t instr = hardware->dbg_instr;
+        iss::Retire expect;
+        if (!ref_.step(expect)) {
+            fail(expect, "reference model stopped at an unknown instruction");
+            return false;
+        }
+        checked_++;
+
+        if (pc != expect.pc || instr != expect.instr) {
+            ostringstream msg;
+            msg << "retired pc=0x" << hex << pc << ", instr=0x" << instr;
+            fail(expect, msg.str());
+            return false;
+        }
+
+        // 除instret以外的性能计数器与cpu的时序有关，参考模型改用cpu读出的值
+        if (expect.op == iss::OP_CSR && expect.csr != iss::CSR_INSTRET &&
+            expect.rd != 0) {
+            expect.rd_value = hardware::reg(hardware, expect.rd);
+            ref_.x[expect.rd] = expect.rd_value;
+        }
+
+        if (expect.rd_write && expect.rd != 0) {
+            uint64_t actual = hardware::reg(hardware, expect.rd);
+            if (actual != expect.rd_value) {
+                ostringstream msg;
+                msg << "x" << dec << int(expect.rd) << ": expected 0x" << hex
+                    << expect.rd_value << ", got 0x" << actual;
+                fail(expect, msg.str());
+                return false;
+            }
+        }
+
+        // 写入内存的地址和数据取自观测接口：流水线中较新的sd可能已经
+        // 写入了同一地址，此时直接读取RAM得到的并不是这条指令写入的值
+        if (hardware->dbg_store != expect.store) {
+            fail(expect, expect.store ? "expected a store, got none"
+                                      : "unexpected store");
+            return false;
+        }
+        if (expect.store) {
+            uint64_t addr = hardware->dbg_store_addr & iss::Memory::MASK;
+            uint64_t data = hardware->dbg_store_data;
+            uint64_t expect_addr = expect.store_addr & iss::Memory::MASK;
+            if (addr != expect_addr || data != expect.store_data) {
+                ostringstream msg;
+                msg << "store: expected 0x" << hex << expect.store_data
+                    << " -> [0x" << expect_addr << "], got 0x" << data
+                    << " -> [0x" << addr << "]";
+                fail(expect, msg.str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 把参考模型的体系结构状态写入cpu，cpu从参考模型的pc继续执行
+     *
+     * 应在仿真开始之前调用。写入x1~x31、pc、参考模型写过的内存页，以及cycle和instret
+     * 计数器（参考模型按每条指令一个周期计算），使程序读到的计数器是连续的；
+     * 其余性能计数器从0开始，只统计cpu执行的部分。
+     */
+    void transfer(Vhardware* hardware) const {
+        for (int i = 1; i < 32; i++)
+            hardware::set_reg(hardware, i, ref_.x[i]);
+        hardware::set_pc(hardware, ref_.pc);
+        ref_.mem.for_each_dirty_page([&](uint64_t addr, const uint8_t* data) {
+            hardware::load_bytes(hardware, addr, data, iss::Memory::PAGE_SIZE);
+        });
+        hardware::set_perf(hardware, iss::CSR_CYCLE - 0xC00, ref_.instret());
+        hardware::set_perf(hardware, iss::CSR_INSTRET - 0xC00, ref_.instret());
+    }
+
+    /* 参考模型，用于在cpu之前或之后单独执行程序 */
+    iss::Iss& model() { return ref_; }
+
+    /* 是否出现了不一致 */
+    bool diverged() const { return diverged_; }
+    /* 已经比对过的指令数 */
+    uint64_t checked() const { return checked_; }
+
+    void report(ostream& out) const {
+        if (!diverged_) {
+            out << "Cosim: " << checked_ << " instructions matched" << endl;
+            return;
+        }
+        out << "Cosim: divergence at instruction " << checked_ << " (pc=0x"
+            << hex << where_.pc << ", instr=0x" << where_.instr << dec << ", "
+            << iss::op_name(where_.op) << ")" << endl;
+        out << "  " << message_ << endl;
+    }
+
+  private:
+    bool check_halt(Vhardware* hardware) {
+        if (halted_)
+            return true;
+        halted_ = true;
+
+        iss::Retire expect;
+        if (ref_.step(expect)) {
+            checked_++;
+            fail(expect, "cpu stopped at an unknown instruction");
+            return false;
+        }
+        if (hardware->dbg_pc != expect.pc) {
+            ostringstream msg;
+            msg << "cpu stopped at an unknown instruction at pc=0x" << hex
+                << hardware->dbg_pc;
+            fail(expect, msg.str());
+            return false;
+        }
+        return true;
+    }
+
+    void fail(const iss::Retire& where, const string& message) {
+        diverged_ = true;
+        where_ = where;
+        message_ = message;
+    }
+
+    iss::Iss ref_;
+    uint64_t checked_ = 0;
+    bool halted_ = false;
+
+    bool diverged_ = false;
+    iss::Retire where_;
+    string message_;
+};
+
+} // namespace cosim
+
+#endif
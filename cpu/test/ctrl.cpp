@@ -0,0 +1,225 @@
+#include "Vctrl.h"
+#include "verilated.h"
+#include <cstdint>
+#include <iostream>
+
+/*
+ * 多周期cpu每条指令的周期表：从进入FETCH状态到下一次进入FETCH状态的时钟周期数。
+ * 每条指令都由FETCH和一个执行状态组成，因此都是2个周期；
+ * mul/div的执行状态要等待alu_done，乘法为2+MUL_LATENCY个周期，除法为2+n个周期
+ * （n为被除数的有效2位数字个数，测试中取DIV_LATENCY）。
+ * 访问ram的状态等待mem_ready：ram每次读写都要等待MEM_LATENCY个周期时，
+ * 未命中取指缓冲的FETCH和LD/SD各多出MEM_LATENCY个周期（见BUS_TABLE）。
+ */
+const int OP_MUL = 3, OP_DIV = 4;
+const int MUL_LATENCY = 3; // 乘法器：start之后的第3个上升沿完成
+const int DIV_LATENCY = 5; // 除法器：start之后的第n个上升沿完成
+const int MEM_LATENCY = 2; // 访存总线：请求之后等待的周期数
+
+struct CycleEntry {
+    const char* name; // 指令
+    uint32_t instr;   // 指令编码
+    int cycles;       // 周期数
+};
+
+const CycleEntry CYCLE_TABLE[] = {
+    {"add", 0x002081B3, 2},  /* add x3 x1 x2 */
+    {"addi", 0x00108093, 2}, /* addi x1 x1 1 */
+    {"sub", 0x402081B3, 2},  /* sub x3 x1 x2 */
+    {"mul", 0x022081B3, 2 + MUL_LATENCY},  /* mul x3 x1 x2 */
+    {"div", 0x0220C1B3, 2 + DIV_LATENCY},  /* div x3 x1 x2 */
+    {"sll", 0x002091B3, 2},  /* sll x3 x1 x2 */
+    {"srl", 0x0020D1B3, 2},  /* srl x3 x1 x2 */
+    {"and", 0x0020F1B3, 2},  /* and x3 x1 x2 */
+    {"or", 0x0020E1B3, 2},   /* or x3 x1 x2 */
+    {"xor", 0x0020C1B3, 2},  /* xor x3 x1 x2 */
+    {"xori", 0xFFF0C093, 2}, /* xori x1 x1 -1 */
+    {"lui", 0x010000B7, 2},  /* lui x1 0x1000 */
+    {"ld", 0x0000B083, 2},   /* ld x1 x1 0 */
+    {"lb", 0x00008083, 2},   /* lb x1 x1 0 */
+    {"lbu", 0x0000C083, 2},  /* lbu x1 x1 0 */
+    {"lh", 0x00009083, 2},   /* lh x1 x1 0 */
+    {"lhu", 0x0000D083, 2},  /* lhu x1 x1 0 */
+    {"lw", 0x0000A083, 2},   /* lw x1 x1 0 */
+    {"lwu", 0x0000E083, 2},  /* lwu x1 x1 0 */
+    {"sd", 0x00403023, 2},   /* sd x4 x0 0 */
+    {"sb", 0x00400023, 2},   /* sb x4 x0 0 */
+    {"sh", 0x00401023, 2},   /* sh x4 x0 0 */
+    {"sw", 0x00402023, 2},   /* sw x4 x0 0 */
+    {"beq", 0xFE208CE3, 2},  /* beq x1 x2 -4 */
+    {"bge", 0xFE20DCE3, 2},  /* bge x1 x2 -4 */
+    {"jal", 0xFF9FF0EF, 2},  /* jal x1 -4 */
+    {"jalr", 0x038020E7, 2}, /* jalr x1 x0 0x38 */
+    {"csrr", 0xC00020F3, 2}, /* rdcycle x1 */
+};
+
+/* ram的读写需要等待时的周期表 */
+struct BusEntry {
+    const char* name; // 指令
+    uint32_t instr;   // 指令编码
+    bool fb_hit;      // 取指缓冲是否命中
+    int cycles;       // 周期数
+};
+
+const BusEntry BUS_TABLE[] = {
+    {"ld", 0x0000B083, false, 2 + 2 * MEM_LATENCY},  /* ld x1 x1 0 */
+    {"sb", 0x00400023, false, 2 + 2 * MEM_LATENCY},  /* sb x4 x0 0 */
+    {"add", 0x002081B3, false, 2 + MEM_LATENCY},     /* add x3 x1 x2 */
+    {"add (hit)", 0x002081B3, true, 2},              /* 命中时取指不等待 */
+    {"lw (hit)", 0x0000A083, true, 2 + MEM_LATENCY}, /* lw x1 x1 0 */
+};
+
+/**
+ * @brief 产生一个完整的时钟周期，返回上升沿之后的状态
+ *
+ * @param phase_ok 两个相位的使能信号均符合预期时保持为true
+ * @param alu_wait 模拟乘法器/除法器：还需要多少个上升沿才能完成
+ */
+void tick(Vctrl& dut, bool& phase_ok, int& alu_wait) {
+    // 时钟下降沿：IR和寄存器文件在此时写入，ram不在此时访问；
+    // 取指完成（命中或mem_ready有效）时才写入IR，ram未完成读取时不写入x[rd]
+    dut.clk = 0;
+    dut.eval();
+    if (dut.ram_cs)
+        phase_ok = false;
+    if (dut.fetch && bool(dut.ir_en) != (dut.fb_hit || dut.mem_ready))
+        phase_ok = false;
+    if (dut.ram_oe && !dut.mem_ready && dut.reg_en)
+        phase_ok = false;
+
+    // 时钟上升沿：进入新的状态，alu在同一个上升沿开始或继续乘除法
+    bool alu_start = dut.alu_start;
+    int alu_op = dut.alu_op;
+    dut.clk = 1;
+    dut.eval();
+    if (alu_start)
+        alu_wait = (alu_op == OP_MUL) ? MUL_LATENCY : DIV_LATENCY;
+    else if (alu_wait > 0)
+        alu_wait--;
+    dut.alu_done = alu_wait == 0;
+    dut.eval();
+    if (dut.ir_en || dut.reg_en)
+        phase_ok = false;
+    // 取指缓冲命中时不访问ram，取指完成时才更新pc
+    bool ram_read = dut.ram_cs && dut.ram_oe;
+    if (dut.fetch && (bool(dut.pc_en) != (dut.fb_hit || dut.mem_ready) ||
+                      ram_read == bool(dut.fb_hit)))
+        phase_ok = false;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    Vctrl dut;
+    int pass_count = 0, total = 0;
+    bool phase_ok = true;
+    int alu_wait = 0;
+
+    // PREPARE -> FETCH
+    dut.instr = 0;
+    dut.fb_hit = 0;
+    dut.alu_done = 1;
+    dut.mem_ready = 1;
+    dut.clk = 1;
+    dut.eval();
+    tick(dut, phase_ok, alu_wait);
+    if (!dut.fetch) {
+        std::cout << "FAIL: controller did not enter FETCH after PREPARE"
+                  << std::endl;
+        return 1;
+    }
+
+    for (const auto& entry : CYCLE_TABLE) {
+        total++;
+        // IR在FETCH状态的时钟下降沿装入指令
+        dut.instr = entry.instr;
+
+        int cycles = 0;
+        do {
+            tick(dut, phase_ok, alu_wait);
+            cycles++;
+        } while (!dut.fetch && !dut.halt && cycles < 16);
+
+        if (dut.fetch && cycles == entry.cycles) {
+            pass_count++;
+        } else {
+            std::cout << "FAIL: " << entry.name << " took " << cycles
+                      << " cycles, expected " << entry.cycles << std::endl;
+        }
+    }
+
+    // 取指缓冲命中：FETCH不访问ram，周期数不变
+    total++;
+    dut.fb_hit = 1;
+    dut.instr = CYCLE_TABLE[0].instr;
+    bool ram_accessed = false;
+    int cycles = 0;
+    do {
+        tick(dut, phase_ok, alu_wait);
+        ram_accessed = ram_accessed || dut.ram_cs || dut.ram_oe;
+        cycles++;
+    } while (!dut.fetch && cycles < 16);
+    dut.fb_hit = 0;
+    if (dut.fetch && cycles == CYCLE_TABLE[0].cycles && !ram_accessed) {
+        pass_count++;
+    } else {
+        std::cout << "FAIL: fetch buffer hit took " << cycles
+                  << " cycles, ram accessed=" << ram_accessed << std::endl;
+    }
+
+    // ram的读写需要等待：请求之后的第MEM_LATENCY个周期mem_ready才有效
+    for (const auto& entry : BUS_TABLE) {
+        total++;
+        dut.instr = entry.instr;
+        dut.fb_hit = entry.fb_hit;
+        int waited = 0; // 当前的请求已经等待的周期数
+        dut.mem_ready = MEM_LATENCY == 0;
+        dut.eval();
+
+        cycles = 0;
+        bool left = false; // 已经离开了FETCH状态
+        do {
+            bool request = dut.ram_oe || dut.ram_we;
+            bool done = request && dut.mem_ready;
+            tick(dut, phase_ok, alu_wait);
+            waited = (request && !done) ? waited + 1 : 0;
+            // 新的请求（或仍在等待的请求）在等待了MEM_LATENCY个周期之后完成
+            dut.mem_ready = waited >= MEM_LATENCY;
+            dut.eval();
+            left = left || !dut.fetch;
+            cycles++;
+        } while (!(left && dut.fetch) && cycles < 32);
+
+        if (dut.fetch && cycles == entry.cycles) {
+            pass_count++;
+        } else {
+            std::cout << "FAIL: " << entry.name << " with memory latency " << MEM_LATENCY
+                      << " took " << cycles << " cycles, expected " << entry.cycles
+                      << std::endl;
+        }
+    }
+    dut.fb_hit = 0;
+    dut.mem_ready = 1;
+
+    // 未知指令：进入UNKNOWN_INSTR状态并停留在该状态
+    total++;
+    dut.instr = 0;
+    for (int i = 0; i < 4; i++)
+        tick(dut, phase_ok, alu_wait);
+    if (dut.halt && !dut.fetch) {
+        pass_count++;
+    } else {
+        std::cout << "FAIL: unknown instruction did not halt" << std::endl;
+    }
+
+    // 各状态中的使能信号只在规定的时钟相位有效
+    total++;
+    if (phase_ok) {
+        pass_count++;
+    } else {
+        std::cout << "FAIL: enable asserted in the wrong clock phase"
+                  << std::endl;
+    }
+
+    std::cout << "CTRL Test: " << pass_count << "/" << total << " pass_count\n";
+    return pass_count == total ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include "Vfetchbuf.h"
+#include "verilated.h"
+#include <cstdint>
+#include <iostream>
+
+// ram中地址a处的2个字节取为a的低16位按位取反
+uint16_t ram_half(uint64_t addr) { return uint16_t(~addr); }
+
+// ram在地址addr处读出的8个字节（大端序）
+uint64_t ram_word(uint64_t addr) {
+    uint64_t word = 0;
+    for (int i = 0; i < 8; i += 2)
+        word = (word << 16) | ram_half(addr + i);
+    return word;
+}
+
+struct TestCase {
+    bool en;          // 取指
+    bool inv;         // 作废缓冲
+    uint64_t addr;    // 取指地址
+    bool hit;         // 预期是否命中
+    uint64_t hits;    // 上升沿之后预期的命中次数
+    uint64_t misses;  // 上升沿之后预期的未命中次数
+};
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    Vfetchbuf dut;
+    int pass_count = 0, total = 0;
+
+    // 测试用例集
+    const TestCase tests[] = {// 初始为空
+                              {1, 0, 0x00, 0, 0, 1},
+                              // 顺序取指：下一条指令在低32位
+                              {1, 0, 0x04, 1, 1, 1},
+                              {1, 0, 0x08, 0, 1, 2},
+                              {1, 0, 0x0C, 1, 2, 2},
+                              // 不取指时不计数
+                              {0, 0, 0x10, 0, 2, 2},
+                              // 跳回缓冲的起始地址：高32位
+                              {1, 0, 0x08, 1, 3, 2},
+                              // 作废之后同一地址不再命中
+                              {0, 1, 0x0C, 1, 3, 2},
+                              // 缓冲不要求8字节对齐：0x0C处装入的8个字节包含0x10处的指令
+                              {1, 0, 0x0C, 0, 3, 3},
+                              {1, 0, 0x10, 1, 4, 3},
+                              {1, 0, 0x14, 0, 4, 4},
+                              {1, 0, 0x18, 1, 5, 4},
+                              // 作废优先于取指
+                              {1, 1, 0x18, 1, 5, 4},
+                              {1, 0, 0x18, 0, 5, 5},
+                              // 压缩指令：缓冲之后2、4、6字节处都命中
+                              {1, 0, 0x1A, 1, 6, 5},
+                              {1, 0, 0x1C, 1, 7, 5},
+                              {1, 0, 0x1E, 1, 8, 5},
+                              // 从一组压缩指令的第二条装入缓冲：之后6字节处的地址第1位为0，
+                              // 缓冲中只有它的前2个字节，无法判断是否是压缩指令
+                              {1, 1, 0x22, 0, 8, 5},
+                              {1, 0, 0x22, 0, 8, 6},
+                              {1, 0, 0x28, 0, 8, 7},
+                              // 奇数地址和8字节之外的地址不命中
+                              {0, 0, 0x29, 0, 8, 7},
+                              {0, 0, 0x30, 0, 8, 7}};
+
+    for (const auto& t : tests) {
+        total++;
+        dut.en = t.en;
+        dut.inv = t.inv;
+        dut.addr = t.addr;
+        dut.ram_data = ram_word(t.addr);
+
+        dut.clk = 0;
+        dut.eval();
+        bool hit = dut.hit;
+        // 命中时输出从addr开始的4个字节；地址第1位为1时一定是压缩指令，只检查高16位
+        uint32_t expected = uint32_t(ram_word(t.addr) >> 32);
+        uint32_t mask = (t.addr & 0x2) ? 0xFFFF0000 : 0xFFFFFFFF;
+        bool instr_ok = !hit || (dut.instr & mask) == (expected & mask);
+
+        // 时钟上升沿
+        dut.clk = 1;
+        dut.eval();
+
+        if (hit == t.hit && instr_ok && dut.hit_count == t.hits &&
+            dut.miss_count == t.misses) {
+            pass_count++;
+        } else {
+            std::cout << "FAIL: addr=0x" << std::hex << t.addr << std::dec
+                      << " en=" << t.en << " inv=" << t.inv << " hit=" << hit
+                      << " instr_ok=" << instr_ok << " hits=" << dut.hit_count
+                      << " misses=" << dut.miss_count << std::endl;
+        }
+    }
+
+    std::cout << "FETCHBUF Test: " << pass_count << "/" << total
+              << " pass_count\n";
+    return pass_count == total ? 0 : 1;
+}
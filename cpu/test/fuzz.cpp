@@ -0,0 +1,296 @@
+#include "Valu.h"
+#include "Vregfile.h"
+#include "alu.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <verilated.h>
+
+/*
+ * ALU和寄存器文件的随机差分测试：Valu和Vregfile链接在同一个程序中（见Makefile的fuzz），
+ * 以随机和边界操作数驱动，与C++参考模型逐个向量比较。
+ *
+ * 向量按CHUNK个一组，每组的随机数种子只由总种子和组号决定，与线程数和执行顺序无关：
+ * 失败时输出组号，用 --seed <种子> --chunk <组号> 可以单独复现这一组。
+ * 每组在新建的VerilatedContext、Valu和Vregfile上运行，不继承上一组留下的流水线和寄存器状态，
+ * 因此单独复现的一组与完整运行中的这一组完全相同；模型只在运行该组的线程中求值。
+ */
+
+using namespace alu;
+
+/* 每组的向量数（ALU和寄存器文件各CHUNK个） */
+constexpr uint64_t CHUNK = 1 << 16;
+/* 最多输出的失败向量数 */
+constexpr uint64_t MAX_REPORTS = 20;
+
+/* 命令行参数 */
+struct Options {
+    uint64_t vectors = 10000000; // ALU和寄存器文件各自的向量数
+    uint64_t seed = 1;
+    unsigned threads = 0; // 0表示主机的核数
+    bool one_chunk = false; // 只运行第chunk组（复现失败）
+    uint64_t chunk = 0;
+};
+
+/* 所有线程共享的结果 */
+struct Shared {
+    atomic<uint64_t> next_chunk{0};
+    atomic<uint64_t> alu_vectors{0}, regfile_vectors{0};
+    atomic<uint64_t> failures{0};
+    mutex out_lock; // 输出失败向量
+};
+
+/**
+ * @brief 第chunk组的随机数种子（splitmix64），相邻的组号得到不相关的种子
+ */
+uint64_t chunk_seed(uint64_t seed, uint64_t chunk) {
+    uint64_t z = seed + (chunk + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief 操作数：alu::random_operand的分布之外，加入符号位附近的边界值、
+ *        不小于64的移位量（只取低6位）以及0
+ */
+uint64_t fuzz_operand(mt19937_64& rng) {
+    static const uint64_t edges[] = {
+        0,           1,           2,           3,
+        0x7FFFFFFFFFFFFFFF,       0x8000000000000000,
+        0x8000000000000001,       ~0ULL,     ~0ULL - 1,
+        0x7FFFFFFF,  0x80000000,  0xFFFFFFFF, 0x100000000,
+        0x7FF,       0x800,       0xFFF,      0xFFFFF,
+        63,          64,          65,         127,
+        128,         0xFFFFFFFFFFFFFFC0, 0xFFFFFFFFFFFFFF3F};
+    switch (rng() % 8) {
+    case 0:
+    case 1:
+        return edges[rng() % (sizeof(edges) / sizeof(edges[0]))];
+    case 2:
+        return 64 + rng() % 192; // 不小于64的移位量
+    case 3:
+        return (rng() << 6) | (rng() % 64); // 高位任意，低6位为移位量
+    default:
+        return random_operand(rng);
+    }
+}
+
+/* 运行一组向量的模型 */
+struct Models {
+    VerilatedContext context;
+    unique_ptr<Valu> alu{new Valu(&context, "alu")};
+    unique_ptr<Vregfile> regfile{new Vregfile(&context, "regfile")};
+
+    ~Models() {
+        alu->final();
+        regfile->final();
+    }
+};
+
+/**
+ * @brief 报告一个失败的向量
+ */
+void report(Shared& shared, const Options& opts, uint64_t chunk, uint64_t idx,
+            const string& what) {
+    uint64_t n = shared.failures++;
+    if (n >= MAX_REPORTS && !opts.one_chunk)
+        return;
+    lock_guard<mutex> guard(shared.out_lock);
+    cerr << "FAIL chunk " << chunk << " vector " << idx << ": " << what
+         << " (reproduce: Vfuzz --seed " << opts.seed << " --chunk " << chunk << ")"
+         << endl;
+}
+
+/**
+ * @brief 在ALU上运行一组向量
+ */
+void fuzz_alu(Models& m, mt19937_64& rng, uint64_t count, Shared& shared,
+              const Options& opts, uint64_t chunk) {
+    Valu* top = m.alu.get();
+    for (uint64_t i = 0; i < count; i++) {
+        uint8_t op = uint8_t(rng() % (ALU_OP_LUI + 1));
+        uint64_t a = fuzz_operand(rng);
+        uint64_t b = fuzz_operand(rng);
+        if (op == ALU_OP_DIV && rng() % 8 == 0)
+            b = 0; // 除数为0
+
+        int latency;
+        uint64_t hw = alu_verilog(top, op, a, b, latency);
+        uint64_t sw = alu_cpp(op, a, b);
+        int sw_latency = (op == ALU_OP_MUL || op == ALU_OP_DIV) ? latency_cpp(op, a, b) : 0;
+        if (hw != sw || latency != sw_latency) {
+            ostringstream what;
+            what << "alu op=" << int(op) << " a=0x" << hex << a << " b=0x" << b
+                 << " HW=0x" << hw << " SW=0x" << sw << dec << " latency=" << latency
+                 << " expected=" << sw_latency;
+            report(shared, opts, chunk, i, what.str());
+        }
+    }
+}
+
+/**
+ * @brief 在寄存器文件上运行一组随机的读写
+ *
+ * 每组先写入全部寄存器，参考状态只由本组的随机数决定。每个向量在en的上升沿之前
+ * 检查读出的是写入之前的值，之后检查读出的是写入之后的值（x0恒为0，we为0时不写入）。
+ */
+void fuzz_regfile(Models& m, mt19937_64& rng, uint64_t count, Shared& shared,
+                  const Options& opts, uint64_t chunk) {
+    Vregfile* top = m.regfile.get();
+    uint64_t ref[32] = {};
+
+    auto write = [&](uint32_t rd, bool we, uint64_t data) {
+        top->rd = rd;
+        top->we = we;
+        top->write_data = data;
+        top->en = 0;
+        top->eval();
+        top->en = 1;
+        top->eval();
+        if (we && rd != 0)
+            ref[rd] = data;
+    };
+    for (uint32_t r = 1; r < 32; r++)
+        write(r, true, fuzz_operand(rng));
+
+    for (uint64_t i = 0; i < count; i++) {
+        // x0和we=0的写入各占约1/8
+        uint32_t rd = rng() % 8 == 0 ? 0 : uint32_t(rng() % 32);
+        bool we = rng() % 8 != 0;
+        uint64_t data = fuzz_operand(rng);
+        uint32_t rs1 = uint32_t(rng() % 32);
+        uint32_t rs2 = rng() % 4 == 0 ? rd : uint32_t(rng() % 32); // 常读刚写入的寄存器
+
+        top->rs1 = rs1;
+        top->rs2 = rs2;
+        top->rd = rd;
+        top->we = we;
+        top->write_data = data;
+        top->en = 0;
+        top->eval();
+        bool before = top->data1 == ref[rs1] && top->data2 == ref[rs2];
+        uint64_t before1 = top->data1, before2 = top->data2;
+
+        top->en = 1;
+        top->eval();
+        uint64_t old1 = ref[rs1], old2 = ref[rs2];
+        if (we && rd != 0)
+            ref[rd] = data;
+        bool after = top->data1 == ref[rs1] && top->data2 == ref[rs2];
+
+        if (!before || !after) {
+            ostringstream what;
+            what << "regfile rd=x" << rd << " we=" << we << " data=0x" << hex << data
+                 << dec << " rs1=x" << rs1 << " rs2=x" << rs2 << hex;
+            if (!before)
+                what << " before: HW=0x" << before1 << "/0x" << before2 << " SW=0x" << old1
+                     << "/0x" << old2;
+            if (!after)
+                what << " after: HW=0x" << top->data1 << "/0x" << top->data2 << " SW=0x"
+                     << ref[rs1] << "/0x" << ref[rs2];
+            report(shared, opts, chunk, i, what.str());
+            // 之后的比较以硬件的状态为准，避免一处错误引起一连串的失败
+            for (uint32_t r = 1; r < 32; r++) {
+                top->rs1 = r;
+                top->eval();
+                ref[r] = top->data1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 在新建的模型上运行一组向量：ALU和寄存器文件各count个
+ */
+void run_chunk(uint64_t chunk, uint64_t count, Shared& shared, const Options& opts) {
+    Models m;
+    mt19937_64 rng(chunk_seed(opts.seed, chunk));
+    fuzz_alu(m, rng, count, shared, opts, chunk);
+    shared.alu_vectors += count;
+    fuzz_regfile(m, rng, count, shared, opts, chunk);
+    shared.regfile_vectors += count;
+}
+
+/**
+ * @brief 解析命令行参数
+ *
+ * @return true 解析成功
+ */
+bool parse_options(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            opts.vectors = strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opts.seed = strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "-j" && i + 1 < argc) {
+            opts.threads = unsigned(strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--chunk" && i + 1 < argc) {
+            opts.chunk = strtoull(argv[++i], nullptr, 0);
+            opts.one_chunk = true;
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parse_options(argc, argv, opts)) {
+        cerr << "Usage: Vfuzz [-n <vectors>] [--seed <seed>] [-j <threads>] "
+                "[--chunk <chunk>]"
+             << endl;
+        return 1;
+    }
+
+    uint64_t chunks = (opts.vectors + CHUNK - 1) / CHUNK;
+    unsigned threads = opts.threads ? opts.threads : thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (opts.one_chunk)
+        threads = 1;
+    else if (threads > chunks)
+        threads = unsigned(chunks ? chunks : 1);
+
+    Shared shared;
+    auto begin = chrono::steady_clock::now();
+    if (opts.one_chunk) {
+        run_chunk(opts.chunk, CHUNK, shared, opts);
+    } else {
+        vector<thread> workers;
+        for (unsigned w = 0; w < threads; w++) {
+            workers.emplace_back([&] {
+                uint64_t chunk;
+                while ((chunk = shared.next_chunk++) < chunks) {
+                    uint64_t count = min(CHUNK, opts.vectors - chunk * CHUNK);
+                    run_chunk(chunk, count, shared, opts);
+                }
+            });
+        }
+        for (thread& t : workers)
+            t.join();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+
+    uint64_t total = shared.alu_vectors + shared.regfile_vectors;
+    cout << "Seed " << opts.seed << ": " << shared.alu_vectors << " ALU vectors, "
+         << shared.regfile_vectors << " regfile vectors, " << shared.failures
+         << " failures" << endl;
+    cout << "Host time: " << fixed << setprecision(3) << elapsed.count() << " s with "
+         << threads << " threads, " << setprecision(0) << total / elapsed.count()
+         << " vectors/s" << defaultfloat << endl;
+    return shared.failures == 0 ? 0 : 1;
+}
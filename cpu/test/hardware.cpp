@@ -1,21 +1,223 @@
 #include "hardware.hpp"
 #include "Vhardware.h"
+#include "checkpoint.hpp"
+#include "cosim.hpp"
+#include "loader.hpp"
+#include "monitor.hpp"
+#include "tracer.hpp"
+#include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <verilated_vcd_c.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* 仿真程序的命令行参数 */
+struct Options {
+    string bin_file;            // 程序文件
+    int sim_times = 0;          // 最大仿真时间步数（周期数的两倍）
+    vector<string> data_specs;  // 附加数据文件，<file>@<addr>
+    uint32_t halt_instr = 0;    // 停机指令的编码
+    bool use_halt_instr = false;
+    bool cosim = false;         // 是否与参考模型锁步比对
+    string stats_file;          // 追加CSV格式统计结果的文件
+    string save_file;           // 保存检查点的文件
+    uint64_t save_cycle = 0;    // 在该周期结束时保存检查点
+    bool use_save_cycle = false;
+    uint64_t save_pc = 0;       // 在该地址的指令第一次退休时保存检查点
+    bool use_save_pc = false;
+    string restore_file;        // 从该检查点继续仿真
+    uint64_t ff_instrs = 0;     // 先由指令集模拟器执行的指令数
+    uint64_t ff_pc = 0;         // 指令集模拟器执行到该地址后切换到cpu
+    bool use_ff_pc = false;
+    uint64_t roi = 0;           // cpu退休该数目的指令后切换回指令集模拟器，0表示不切换
+    string mem_latency;         // 访存总线的延迟模型，为空表示fixed:0
+    uint32_t mem_interval = 0;  // 相邻两次访存完成之间的最小间隔（限制带宽）
+    tracer::Config trace;       // 波形跟踪的配置
+};
+
+/* 指令集模拟器单独执行时的最大指令数，与iss的默认值相同 */
+constexpr uint64_t FF_LIMIT = 1000000000ULL;
+
+/**
+ * @brief 程序由指令集模拟器执行到结束时，把它的停止原因换成cpu仿真的停止原因
+ *
+ * 执行了FF_LIMIT条指令仍未结束与cpu用完周期预算相同，都是程序没有结束。
+ */
+monitor::StopReason from_iss(iss::StopReason reason) {
+    switch (reason) {
+    case iss::StopReason::SELF_LOOP:
+        return monitor::StopReason::SELF_LOOP;
+    case iss::StopReason::HALT_INSTR:
+        return monitor::StopReason::HALT_INSTR;
+    case iss::StopReason::UNKNOWN_INSTR:
+        return monitor::StopReason::UNKNOWN_INSTR;
+    default:
+        return monitor::StopReason::BUDGET;
+    }
+}
+
+/**
+ * @brief Vhardware的返回值：与参考模型出现不一致，或者程序没有结束时返回1
+ *
+ * 原地循环、停机指令和未知指令都是程序的结束；无论程序由cpu还是由指令集模拟器执行到结束，
+ * 返回值都只取决于最终的停止原因。
+ */
+int exit_code(monitor::StopReason reason, bool diverged) {
+    return diverged || reason == monitor::StopReason::BUDGET ? 1 : 0;
+}
+
+/**
+ * @brief 解析形如<a>[:<b>]的一对数值，省略b时保持其原值
+ *
+ * @return true 解析成功
+ * @return false 格式错误
+ */
+bool parse_range(const string& text, uint64_t& a, uint64_t& b) {
+    char* end = nullptr;
+    a = strtoull(text.c_str(), &end, 0);
+    if (end == text.c_str())
+        return false;
+    if (*end == '\0')
+        return true;
+    if (*end != ':')
+        return false;
+    const char* rest = end + 1;
+    b = strtoull(rest, &end, 0);
+    return end != rest && *end == '\0';
+}
+
+/**
+ * @brief 解析命令行参数
+ *
+ * @return true 解析成功
+ * @return false 参数错误
+ */
+bool parse_options(int argc, char** argv, Options& opts) {
+    vector<string> positional;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--halt" && i + 1 < argc) {
+            opts.halt_instr = strtoul(argv[++i], nullptr, 0);
+            opts.use_halt_instr = true;
+        } else if (arg == "--cosim") {
+            opts.cosim = true;
+        } else if (arg == "--stats" && i + 1 < argc) {
+            opts.stats_file = argv[++i];
+        } else if (arg == "--save" && i + 1 < argc) {
+            opts.save_file = argv[++i];
+        } else if (arg == "--save-cycle" && i + 1 < argc) {
+            opts.save_cycle = strtoull(argv[++i], nullptr, 0);
+            opts.use_save_cycle = true;
+        } else if (arg == "--save-pc" && i + 1 < argc) {
+            opts.save_pc = strtoull(argv[++i], nullptr, 0);
+            opts.use_save_pc = true;
+        } else if (arg == "--restore" && i + 1 < argc) {
+            opts.restore_file = argv[++i];
+        } else if (arg == "--ff" && i + 1 < argc) {
+            opts.ff_instrs = strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--ff-pc" && i + 1 < argc) {
+            opts.ff_pc = strtoull(argv[++i], nullptr, 0);
+            opts.use_ff_pc = true;
+        } else if (arg == "--roi" && i + 1 < argc) {
+            opts.roi = strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--mem-latency" && i + 1 < argc) {
+            opts.mem_latency = argv[++i];
+        } else if (arg == "--mem-interval" && i + 1 < argc) {
+            opts.mem_interval = uint32_t(strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--trace" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode != "on" && mode != "off") {
+                cerr << "Invalid trace mode: " << mode << endl;
+                return false;
+            }
+            opts.trace.enabled = (mode == "on");
+        } else if (arg == "--trace-window" && i + 1 < argc) {
+            if (!parse_range(argv[++i], opts.trace.start, opts.trace.end)) {
+                cerr << "Invalid trace window: " << argv[i] << endl;
+                return false;
+            }
+        } else if (arg == "--trace-pc" && i + 1 < argc) {
+            if (!parse_range(argv[++i], opts.trace.pc, opts.trace.pc_cycles)) {
+                cerr << "Invalid trace trigger: " << argv[i] << endl;
+                return false;
+            }
+            opts.trace.pc_trigger = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            cerr << "Unknown option: " << arg << endl;
+            return false;
+        } else if (positional.size() < 2) {
+            positional.push_back(arg);
+        } else {
+            opts.data_specs.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 2)
+        return false;
+    opts.bin_file = positional[0];
+    opts.sim_times = atoi(positional[1].c_str());
+
+    if ((!opts.save_file.empty() || !opts.restore_file.empty()) &&
+        !checkpoint::supported()) {
+        cerr << "Vhardware was built without --savable, checkpoints are not "
+                "available"
+             << endl;
+        return false;
+    }
+    if (!opts.save_file.empty() && !opts.use_save_cycle && !opts.use_save_pc) {
+        cerr << "--save needs --save-cycle or --save-pc" << endl;
+        return false;
+    }
+    if (!opts.restore_file.empty() &&
+        (opts.cosim || opts.ff_instrs || opts.use_ff_pc || opts.roi)) {
+        cerr << "--cosim, --ff, --ff-pc and --roi cannot be combined with --restore"
+             << endl;
+        return false;
+    }
+    return true;
+}
 
 int main(int argc, char** argv) {
-    Verilated::traceEverOn(true); // 开启波形跟踪
-    Vhardware hardware;
-    VerilatedVcdC trace;       // 实例化波形跟踪对象
-    hardware.trace(&trace, 5); // 将波形跟踪对象与仿真模型关联
+    Options opts;
 #ifndef __HARDWARE_RELEASE__
-    trace.open("./sim/hardware.vcd"); // 打开波形文件
+    (void)argc;
+    (void)argv;
+    opts.sim_times = 400;
+    const char* wave_path = "./sim/hardware";
 #else
-    trace.open("./cpu/sim/hardware.vcd"); // 打开波形文件
+    // 检查格式
+    if (!parse_options(argc, argv, opts)) {
+        cerr << "Usage: Vhardware <bin_file> <sim_times> [--halt <instr>] "
+                "[--cosim] [--stats <csv_file>] [--save <file> "
+                "--save-cycle <cycle>|--save-pc <pc>] [--restore <file>] "
+                "[--ff <instrs>] [--ff-pc <pc>] [--roi <instrs>] "
+                "[--mem-latency fixed:<n>|random:<min>:<max>[:<seed>]|trace:<file>] "
+                "[--mem-interval <cycles>] "
+                "[--trace on|off] [--trace-window <start>:<end>] "
+                "[--trace-pc <pc>[:<cycles>]] [<data_file>@<addr> ...]"
+             << endl;
+        return 1;
+    }
+    const char* wave_path = "./cpu/sim/hardware";
+    if (opts.trace.enabled && !tracer::supported())
+        cerr << "Note: Vhardware was built without tracing, no waveform "
+                "will be written"
+             << endl;
 #endif
 
+    tracer::Tracer trace(opts.trace);
+    trace.prepare(); // 开启波形跟踪
+    Vhardware hardware;
+    trace.open(&hardware, wave_path); // 将波形文件与仿真模型关联
+    unique_ptr<cosim::Cosim> ref;
+    monitor::Monitor monitor(opts.halt_instr, opts.use_halt_instr);
+    int start = 0; // 第一个仿真时间步，从检查点继续时为保存时的下一步
+    bool ff_finished = false; // 程序在快速前进的过程中已经结束，cpu不再仿真
+
 #ifndef __HARDWARE_RELEASE__
     uint64_t instr = 0;
     /* addi x1 x1 1 ; x1==1 */
@@ -77,65 +279,158 @@ int main(int argc, char** argv) {
     instr = (uint64_t)0b11111111111100001100000010010011 << 32;
     hardware::write_64bits(&hardware, 0x38, instr);
 #else
-    // 检查格式
-    if (argc != 3) {
-        cerr << "Usage: Vhardware <bin_file> <sim_times>" << endl;
+    // 访存总线的延迟模型在第一个时钟上升沿之前设置
+    if (!hardware::configure_bus(&hardware, opts.mem_latency, opts.mem_interval))
         return 1;
-    }
 
-    // 打开文件
-    string bin_file = argv[1];
-    std::ifstream file(argv[1], std::ios::binary);
-    if (!file) {
-        std::cerr << "Error opening file: " << argv[1] << std::endl;
-        return 1;
+    if (!opts.restore_file.empty()) {
+        // 从检查点继续：模型、RAM和统计状态都来自检查点，不再装载程序和数据文件
+#if HARDWARE_SAVABLE
+        checkpoint::State state;
+        if (!checkpoint::restore(&hardware, opts.restore_file, state))
+            return 1;
+        monitor.set_state(state.stats);
+        start = int(state.step) + 1;
+        cout << "Restored checkpoint " << opts.restore_file << " at cycle "
+             << state.stats.cycles << endl;
+#endif
+    } else {
+        // 通过后门将程序映像的各个段一次性装载到各自的地址处，pc设为入口地址
+        uint64_t entry;
+        if (!loader::load_program(&hardware, opts.bin_file, entry))
+            return 1;
+
+        // 装载附加的数据文件
+        for (const string& spec : opts.data_specs) {
+            if (!loader::load_spec(&hardware, spec))
+                return 1;
+        }
     }
 
-    // 获取仿真时间步数
-    int sim_times = atoi(argv[2]);
-
-    // 读取文件并将32位指令一次写入硬件
-    uint32_t address = 0x00;
-    while (true) {
-        // 检测文件是否结束
-        if (file.eof())
-            break;
-
-        // 读取32位指令
-        uint32_t instruction;
-        file.read(reinterpret_cast<char*>(&instruction), sizeof(instruction));
-        // 转化为大端序
-        uint32_t new_instr = (instruction & 0x000000FF) >> 0 << 24 |
-                             (instruction & 0x0000FF00) >> 8 << 16 |
-                             (instruction & 0x00FF0000) >> 16 << 8 |
-                             (instruction & 0xFF000000) >> 24 << 0;
-        instruction = new_instr;
-
-        // 检测文件是否结束
-        if (file.eof())
-            break;
-
-        // 检测文件是否读取错误
-        if (!file) {
-            std::cerr << "Error reading file at address 0x" << std::hex
-                      << address << std::endl;
+    // 参考模型装载相同的程序和数据；快速前进和感兴趣区间也由参考模型执行
+    bool fast_forward = opts.ff_instrs || opts.use_ff_pc;
+    if (opts.cosim || fast_forward || opts.roi) {
+        ref.reset(new cosim::Cosim);
+        if (!ref->load_program(opts.bin_file))
             return 1;
+        for (const string& spec : opts.data_specs) {
+            if (!ref->load_spec(spec))
+                return 1;
         }
+        ref->model().halt_instr = opts.halt_instr;
+        ref->model().use_halt_instr = opts.use_halt_instr;
+    }
 
-        // 将32位指令扩展到64位高位
-        uint64_t full_instruction = static_cast<uint64_t>(instruction) << 32;
-        hardware::write_64bits(&hardware, address, full_instruction);
-        address += 4; // 地址按4字节步进
+    // 快速前进：指令集模拟器执行到指定的指令数或地址，再把状态交给cpu
+    if (fast_forward) {
+        iss::Iss& iss = ref->model();
+        iss.stop_pc = opts.ff_pc;
+        iss.use_stop_pc = opts.use_ff_pc;
+        auto ff_begin = chrono::steady_clock::now();
+        iss::StopReason reason = iss.run(opts.ff_instrs ? opts.ff_instrs : FF_LIMIT);
+        chrono::duration<double> ff_elapsed = chrono::steady_clock::now() - ff_begin;
+        iss.use_stop_pc = false;
+
+        cout << "Fast-forward: " << iss.instret() << " instructions in " << fixed
+             << setprecision(3) << ff_elapsed.count() << " s, "
+             << iss::reason_name(reason) << " (pc=0x" << hex << iss.pc << dec << ")"
+             << defaultfloat << endl;
+        if (opts.use_ff_pc && !opts.ff_instrs && reason == iss::StopReason::LIMIT) {
+            cerr << "Error: pc 0x" << hex << opts.ff_pc << dec << " not reached in "
+                 << FF_LIMIT << " instructions" << endl;
+            return 1;
+        }
+        if (reason == iss::StopReason::LIMIT || reason == iss::StopReason::STOP_PC) {
+            ref->transfer(&hardware);
+        } else {
+            // 程序在快速前进的过程中已经结束：停止原因来自指令集模拟器，统计结果照常输出
+            ff_finished = true;
+            monitor.finished_in_iss(from_iss(reason), iss.pc, iss.mem.read32(iss.pc));
+        }
     }
-    file.close();
 #endif
 
+    // 运行到停机，sim_times作为最大仿真时间步数的保护
+    auto begin = chrono::steady_clock::now();
     hardware.clk = 1;
-    for (int i = 0; i < sim_times; i++) {
+    bool stopped = ff_finished;
+    bool switched = false; // 感兴趣区间结束后切换回了指令集模拟器
+#if HARDWARE_SAVABLE
+    bool saved = false;
+#endif
+    for (int i = start; i < opts.sim_times && !stopped; i++) {
         hardware.clk = !hardware.clk;
         hardware.eval();
-        trace.dump(i);
+        // 每个时钟上升沿检查一次
+        if (hardware.clk) {
+            stopped = monitor.step(&hardware);
+            if (ref && !ref->check(&hardware))
+                stopped = true;
+            if (!stopped && opts.roi && monitor.instret() >= opts.roi) {
+                monitor.end_region(&hardware);
+                stopped = switched = true;
+            }
+#if HARDWARE_SAVABLE
+            // 到达指定的周期或指令地址时保存一次检查点，之后继续仿真
+            if (!saved && !opts.save_file.empty() &&
+                ((opts.use_save_cycle && monitor.cycles() == opts.save_cycle) ||
+                 (opts.use_save_pc && hardware.dbg_retire &&
+                  hardware.dbg_pc == opts.save_pc))) {
+                checkpoint::save(&hardware, opts.save_file,
+                                 checkpoint::State{uint64_t(i), monitor.state()});
+                saved = true;
+                cout << "Checkpoint saved to " << opts.save_file << " at cycle "
+                     << monitor.cycles() << endl;
+            }
+#endif
+        }
+        trace.dump(&hardware, i, monitor.cycles());
     }
+    if (!stopped)
+        monitor.exhausted(&hardware);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
 
     trace.close();
+
+    monitor.report(cout);
+    monitor::report_counters(cout, &hardware);
+    monitor::report_bus(cout, &hardware, monitor.cycles());
+    if (ref)
+        ref->report(cout);
+    cout << "Host time: " << fixed << setprecision(3) << elapsed.count()
+         << " s, " << setprecision(0) << monitor.cycles() / elapsed.count()
+         << " cycles/s" << defaultfloat << endl;
+
+    // 参考模型与cpu最近退休的指令对齐，由它执行程序的其余部分；
+    // 程序最终的停止原因（决定返回值）来自指令集模拟器
+    monitor::StopReason final_reason = monitor.reason();
+    if (switched) {
+        iss::Iss& iss = ref->model();
+        uint64_t before = iss.instret();
+        iss::StopReason reason = iss.run(FF_LIMIT);
+        final_reason = from_iss(reason);
+        cout << "Finished in the ISS: " << iss.instret() - before
+             << " instructions, " << iss::reason_name(reason) << " (pc=0x" << hex
+             << iss.pc << dec << "), " << iss.instret() << " in total" << endl;
+    }
+
+    // 追加一行统计结果，文件为空时先写表头；程序名为去掉目录和扩展名的文件名
+    if (!opts.stats_file.empty()) {
+        ofstream stats(opts.stats_file, ios::app);
+        if (!stats) {
+            cerr << "Cannot open stats file: " << opts.stats_file << endl;
+            return 1;
+        }
+        if (stats.tellp() == 0)
+            stats << monitor::Monitor::CSV_HEADER << endl;
+        string name = opts.bin_file.substr(opts.bin_file.find_last_of('/') + 1);
+        monitor.report_csv(stats, name.substr(0, name.find('.')), elapsed.count());
+    }
+
+    // 输出RAM的实际内存占用
+    const ram::SparseRam& mem = hardware::memory(&hardware);
+    cout << "RAM resident: " << mem.page_count() << " pages, "
+         << mem.resident_bytes() / 1024 << " KB" << endl;
+
+    return exit_code(final_reason, ref && ref->diverged());
 }
\ No newline at end of file
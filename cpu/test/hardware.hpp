@@ -2,6 +2,13 @@
 #define __HARDWARE_HPP__
 
 #include "Vhardware.h"
+#include "Vhardware___024root.h"
+#include "bus_model.hpp"
+#include "sparse_ram.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
 
 using namespace std;
 
@@ -79,6 +86,154 @@ inline uint64_t read_64bits(Vhardware* hardware, uint32_t addr) {
     return data;
 }
 
+/**
+ * @brief 读取cpu寄存器文件中x[idx]的值
+ *
+ * @param hardware 需要读取的硬件
+ * @param idx 寄存器编号
+ * @return uint64_t 寄存器的值
+ */
+inline uint64_t reg(Vhardware* hardware, int idx) {
+    if (idx == 0)
+        return 0;
+    return hardware->rootp
+        ->hardware__DOT__cpu_inst__DOT__regfile_inst__DOT__registers[idx];
+}
+
+/**
+ * @brief 设置cpu寄存器文件中x[idx]的值，用于从指令集模拟器切换到cpu
+ *
+ * @param hardware 需要设置的硬件
+ * @param idx 寄存器编号，x0不可写
+ * @param value 新的值
+ */
+inline void set_reg(Vhardware* hardware, int idx, uint64_t value) {
+    if (idx == 0)
+        return;
+    hardware->rootp
+        ->hardware__DOT__cpu_inst__DOT__regfile_inst__DOT__registers[idx] = value;
+}
+
+/* 性能计数器的个数，第idx个计数器的CSR地址为0xC00+idx（见perf.v） */
+constexpr int PERF_COUNTERS = 17;
+
+/**
+ * @brief 性能计数器的名称，与perf.v中的列表一致
+ */
+inline const char* perf_name(int idx) {
+    static const char* const names[PERF_COUNTERS] = {
+        "cycle",      "time",       "instret",    "mem_read",
+        "mem_write",  "br_taken",   "cls_alu",    "cls_muldiv",
+        "cls_load",   "cls_store",  "cls_branch", "cls_jump",
+        "cls_csr",    "stall_load", "stall_mem",  "flush",
+        "stall_bus"};
+    return idx >= 0 && idx < PERF_COUNTERS ? names[idx] : "unknown";
+}
+
+/**
+ * @brief 读取cpu的第idx个性能计数器
+ *
+ * @param hardware 需要读取的硬件
+ * @param idx 计数器编号（CSR地址-0xC00）
+ * @return uint64_t 计数值
+ */
+inline uint64_t perf(Vhardware* hardware, int idx) {
+    return hardware->rootp
+        ->hardware__DOT__cpu_inst__DOT__perf_inst__DOT__counters[idx];
+}
+
+/**
+ * @brief 设置cpu的第idx个性能计数器
+ *
+ * @param hardware 需要设置的硬件
+ * @param idx 计数器编号（CSR地址-0xC00）
+ * @param value 新的计数值
+ */
+inline void set_perf(Vhardware* hardware, int idx, uint64_t value) {
+    hardware->rootp
+        ->hardware__DOT__cpu_inst__DOT__perf_inst__DOT__counters[idx] = value;
+}
+
+/**
+ * @brief 设置cpu的pc，用于从程序映像的入口地址开始执行
+ *
+ * 应在仿真开始之前调用：多周期cpu和流水线cpu都从pc_inst的pc_addr处取第一条指令。
+ *
+ * @param hardware 需要设置的硬件
+ * @param pc 新的pc
+ */
+inline void set_pc(Vhardware* hardware, uint64_t pc) {
+    hardware->rootp->hardware__DOT__cpu_inst__DOT__pc_inst__DOT__pc_addr = pc;
+}
+
+/**
+ * @brief 取得硬件中RAM的存储（ram.v的DPI-C后端）
+ *
+ * RAM的存储在ram.v的initial块中申请，若模型尚未求值过则先求值一次。
+ *
+ * @param hardware 需要访问的硬件
+ * @return ram::SparseRam& RAM的存储
+ */
+inline ram::SparseRam& memory(Vhardware* hardware) {
+    auto& handle = hardware->rootp->hardware__DOT__ram_inst__DOT__handle;
+    if (handle == 0)
+        hardware->eval();
+    return ram::from_handle(handle);
+}
+
+/**
+ * @brief 取得访存总线的延迟模型（membus.v的DPI-C后端）
+ *
+ * 延迟模型在membus.v的initial块中申请，应在仿真开始之前设置：
+ * 第一次访存的延迟在第一个时钟上升沿取得。
+ *
+ * @param hardware 需要访问的硬件
+ * @return bus::LatencyModel& 延迟模型
+ */
+inline bus::LatencyModel& bus_model(Vhardware* hardware) {
+    auto& handle = hardware->rootp->hardware__DOT__membus_inst__DOT__handle;
+    if (handle == 0)
+        hardware->eval();
+    return bus::from_handle(handle);
+}
+
+/**
+ * @brief 按命令行参数设置访存总线的延迟模型
+ *
+ * @param hardware 需要设置的硬件
+ * @param spec 延迟模型的描述（见bus::LatencyModel），为空时保持默认的fixed:0
+ * @param interval 相邻两次访存完成之间的最小间隔
+ * @return true 设置成功，否则输出错误信息
+ */
+inline bool configure_bus(Vhardware* hardware, const string& spec, uint32_t interval) {
+    bus::LatencyModel& model = bus_model(hardware);
+    string error;
+    if (!spec.empty() && !model.configure(spec, error)) {
+        cerr << "Error: " << error << endl;
+        return false;
+    }
+    model.interval = interval;
+    return true;
+}
+
+/**
+ * @brief 通过后门将一段连续的数据直接写入RAM
+ *
+ * 不经过test_*端口，也不推进仿真，适合一次性装载整个程序镜像。
+ * ram.v按大端序逐字节存放，与汇编器输出的二进制文件的字节顺序一致，
+ * 因此整段数据可以直接按字节拷贝，无需逐字做端序转换。
+ *
+ * @param hardware 需要写入的硬件
+ * @param addr 写入的起始地址
+ * @param data 需要写入的数据
+ * @param size 数据的字节数
+ * @return size_t 实际写入的字节数（超出RAM容量的部分被丢弃）
+ */
+inline size_t load_bytes(Vhardware* hardware, uint64_t addr,
+                         const uint8_t* data, size_t size) {
+    return memory(hardware).write(addr, data, size);
+}
+
 } // namespace hardware
 
 #endif
\ No newline at end of file
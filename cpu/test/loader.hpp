@@ -0,0 +1,161 @@
+#ifndef __LOADER_HPP__
+#define __LOADER_HPP__
+
+#include "../../as/src/image.hpp"
+#include "hardware.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace loader {
+
+/**
+ * @brief 以只读方式映射到内存中的文件
+ */
+class MappedFile {
+  public:
+    explicit MappedFile(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            size_ = st.st_size;
+            if (size_ == 0) {
+                valid_ = true;
+            } else {
+                void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    data_ = static_cast<const uint8_t*>(addr);
+                    valid_ = true;
+                }
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_)
+            munmap(const_cast<uint8_t*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const { return valid_; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+  private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool valid_ = false;
+};
+
+/**
+ * @brief 将整个文件装载到RAM的指定地址处
+ *
+ * @param hardware 需要装载的硬件
+ * @param path 文件路径
+ * @param addr 装载的起始地址
+ * @return true 装载成功
+ * @return false 文件无法打开，或文件超出了RAM的范围
+ */
+inline bool load_file(Vhardware* hardware, const string& path, uint64_t addr) {
+    MappedFile file(path);
+    if (!file.valid()) {
+        cerr << "Error opening file: " << path << endl;
+        return false;
+    }
+
+    size_t loaded = hardware::load_bytes(hardware, addr, file.data(), file.size());
+    if (loaded != file.size()) {
+        cerr << "Error: " << path << " does not fit in RAM at address 0x" << hex
+             << addr << dec << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 装载汇编器生成的程序映像：各个段直接从映射的文件复制到装载地址处，pc设为入口地址
+ *
+ * 不是映像格式的文件按原始二进制装载到地址0处，入口为0。
+ *
+ * @param hardware 需要装载的硬件
+ * @param path 映像文件路径
+ * @param entry 返回入口地址
+ * @return true 装载成功
+ * @return false 文件无法打开、格式错误，或某个段超出了RAM的范围
+ */
+inline bool load_program(Vhardware* hardware, const string& path, uint64_t& entry) {
+    MappedFile file(path);
+    if (!file.valid()) {
+        cerr << "Error opening file: " << path << endl;
+        return false;
+    }
+
+    string error;
+    auto write = [&](uint64_t addr, const uint8_t* data, size_t size) {
+        return hardware::load_bytes(hardware, addr, data, size);
+    };
+    if (!image::load(file.data(), file.size(), write, entry, error)) {
+        cerr << "Error loading " << path << ": " << error << endl;
+        return false;
+    }
+    hardware::set_pc(hardware, entry);
+    return true;
+}
+
+/**
+ * @brief 解析形如<file>@<addr>的数据文件描述，addr支持十进制和0x前缀的十六进制
+ *
+ * @param spec 数据文件描述
+ * @param path 解析得到的文件路径
+ * @param addr 解析得到的装载地址
+ * @return true 解析成功
+ * @return false 格式错误
+ */
+inline bool parse_spec(const string& spec, string& path, uint64_t& addr) {
+    size_t at = spec.rfind('@');
+    if (at == string::npos || at == 0 || at + 1 == spec.size()) {
+        cerr << "Error: data file must be given as <file>@<addr>: " << spec
+             << endl;
+        return false;
+    }
+
+    char* end = nullptr;
+    addr = strtoull(spec.c_str() + at + 1, &end, 0);
+    if (*end != '\0') {
+        cerr << "Error: invalid load address: " << spec.substr(at + 1) << endl;
+        return false;
+    }
+    path = spec.substr(0, at);
+    return true;
+}
+
+/**
+ * @brief 装载形如<file>@<addr>的数据文件
+ *
+ * @param hardware 需要装载的硬件
+ * @param spec 数据文件描述
+ * @return true 装载成功
+ * @return false 格式错误或装载失败
+ */
+inline bool load_spec(Vhardware* hardware, const string& spec) {
+    string path;
+    uint64_t addr;
+    return parse_spec(spec, path, addr) && load_file(hardware, path, addr);
+}
+
+} // namespace loader
+
+#endif
@@ -0,0 +1,191 @@
+#include "Vmembus.h"
+#include "Vmembus___024root.h"
+#include "bus_model.hpp"
+#include "verilated.h"
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * 访存总线的延迟模型：保持请求直到ready有效，检查每次请求所用的周期数。
+ * 一次请求所用的周期数为延迟+1（ready有效的周期也计入），与interval共同决定。
+ */
+
+/* 产生一个完整的时钟周期 */
+void tick(Vmembus& dut) {
+    dut.clk = 0;
+    dut.eval();
+    dut.clk = 1;
+    dut.eval();
+}
+
+/**
+ * @brief 新建一个总线，设置延迟模型之后经过第一个上升沿（取得第一次访存的延迟）
+ */
+std::unique_ptr<Vmembus> make_bus(const std::string& spec, uint32_t interval) {
+    std::unique_ptr<Vmembus> dut(new Vmembus);
+    dut->eval();
+    bus::LatencyModel& model = bus::from_handle(dut->rootp->membus__DOT__handle);
+    std::string error;
+    if (!model.configure(spec, error))
+        std::cerr << error << std::endl;
+    model.interval = interval;
+    dut->valid = 0;
+    dut->restart = 0;
+    tick(*dut);
+    return dut;
+}
+
+/**
+ * @brief 保持请求直到ready有效，返回所用的周期数
+ */
+int request(Vmembus& dut) {
+    dut.valid = 1;
+    int cycles = 1;
+    for (;; cycles++) {
+        dut.eval();
+        bool ready = dut.ready;
+        tick(dut);
+        if (ready || cycles >= 1000)
+            break;
+    }
+    dut.valid = 0;
+    dut.eval();
+    return cycles;
+}
+
+/**
+ * @brief 连续n次请求（中间空闲idle个周期）所用的周期数
+ */
+std::vector<int> requests(Vmembus& dut, int n, int idle = 0) {
+    std::vector<int> cycles;
+    for (int i = 0; i < n; i++) {
+        cycles.push_back(request(dut));
+        for (int j = 0; j < idle; j++)
+            tick(dut);
+    }
+    return cycles;
+}
+
+/**
+ * @brief 请求wait个周期（尚未完成）之后换成另一个请求，返回新的请求所用的周期数
+ *
+ * restart为真时模拟流水线的MEM级接替取指（valid保持有效，给出restart），
+ * 否则模拟跳转撤回取指（valid无效一个周期之后再请求）。
+ */
+int switch_request(Vmembus& dut, int wait, bool restart) {
+    dut.valid = 1;
+    for (int i = 0; i < wait; i++)
+        tick(dut);
+    if (restart) {
+        dut.restart = 1;
+        dut.eval();
+        bool ready = dut.ready;
+        tick(dut);
+        dut.restart = 0;
+        if (ready)
+            return 1;
+        return request(dut) + 1;
+    }
+    dut.valid = 0;
+    tick(dut);
+    return request(dut);
+}
+
+/* 输出一个测试的结果 */
+bool check(const char* name, const std::vector<int>& actual, const std::vector<int>& expected) {
+    if (actual == expected) {
+        std::cout << "✅ " << name << " test passed." << std::endl;
+        return true;
+    }
+    std::cerr << "❌ " << name << " test failed:";
+    for (int c : actual)
+        std::cerr << " " << c;
+    std::cerr << std::endl;
+    return false;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    int pass_count = 0, total = 0;
+
+    // 默认的fixed:0：每次请求都在当前周期完成，与直接连接ram相同
+    {
+        auto dut = make_bus("fixed:0", 0);
+        total++;
+        pass_count += check("Zero latency", requests(*dut, 4), {1, 1, 1, 1});
+        dut->final();
+    }
+
+    // 固定延迟：每次请求等待3个周期，空闲的周期不计入下一次请求的延迟
+    {
+        auto dut = make_bus("fixed:3", 0);
+        total++;
+        pass_count += check("Fixed latency", requests(*dut, 3), {4, 4, 4});
+        total++;
+        pass_count += check("Fixed latency after idle", requests(*dut, 2, 5), {4, 4});
+        // 等待中换了请求：新的请求不继承已经等待的周期
+        total++;
+        pass_count += check("Restart mid-wait", {switch_request(*dut, 1, true), request(*dut)}, {4, 4});
+        total++;
+        pass_count += check("Withdraw mid-wait", {switch_request(*dut, 2, false), request(*dut)}, {4, 4});
+        dut->final();
+    }
+
+    // 按文件给出的延迟：依次使用，用完后从头开始
+    {
+        const char* path = "membus_trace.txt";
+        FILE* file = fopen(path, "w");
+        fputs("0 2 # 注释\n5\n", file);
+        fclose(file);
+        auto dut = make_bus(std::string("trace:") + path, 0);
+        total++;
+        pass_count += check("Trace latency", requests(*dut, 5), {1, 3, 6, 1, 3});
+        remove(path);
+        dut->final();
+    }
+
+    // 带宽：相邻两次访存完成之间至少间隔4个周期
+    {
+        auto dut = make_bus("fixed:0", 4);
+        total++;
+        pass_count += check("Interval", requests(*dut, 3), {1, 4, 4});
+        // 空闲的周期计入间隔
+        for (int i = 0; i < 4; i++)
+            tick(*dut);
+        total++;
+        pass_count += check("Interval after idle", requests(*dut, 2, 4), {1, 1});
+        dut->final();
+    }
+
+    // 随机延迟：每次请求的延迟都在[min, max]中，且同一个种子得到相同的序列
+    {
+        auto a = make_bus("random:1:4:7", 0);
+        auto b = make_bus("random:1:4:7", 0);
+        std::vector<int> first = requests(*a, 64), second = requests(*b, 64);
+        bool in_range = true;
+        for (int c : first)
+            in_range = in_range && c >= 2 && c <= 5;
+        total++;
+        pass_count += check("Random latency", {in_range && first == second}, {1});
+        a->final();
+        b->final();
+    }
+
+    // 错误的描述
+    {
+        bus::LatencyModel model;
+        std::string error;
+        bool rejected = !model.configure("random:4:1", error) &&
+                        !model.configure("fixed", error) &&
+                        !model.configure("trace:/nonexistent", error);
+        total++;
+        pass_count += check("Invalid model", {rejected}, {1});
+    }
+
+    std::cout << "MEMBUS Test: " << pass_count << "/" << total << " pass_count\n";
+    return pass_count == total ? 0 : 1;
+}
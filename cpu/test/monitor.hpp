@@ -0,0 +1,234 @@
+#ifndef __MONITOR_HPP__
+#define __MONITOR_HPP__
+
+#include "Vhardware.h"
+#include "hardware.hpp"
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace monitor {
+
+/* 仿真停止的原因 */
+enum class StopReason {
+    RUNNING,        // 仍在运行
+    UNKNOWN_INSTR,  // 控制器进入UNKNOWN_INSTR状态
+    SELF_LOOP,      // 跳转到自身（原地循环）
+    HALT_INSTR,     // 执行了指定的停机指令
+    BUDGET,         // 用完了最大仿真周期数
+    REGION_END,     // 感兴趣区间结束，其余部分交给指令集模拟器
+};
+
+inline const char* reason_name(StopReason reason) {
+    switch (reason) {
+    case StopReason::RUNNING:
+        return "running";
+    case StopReason::UNKNOWN_INSTR:
+        return "unknown instruction";
+    case StopReason::SELF_LOOP:
+        return "jump to self";
+    case StopReason::HALT_INSTR:
+        return "halt instruction";
+    case StopReason::BUDGET:
+        return "cycle budget exhausted";
+    case StopReason::REGION_END:
+        return "end of region of interest";
+    }
+    return "";
+}
+
+/**
+ * @brief 通过cpu的观测接口统计周期数、退休指令数，并判断是否应当停止仿真
+ */
+class Monitor {
+  public:
+    /**
+     * @param halt_instr 停机指令的编码
+     * @param use_halt_instr 是否启用停机指令
+     */
+    Monitor(uint32_t halt_instr = 0, bool use_halt_instr = false)
+        : halt_instr_(halt_instr), use_halt_instr_(use_halt_instr) {}
+
+    /**
+     * @brief 在每个时钟上升沿求值之后调用一次
+     *
+     * @return true 应当停止仿真
+     */
+    bool step(Vhardware* hardware) {
+        cycles_++;
+        fetch_hits_ = hardware->dbg_fetch_hits;
+        fetch_misses_ = hardware->dbg_fetch_misses;
+
+        if (hardware->dbg_halt) {
+            stop(StopReason::UNKNOWN_INSTR, hardware->dbg_pc,
+                 hardware->dbg_instr);
+            return true;
+        }
+
+        if (!hardware->dbg_retire)
+            return false;
+
+        instret_++;
+        uint64_t pc = hardware->dbg_pc;
+        uint32_t instr = hardware->dbg_instr;
+
+        if (use_halt_instr_ && instr == halt_instr_) {
+            stop(StopReason::HALT_INSTR, pc, instr);
+            return true;
+        }
+
+        // 连续两次退休同一地址的指令，只可能是跳转到了自身
+        if (instret_ > 1 && pc == last_pc_) {
+            stop(StopReason::SELF_LOOP, pc, instr);
+            return true;
+        }
+        last_pc_ = pc;
+        return false;
+    }
+
+    /**
+     * @brief 仿真因周期预算耗尽而结束
+     */
+    void exhausted(Vhardware* hardware) {
+        if (reason_ == StopReason::RUNNING)
+            stop(StopReason::BUDGET, hardware->dbg_pc, hardware->dbg_instr);
+    }
+
+    /**
+     * @brief 感兴趣区间的指令已经全部退休，cpu的仿真到此结束
+     */
+    void end_region(Vhardware* hardware) {
+        if (reason_ == StopReason::RUNNING)
+            stop(StopReason::REGION_END, hardware->dbg_pc, hardware->dbg_instr);
+    }
+
+    /**
+     * @brief 程序在快速前进的过程中已经由指令集模拟器执行完毕，cpu没有仿真任何周期
+     */
+    void finished_in_iss(StopReason reason, uint64_t pc, uint32_t instr) {
+        stop(reason, pc, instr);
+    }
+
+    void report(ostream& out) const {
+        out << "Cycles simulated: " << cycles_ << endl;
+        out << "Instructions retired: " << instret_ << endl;
+        if (instret_ > 0)
+            out << "CPI: " << fixed << setprecision(2)
+                << double(cycles_) / instret_ << defaultfloat << endl;
+        uint64_t fetches = fetch_hits_ + fetch_misses_;
+        if (fetches > 0)
+            out << "Fetch buffer: " << fetch_hits_ << " hits, " << fetch_misses_
+                << " misses (" << fixed << setprecision(1)
+                << 100.0 * fetch_hits_ / fetches << "% hit)" << defaultfloat
+                << endl;
+        out << "Stop reason: " << reason_name(reason_) << " (pc=0x" << hex
+            << stop_pc_ << ", instr=0x" << stop_instr_ << dec << ")" << endl;
+    }
+
+    /**
+     * @brief 以CSV的一行输出统计结果（列见CSV_HEADER），便于比较不同版本的cpu
+     *
+     * @param name 程序的名字
+     * @param seconds 仿真所用的主机时间
+     */
+    void report_csv(ostream& out, const string& name, double seconds) const {
+        out << name << ',' << cycles_ << ',' << instret_ << ',' << fixed
+            << setprecision(3) << (instret_ ? double(cycles_) / instret_ : 0.0)
+            << ',' << setprecision(6) << seconds << ',' << setprecision(0)
+            << (seconds > 0 ? cycles_ / seconds : 0.0) << defaultfloat << ','
+            << reason_name(reason_) << endl;
+    }
+
+    static constexpr const char* CSV_HEADER =
+        "kernel,cycles,instret,cpi,host_seconds,cycles_per_second,stop_reason";
+
+    /* 保存到检查点中的统计状态 */
+    struct State {
+        uint64_t cycles;
+        uint64_t instret;
+        uint64_t last_pc;
+        uint64_t fetch_hits;
+        uint64_t fetch_misses;
+    };
+
+    State state() const {
+        return State{cycles_, instret_, last_pc_, fetch_hits_, fetch_misses_};
+    }
+
+    void set_state(const State& s) {
+        cycles_ = s.cycles;
+        instret_ = s.instret;
+        last_pc_ = s.last_pc;
+        fetch_hits_ = s.fetch_hits;
+        fetch_misses_ = s.fetch_misses;
+    }
+
+    uint64_t cycles() const { return cycles_; }
+    uint64_t instret() const { return instret_; }
+    StopReason reason() const { return reason_; }
+
+  private:
+    void stop(StopReason reason, uint64_t pc, uint32_t instr) {
+        reason_ = reason;
+        stop_pc_ = pc;
+        stop_instr_ = instr;
+    }
+
+    uint32_t halt_instr_;
+    bool use_halt_instr_;
+
+    uint64_t cycles_ = 0;
+    uint64_t instret_ = 0;
+    uint64_t last_pc_ = 0;
+    uint64_t fetch_hits_ = 0;   // 取指缓冲命中次数
+    uint64_t fetch_misses_ = 0; // 取指缓冲未命中次数
+
+    StopReason reason_ = StopReason::RUNNING;
+    uint64_t stop_pc_ = 0;
+    uint32_t stop_instr_ = 0;
+};
+
+/**
+ * @brief 输出cpu的全部性能计数器（time未实现，不输出）
+ */
+inline void report_counters(ostream& out, Vhardware* hardware) {
+    out << "Performance counters:" << endl;
+    for (int idx = 0; idx < hardware::PERF_COUNTERS; idx++) {
+        if (idx == 1)
+            continue;
+        out << "  " << hex << "0x" << (0xC00 + idx) << dec << " " << left
+            << setw(12) << hardware::perf_name(idx) << right << setw(14)
+            << hardware::perf(hardware, idx) << endl;
+    }
+}
+
+/**
+ * @brief 输出访存总线的延迟模型、访存次数和等待ram的周期数
+ *
+ * @param cycles 仿真的周期数，用于计算等待的周期所占的比例
+ */
+inline void report_bus(ostream& out, Vhardware* hardware, uint64_t cycles) {
+    // 性能计数器的编号见perf.v：mem_read、mem_write、stall_bus
+    uint64_t accesses = hardware::perf(hardware, 3) + hardware::perf(hardware, 4);
+    uint64_t stalls = hardware::perf(hardware, 16);
+    const bus::LatencyModel& model = hardware::bus_model(hardware);
+
+    out << "Memory bus: " << model.spec();
+    if (model.interval > 1)
+        out << ", interval " << model.interval;
+    out << ", " << accesses << " accesses, " << stalls << " stall cycles";
+    if (cycles > 0)
+        out << " (" << fixed << setprecision(1) << 100.0 * stalls / cycles
+            << "% of cycles)" << defaultfloat;
+    if (accesses > 0)
+        out << ", " << fixed << setprecision(2) << double(stalls) / accesses
+            << " per access" << defaultfloat;
+    out << endl;
+}
+
+} // namespace monitor
+
+#endif
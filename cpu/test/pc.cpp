@@ -6,6 +6,7 @@
 struct TestCase {
     bool reset;        // 复位信号
     bool sign;         // 跳转控制
+    bool half;         // 压缩指令：顺序执行时PC+2
     uint64_t tar;      // 目标地址
     uint64_t expected; // 预期PC值
 };
@@ -18,22 +19,27 @@ int main(int argc, char** argv) {
 
     // 测试用例集
     const TestCase tests[] = {// 复位测试
-                              {1, 0, 0x0000, 0x0000},
+                              {1, 0, 0, 0x0000, 0x0000},
                               // 顺序执行测试
-                              {0, 0, 0x0000, 0x0004},
-                              {0, 0, 0x0000, 0x0008},
-                              // 跳转测试
-                              {0, 1, 0x1000, 0x1000},
+                              {0, 0, 0, 0x0000, 0x0004},
+                              {0, 0, 0, 0x0000, 0x0008},
+                              // 压缩指令：顺序执行时PC+2
+                              {0, 0, 1, 0x0000, 0x000A},
+                              {0, 0, 1, 0x0000, 0x000C},
+                              // 跳转测试：跳转优先于压缩指令的PC+2
+                              {0, 1, 0, 0x1000, 0x1000},
+                              {0, 1, 1, 0x2000, 0x2000},
                               // 跳转后顺序执行
-                              {0, 0, 0x0000, 0x1004},
+                              {0, 0, 0, 0x0000, 0x2004},
                               // 二次复位
-                              {1, 0, 0x0000, 0x0000}};
+                              {1, 0, 0, 0x0000, 0x0000}};
 
     for (const auto& t : tests) {
         total++;
         // 设置输入信号
         dut.reset = t.reset;
         dut.sign = t.sign;
+        dut.half = t.half;
         dut.tar = t.tar;
 
         // 生成时钟脉冲（上升沿）
@@ -46,7 +52,7 @@ int main(int argc, char** argv) {
         if (dut.pc_addr == t.expected) {
             pass_count++;
         } else {
-            std::cout << "FAIL: reset=" << t.reset << " sign=" << t.sign
+            std::cout << "FAIL: reset=" << t.reset << " sign=" << t.sign << " half=" << t.half
                       << " tar=0x" << std::hex << t.tar << " got=0x"
                       << dut.pc_addr << " expected=0x" << t.expected
                       << std::endl;
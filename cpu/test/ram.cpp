@@ -1,5 +1,7 @@
 #include "ram.hpp"
 #include "Vram.h"
+#include "Vram___024root.h"
+#include "sparse_ram.hpp"
 #include <cstdint>
 #include <iostream>
 #include <random>
@@ -43,6 +45,38 @@ int main(int argc, char** argv) {
         }
     }
 
+    // 检查稀疏存储：只有被写过的页才会分配
+    const ram::SparseRam& mem = ram::from_handle(top->rootp->ram__DOT__handle);
+    std::cout << "RAM resident: " << mem.page_count() << " pages, "
+              << mem.resident_bytes() / 1024 << " KB" << std::endl;
+    if (mem.page_count() <= 2 * num_tests) {
+        std::cout << "✅ Sparse allocation test passed." << std::endl;
+    } else {
+        std::cerr << "❌ Sparse allocation test failed." << std::endl;
+    }
+
+    // 读取从未写过的地址应当得到0，并且不分配新的页
+    size_t pages = mem.page_count();
+    uint64_t untouched = ram::read_64bits(top, 0x0FFFFFF0);
+    if (untouched == 0 && mem.page_count() == pages) {
+        std::cout << "✅ Untouched read test passed." << std::endl;
+    } else {
+        std::cerr << "❌ Untouched read test failed." << std::endl;
+    }
+
+    // 字节使能：只写入选中的字节，其余字节保持不变（sb/sh/sw）
+    const uint64_t be_addr = 0x1003;
+    ram::write_64bits(top, be_addr, 0x0011223344556677ULL);
+    ram::write_64bits(top, be_addr, 0xAA000000000000BBULL, 0x81);
+    ram::write_64bits(top, be_addr + 2, 0xCCDD000000000000ULL, 0xC0);
+    uint64_t merged = ram::read_64bits(top, be_addr);
+    if (merged == 0xAA11CCDD445566BBULL) {
+        std::cout << "✅ Byte enable test passed." << std::endl;
+    } else {
+        std::cerr << "❌ Byte enable test failed: 0x" << std::hex << merged << std::dec
+                  << std::endl;
+    }
+
     top->final();
     delete top;
     return 0;
@@ -13,8 +13,9 @@ namespace ram {
  * @param ram 需要写入的RAM
  * @param addr 需要写入的地址
  * @param data 需要写入的数据
+ * @param be 字节使能，be的第7位对应data的最高字节（写入addr处），默认写入全部8个字节
  */
-inline void write_64bits(Vram* ram, uint64_t addr, uint64_t data) {
+inline void write_64bits(Vram* ram, uint64_t addr, uint64_t data, uint8_t be = 0xFF) {
     /* 初始化使能信号 */
     ram->cs = 0;
     ram->eval();
@@ -26,6 +27,7 @@ inline void write_64bits(Vram* ram, uint64_t addr, uint64_t data) {
     /* 设置写入的地址和数据 */
     ram->addr = addr; // 目标地址值
     ram->data = data; // 要写入的数据
+    ram->be = be;
 
     /* 产生上升使能沿 */
     ram->cs = 0;
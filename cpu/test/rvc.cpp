@@ -0,0 +1,60 @@
+#include "../../as/src/rvc.hpp"
+#include "Vrvc.h"
+#include "verilated.h"
+#include <cstdint>
+#include <iostream>
+
+/*
+ * 压缩指令展开：对全部65536种16位编码，rvc.v的输出都要与汇编器、指令集模拟器使用的
+ * rvc::expand()相同（不支持的编码都输出0）。
+ */
+
+struct Example {
+    const char* name; // 指令
+    uint16_t c;       // 压缩指令
+    uint32_t instr;   // 展开之后的指令
+};
+
+/* 几条常用的压缩指令，失败时便于定位 */
+const Example EXAMPLES[] = {
+    {"c.nop", 0x0001, 0x00000013},           /* addi x0 x0 0 */
+    {"c.addi16sp", 0x7179, 0xFD010113},      /* addi x2 x2 -48 */
+    {"c.sdsp", 0xE406, 0x00113423},          /* sd x1 x2 8 */
+    {"c.ldsp", 0x60A2, 0x00813083},          /* ld x1 x2 8 */
+    {"c.addi4spn", 0x0808, 0x01010513},      /* addi x10 x2 16 */
+    {"c.jr (ret)", 0x8082, 0x0000A067},      /* jalr x0 x1 0 */
+    {"c.ebreak", 0x9002, 0x00000000},        /* 不支持 */
+};
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    Vrvc dut;
+    int pass_count = 0, total = 0;
+
+    for (const Example& e : EXAMPLES) {
+        total++;
+        dut.c = e.c;
+        dut.eval();
+        if (dut.instr == e.instr && rvc::expand(e.c) == e.instr) {
+            pass_count++;
+        } else {
+            std::cout << "FAIL: " << e.name << " c=0x" << std::hex << e.c << " got=0x"
+                      << dut.instr << " expected=0x" << e.instr << std::dec << std::endl;
+        }
+    }
+
+    int mismatches = 0;
+    for (uint32_t c = 0; c < 0x10000; c++) {
+        dut.c = uint16_t(c);
+        dut.eval();
+        uint32_t expected = rvc::expand(uint16_t(c));
+        if (dut.instr != expected && mismatches++ < 8)
+            std::cout << "FAIL: c=0x" << std::hex << c << " got=0x" << dut.instr
+                      << " expected=0x" << expected << std::dec << std::endl;
+    }
+    total++;
+    pass_count += mismatches == 0;
+
+    std::cout << "RVC Test: " << pass_count << "/" << total << " pass_count\n";
+    return pass_count == total ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+/*
+ * ram.v的DPI-C实现：每个ram实例在initial中申请一个SparseRam，
+ * 并将其地址作为句柄保存，之后的读写都通过句柄访问。
+ */
+#include "sparse_ram.hpp"
+
+extern "C" {
+
+long long ram_dpi_open() {
+    return static_cast<long long>(reinterpret_cast<uintptr_t>(new ram::SparseRam));
+}
+
+void ram_dpi_close(long long handle) {
+    delete &ram::from_handle(handle);
+}
+
+long long ram_dpi_read(long long handle, long long addr) {
+    return ram::from_handle(handle).read64(addr);
+}
+
+void ram_dpi_write(long long handle, long long addr, long long data, char be) {
+    ram::from_handle(handle).write64(addr, data, static_cast<uint8_t>(be));
+}
+}
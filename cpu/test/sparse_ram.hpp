@@ -0,0 +1,190 @@
+#ifndef __SPARSE_RAM_HPP__
+#define __SPARSE_RAM_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace ram {
+
+/**
+ * @brief 按4KB页稀疏分配的RAM存储，作为ram.v的DPI-C后端
+ *
+ * 容量与ram.v一致，为256MB（地址取低28位）。页在第一次被写入时才分配，
+ * 读取从未写过的页直接返回0。数据按大端序逐字节存放，即地址addr处保存
+ * 64位数据的最高字节，与原先的reg数组实现保持相同的语义。
+ */
+class SparseRam {
+  public:
+    /* RAM容量：256MB */
+    static constexpr uint64_t SIZE = 1ULL << 28;
+    /* 页大小：4KB */
+    static constexpr uint64_t PAGE_SIZE = 1ULL << 12;
+    static constexpr uint64_t PAGE_COUNT = SIZE / PAGE_SIZE;
+
+    SparseRam() : pages_(PAGE_COUNT) {}
+
+    /**
+     * @brief 从addr处读取64位数据（大端序），超出容量的字节读为0
+     */
+    uint64_t read64(uint64_t addr) const {
+        uint64_t offset = addr % PAGE_SIZE;
+        if (addr + 8 <= SIZE && offset + 8 <= PAGE_SIZE) {
+            const uint8_t* page = pages_[addr / PAGE_SIZE].get();
+            if (!page)
+                return 0;
+            uint64_t data;
+            memcpy(&data, page + offset, 8);
+            return __builtin_bswap64(data);
+        }
+
+        uint64_t data = 0;
+        for (uint64_t i = 0; i < 8; i++)
+            data = data << 8 | read8(addr + i);
+        return data;
+    }
+
+    /**
+     * @brief 向addr处写入64位数据（大端序），超出容量的字节被丢弃
+     */
+    void write64(uint64_t addr, uint64_t data) {
+        uint64_t offset = addr % PAGE_SIZE;
+        if (addr + 8 <= SIZE && offset + 8 <= PAGE_SIZE) {
+            data = __builtin_bswap64(data);
+            memcpy(page(addr) + offset, &data, 8);
+            return;
+        }
+
+        for (uint64_t i = 0; i < 8; i++)
+            write8(addr + i, data >> (8 * (7 - i)));
+    }
+
+    /**
+     * @brief 按字节使能向addr处写入64位数据（大端序）
+     *
+     * be的第7位对应data的最高字节（写入addr处），第0位对应最低字节（写入addr+7处），
+     * 只写入使能的字节。字节不跨页时读出原来的8个字节、合并之后一次写回。
+     */
+    void write64(uint64_t addr, uint64_t data, uint8_t be) {
+        if (be == 0xFF) {
+            write64(addr, data);
+            return;
+        }
+        uint64_t offset = addr % PAGE_SIZE;
+        if (addr + 8 <= SIZE && offset + 8 <= PAGE_SIZE) {
+            uint64_t mask = 0;
+            for (int i = 0; i < 8; i++)
+                if (be >> i & 1)
+                    mask |= 0xFFULL << (8 * i);
+            uint8_t* p = page(addr) + offset;
+            uint64_t old;
+            memcpy(&old, p, 8);
+            old = __builtin_bswap64(old);
+            uint64_t merged = __builtin_bswap64((old & ~mask) | (data & mask));
+            memcpy(p, &merged, 8);
+            return;
+        }
+
+        for (uint64_t i = 0; i < 8; i++)
+            if (be >> (7 - i) & 1)
+                write8(addr + i, data >> (8 * (7 - i)));
+    }
+
+    uint8_t read8(uint64_t addr) const {
+        if (addr >= SIZE)
+            return 0;
+        const uint8_t* page = pages_[addr / PAGE_SIZE].get();
+        return page ? page[addr % PAGE_SIZE] : 0;
+    }
+
+    void write8(uint64_t addr, uint8_t data) {
+        if (addr >= SIZE)
+            return;
+        page(addr)[addr % PAGE_SIZE] = data;
+    }
+
+    /**
+     * @brief 将一段连续的数据按字节顺序写入addr处
+     *
+     * @return size_t 实际写入的字节数（超出容量的部分被丢弃）
+     */
+    size_t write(uint64_t addr, const uint8_t* data, size_t size) {
+        if (addr >= SIZE)
+            return 0;
+        if (size > SIZE - addr)
+            size = SIZE - addr;
+
+        size_t done = 0;
+        while (done < size) {
+            uint64_t offset = (addr + done) % PAGE_SIZE;
+            size_t chunk = min<size_t>(size - done, PAGE_SIZE - offset);
+            memcpy(page(addr + done) + offset, data + done, chunk);
+            done += chunk;
+        }
+        return size;
+    }
+
+    /**
+     * @brief 从addr处按字节顺序读取一段连续的数据，未分配的页读为0
+     */
+    void read(uint64_t addr, uint8_t* data, size_t size) const {
+        for (size_t done = 0; done < size;) {
+            uint64_t offset = (addr + done) % PAGE_SIZE;
+            size_t chunk = min<size_t>(size - done, PAGE_SIZE - offset);
+            const uint8_t* page = addr + done < SIZE
+                                      ? pages_[(addr + done) / PAGE_SIZE].get()
+                                      : nullptr;
+            if (page)
+                memcpy(data + done, page + offset, chunk);
+            else
+                memset(data + done, 0, chunk);
+            done += chunk;
+        }
+    }
+
+    /**
+     * @brief 依次访问每个已分配的页：f(页的起始地址, 页的内容)
+     */
+    template <typename F> void for_each_page(F&& f) const {
+        for (uint64_t idx = 0; idx < PAGE_COUNT; idx++)
+            if (pages_[idx])
+                f(idx * PAGE_SIZE, static_cast<const uint8_t*>(pages_[idx].get()));
+    }
+
+    /* 已分配的页数 */
+    size_t page_count() const { return allocated_; }
+
+    /* 常驻内存的字节数（已分配的页加上页表本身） */
+    size_t resident_bytes() const {
+        return allocated_ * PAGE_SIZE + pages_.size() * sizeof(pages_[0]);
+    }
+
+  private:
+    uint8_t* page(uint64_t addr) {
+        auto& page = pages_[addr / PAGE_SIZE];
+        if (!page) {
+            page.reset(new uint8_t[PAGE_SIZE]());
+            allocated_++;
+        }
+        return page.get();
+    }
+
+    vector<unique_ptr<uint8_t[]>> pages_;
+    size_t allocated_ = 0;
+};
+
+/**
+ * @brief 根据ram.v中保存的句柄取得对应的SparseRam
+ */
+inline SparseRam& from_handle(uint64_t handle) {
+    return *reinterpret_cast<SparseRam*>(handle);
+}
+
+} // namespace ram
+
+#endif
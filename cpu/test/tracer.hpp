@@ -0,0 +1,150 @@
+#ifndef __TRACER_HPP__
+#define __TRACER_HPP__
+
+#include "Vhardware.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/*
+ * 波形格式由编译时的Verilator选项决定（见Makefile中的TRACE变量）：
+ *      --trace     ：VM_TRACE=1，VCD格式
+ *      --trace-fst ：VM_TRACE=1、VM_TRACE_FST=1，压缩的FST格式
+ *      不开启跟踪  ：VM_TRACE=0，所有波形相关的代码都不参与编译
+ */
+#ifndef VM_TRACE
+#define VM_TRACE 0
+#endif
+#ifndef VM_TRACE_FST
+#define VM_TRACE_FST 0
+#endif
+
+#if VM_TRACE
+#if VM_TRACE_FST
+#include <verilated_fst_c.h>
+#else
+#include <verilated_vcd_c.h>
+#endif
+#endif
+
+using namespace std;
+
+namespace tracer {
+
+#if VM_TRACE && VM_TRACE_FST
+typedef VerilatedFstC TraceFile;
+constexpr const char* EXTENSION = ".fst";
+#elif VM_TRACE
+typedef VerilatedVcdC TraceFile;
+constexpr const char* EXTENSION = ".vcd";
+#endif
+
+/* 波形跟踪的配置 */
+struct Config {
+    bool enabled = true;       // 是否跟踪波形
+    uint64_t start = 0;        // 开始跟踪的周期（含）
+    uint64_t end = UINT64_MAX; // 结束跟踪的周期（不含）
+
+    bool pc_trigger = false;         // 是否由指令地址触发跟踪
+    uint64_t pc = 0;                 // 触发跟踪的指令地址
+    uint64_t pc_cycles = UINT64_MAX; // 触发后跟踪的周期数
+
+    int depth = 5; // 跟踪的层次深度
+};
+
+/* 当前编译的仿真程序是否支持波形跟踪 */
+constexpr bool supported() { return VM_TRACE; }
+
+/**
+ * @brief 按配置只在需要的周期内记录波形
+ *
+ * 在构造仿真模型之前调用prepare()，构造之后调用open()，
+ * 之后每次求值后调用dump()。
+ */
+class Tracer {
+  public:
+    explicit Tracer(const Config& config) : config_(config) {
+        if (config_.pc_trigger) {
+            config_.start = UINT64_MAX;
+            config_.end = UINT64_MAX;
+        }
+    }
+
+    /**
+     * @brief 在构造仿真模型之前开启Verilator的波形支持
+     */
+    void prepare() const {
+#if VM_TRACE
+        if (config_.enabled)
+            Verilated::traceEverOn(true);
+#endif
+    }
+
+    /**
+     * @brief 将波形文件与仿真模型关联，path不含扩展名
+     */
+    void open(Vhardware* hardware, const string& path) {
+#if VM_TRACE
+        if (!config_.enabled)
+            return;
+        hardware->trace(&file_, config_.depth);
+        file_.open((path + EXTENSION).c_str());
+        opened_ = true;
+#else
+        (void)hardware;
+        (void)path;
+#endif
+    }
+
+    /**
+     * @brief 在每次求值之后调用，只在跟踪窗口内写入波形
+     *
+     * @param time 仿真时间步
+     * @param cycle 已经仿真的时钟周期数
+     */
+    void dump(Vhardware* hardware, uint64_t time, uint64_t cycle) {
+#if VM_TRACE
+        if (!opened_)
+            return;
+
+        // 指令地址触发：该地址的指令退休后开始跟踪
+        if (config_.pc_trigger && !triggered_) {
+            if (!hardware->clk || !hardware->dbg_retire ||
+                hardware->dbg_pc != config_.pc)
+                return;
+            triggered_ = true;
+            config_.start = cycle;
+            config_.end = config_.pc_cycles == UINT64_MAX
+                              ? UINT64_MAX
+                              : cycle + config_.pc_cycles;
+        }
+
+        if (cycle >= config_.start && cycle < config_.end)
+            file_.dump(time);
+#else
+        (void)hardware;
+        (void)time;
+        (void)cycle;
+#endif
+    }
+
+    void close() {
+#if VM_TRACE
+        if (opened_)
+            file_.close();
+        opened_ = false;
+#endif
+    }
+
+  private:
+    Config config_;
+    bool triggered_ = false;
+    bool opened_ = false;
+#if VM_TRACE
+    TraceFile file_;
+#endif
+};
+
+} // namespace tracer
+
+#endif
@@ -0,0 +1,722 @@
+#ifndef __ISS_HPP__
+#define __ISS_HPP__
+
+#include "../../as/src/rvc.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <sys/mman.h>
+#include <vector>
+
+using namespace std;
+
+namespace iss {
+
+/* 支持的指令，与README中的指令表一一对应（not和ret是伪指令） */
+enum Op : uint8_t {
+    OP_UNKNOWN,
+    OP_ADD,
+    OP_ADDI,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_SLL,
+    OP_SRL,
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_XORI,
+    OP_LUI,
+    OP_LD,
+    OP_LB,
+    OP_LBU,
+    OP_LH,
+    OP_LHU,
+    OP_LW,
+    OP_LWU,
+    OP_SD,
+    OP_SB,
+    OP_SH,
+    OP_SW,
+    OP_BEQ,
+    OP_BGE,
+    OP_JAL,
+    OP_JALR,
+    OP_CSR,
+    OP_COUNT
+};
+
+inline const char* op_name(Op op) {
+    static const char* const names[OP_COUNT] = {
+        "unknown", "add", "addi", "sub", "mul", "div", "sll", "srl",
+        "and",     "or",  "xor",  "xori", "lui", "ld",  "lb",  "lbu",
+        "lh",      "lhu", "lw",   "lwu",  "sd",  "sb",  "sh",  "sw",
+        "beq",     "bge", "jal",  "jalr", "csrr"};
+    return op < OP_COUNT ? names[op] : "unknown";
+}
+
+/* 性能计数器的CSR地址，与cpu/src/perf.v一致 */
+enum Csr : uint16_t {
+    CSR_CYCLE = 0xC00,
+    CSR_TIME,
+    CSR_INSTRET,
+    CSR_MEM_READ,
+    CSR_MEM_WRITE,
+    CSR_BR_TAKEN,
+    CSR_CLS_ALU,
+    CSR_CLS_MULDIV,
+    CSR_CLS_LOAD,
+    CSR_CLS_STORE,
+    CSR_CLS_BRANCH,
+    CSR_CLS_JUMP,
+    CSR_CLS_CSR,
+    CSR_STALL_LOAD,
+    CSR_STALL_MEM,
+    CSR_FLUSH,
+};
+
+/* 预译码后的指令 */
+struct Decoded {
+    uint32_t raw = 0; // 指令的原始编码，压缩指令为展开之后的32位编码
+    uint8_t size = 4; // 指令的长度，压缩指令为2
+    Op op = OP_UNKNOWN;
+    uint8_t rd = 0, rs1 = 0, rs2 = 0;
+    int64_t imm = 0;
+};
+
+inline int64_t sext(uint64_t value, int bits) {
+    return static_cast<int64_t>(value << (64 - bits)) >> (64 - bits);
+}
+
+/* 写入x0时使用的寄存器下标，见Iss::x */
+constexpr uint8_t ZERO_SINK = 32;
+
+/**
+ * @brief 按ctrl.v的规则译码一条指令
+ *
+ * 立即数的取法与cpu.v一致：分支和jal的偏移量不左移，并且相对于下一条指令。
+ * 目标寄存器为x0时，rd被译码为ZERO_SINK。
+ */
+inline Decoded decode(uint32_t instr) {
+    Decoded d;
+    d.raw = instr;
+    uint32_t opcode = instr & 0x7F;
+    uint32_t funct3 = (instr >> 12) & 0x7;
+    uint32_t funct7 = instr >> 25;
+    d.rd = (instr >> 7) & 0x1F;
+    if (d.rd == 0)
+        d.rd = ZERO_SINK;
+    d.rs1 = (instr >> 15) & 0x1F;
+    d.rs2 = (instr >> 20) & 0x1F;
+
+    int64_t imm_i = sext(instr >> 20, 12);
+    int64_t imm_s = sext((funct7 << 5) | ((instr >> 7) & 0x1F), 12);
+    int64_t imm_b = sext(((instr >> 31) & 0x1) << 11 | ((instr >> 7) & 0x1) << 10 |
+                             ((instr >> 25) & 0x3F) << 4 | ((instr >> 8) & 0xF),
+                         12);
+    int64_t imm_j = sext(((instr >> 31) & 0x1) << 19 | ((instr >> 12) & 0xFF) << 11 |
+                             ((instr >> 20) & 0x1) << 10 | ((instr >> 21) & 0x3FF),
+                         20);
+    int64_t imm_u = sext(instr & 0xFFFFF000, 32);
+
+    if (opcode == 0x13 && funct3 == 0) {
+        d.op = OP_ADDI;
+        d.imm = imm_i;
+    } else if (opcode == 0x33) {
+        switch (funct7 << 3 | funct3) {
+        case 0x00 << 3 | 0:
+            d.op = OP_ADD;
+            break;
+        case 0x20 << 3 | 0:
+            d.op = OP_SUB;
+            break;
+        case 0x01 << 3 | 0:
+            d.op = OP_MUL;
+            break;
+        case 0x01 << 3 | 4:
+            d.op = OP_DIV;
+            break;
+        case 0x00 << 3 | 1:
+            d.op = OP_SLL;
+            break;
+        case 0x00 << 3 | 5:
+            d.op = OP_SRL;
+            break;
+        case 0x00 << 3 | 6:
+            d.op = OP_OR;
+            break;
+        case 0x00 << 3 | 7:
+            d.op = OP_AND;
+            break;
+        case 0x00 << 3 | 4:
+            d.op = OP_XOR;
+            break;
+        }
+    } else if (opcode == 0x03 && funct3 != 7) {
+        static const Op loads[] = {OP_LB, OP_LH, OP_LW, OP_LD, OP_LBU, OP_LHU, OP_LWU};
+        d.op = loads[funct3];
+        d.imm = imm_i;
+    } else if (opcode == 0x23 && funct3 < 4) {
+        static const Op stores[] = {OP_SB, OP_SH, OP_SW, OP_SD};
+        d.op = stores[funct3];
+        d.imm = imm_s;
+    } else if (opcode == 0x63 && funct3 == 0) {
+        d.op = OP_BEQ;
+        d.imm = imm_b;
+    } else if (opcode == 0x63 && funct3 == 5) {
+        d.op = OP_BGE;
+        d.imm = imm_b;
+    } else if (opcode == 0x6F) {
+        d.op = OP_JAL;
+        d.imm = imm_j;
+    } else if (opcode == 0x67 && funct3 == 2) {
+        d.op = OP_JALR;
+        d.imm = imm_i;
+    } else if (opcode == 0x13 && funct3 == 4) {
+        d.op = OP_XORI;
+        d.imm = imm_i;
+    } else if (opcode == 0x37) {
+        d.op = OP_LUI;
+        d.imm = imm_u;
+    } else if (opcode == 0x73 && funct3 == 2 && d.rs1 == 0) {
+        // csrrs rd csr x0，imm为CSR地址
+        d.op = OP_CSR;
+        d.imm = instr >> 20;
+    }
+    return d;
+}
+
+/**
+ * @brief 与ram.v语义一致的256MB大端序内存
+ *
+ * 地址取低28位；一次访问跨过256MB末尾时，超出的字节写入被丢弃、读出为0。
+ * 存储通过匿名mmap申请，只有被访问过的页才会真正占用物理内存。
+ * 写入时记录被写过的页，以便只把这些页交给cpu的RAM（见for_each_dirty_page）。
+ */
+class Memory {
+  public:
+    static constexpr uint64_t SIZE = 1ULL << 28;
+    static constexpr uint64_t MASK = SIZE - 1;
+    static constexpr uint64_t PAGE_SIZE = 4096;
+
+    Memory() : dirty_(SIZE / PAGE_SIZE) {
+        void* addr = mmap(nullptr, SIZE, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (addr == MAP_FAILED)
+            throw bad_alloc();
+        data_ = static_cast<uint8_t*>(addr);
+    }
+
+    ~Memory() { munmap(data_, SIZE); }
+
+    Memory(const Memory&) = delete;
+    Memory& operator=(const Memory&) = delete;
+
+    uint64_t read64(uint64_t addr) const {
+        addr &= MASK;
+        if (addr + 8 <= SIZE) {
+            uint64_t value;
+            memcpy(&value, data_ + addr, 8);
+            return __builtin_bswap64(value);
+        }
+        uint64_t value = 0;
+        for (uint64_t i = 0; i < 8; i++)
+            value = value << 8 | (addr + i < SIZE ? data_[addr + i] : 0);
+        return value;
+    }
+
+    void write64(uint64_t addr, uint64_t value) {
+        addr &= MASK;
+        dirty_[addr / PAGE_SIZE] = 1;
+        dirty_[(addr + 7 < SIZE ? addr + 7 : MASK) / PAGE_SIZE] = 1;
+        if (addr + 8 <= SIZE) {
+            value = __builtin_bswap64(value);
+            memcpy(data_ + addr, &value, 8);
+            return;
+        }
+        for (uint64_t i = 0; addr + i < SIZE; i++)
+            data_[addr + i] = value >> (8 * (7 - i));
+    }
+
+    uint32_t read32(uint64_t addr) const {
+        return static_cast<uint32_t>(read64(addr) >> 32);
+    }
+
+    /**
+     * @brief 读取addr处的size（1、2、4或8）个字节，零扩展为64位
+     */
+    uint64_t load(uint64_t addr, int size) const {
+        return read64(addr) >> (64 - 8 * size);
+    }
+
+    /**
+     * @brief 把value的低size（1、2、4或8）个字节按大端序写入addr处，与ram.v的字节使能一致
+     */
+    void store(uint64_t addr, uint64_t value, int size) {
+        if (size == 8) {
+            write64(addr, value);
+            return;
+        }
+        addr &= MASK;
+        for (int i = 0; i < size && addr + i < SIZE; i++) {
+            dirty_[(addr + i) / PAGE_SIZE] = 1;
+            data_[addr + i] = value >> (8 * (size - 1 - i));
+        }
+    }
+
+    /**
+     * @brief 将一段数据按字节顺序写入addr处
+     *
+     * @return size_t 实际写入的字节数
+     */
+    size_t write(uint64_t addr, const uint8_t* data, size_t size) {
+        if (addr >= SIZE)
+            return 0;
+        if (size > SIZE - addr)
+            size = SIZE - addr;
+        memcpy(data_ + addr, data, size);
+        for (uint64_t i = 0; i < size; i += PAGE_SIZE)
+            dirty_[(addr + i) / PAGE_SIZE] = 1;
+        if (size)
+            dirty_[(addr + size - 1) / PAGE_SIZE] = 1;
+        return size;
+    }
+
+    uint8_t read8(uint64_t addr) const { return data_[addr & MASK]; }
+
+    /**
+     * @brief 按地址顺序遍历被写过的页，f(addr, data)中data为页的PAGE_SIZE个字节
+     */
+    template <typename F> void for_each_dirty_page(F f) const {
+        for (uint64_t page = 0; page < dirty_.size(); page++) {
+            if (dirty_[page])
+                f(page * PAGE_SIZE, data_ + page * PAGE_SIZE);
+        }
+    }
+
+  private:
+    uint8_t* data_ = nullptr;
+    vector<uint8_t> dirty_; // 每页一个标志，页被写过时为1
+};
+
+/* 一条退休指令的执行结果，用于与cpu逐条比对 */
+struct Retire {
+    uint64_t pc = 0;      // 指令地址
+    uint32_t instr = 0;   // 指令编码
+    Op op = OP_UNKNOWN;   // 指令类型
+    uint64_t next_pc = 0; // 下一条指令的地址
+
+    uint16_t csr = 0;      // csrr读取的CSR地址
+    bool rd_write = false; // 是否写x[rd]
+    uint8_t rd = 0;        // 目标寄存器
+    uint64_t rd_value = 0; // 写入x[rd]的值
+
+    bool store = false;      // 是否写内存
+    uint64_t store_addr = 0; // 写入的地址
+    uint64_t store_data = 0; // 写入的数据
+};
+
+/* 停止执行的原因 */
+enum class StopReason {
+    RUNNING,       // 仍在运行
+    UNKNOWN_INSTR, // 遇到未知指令
+    SELF_LOOP,     // 跳转到自身（原地循环）
+    HALT_INSTR,    // 执行了指定的停机指令
+    LIMIT,         // 达到了指令数上限
+    STOP_PC,       // 到达了指定的指令地址
+};
+
+inline const char* reason_name(StopReason reason) {
+    switch (reason) {
+    case StopReason::RUNNING:
+        return "running";
+    case StopReason::UNKNOWN_INSTR:
+        return "unknown instruction";
+    case StopReason::SELF_LOOP:
+        return "jump to self";
+    case StopReason::HALT_INSTR:
+        return "halt instruction";
+    case StopReason::LIMIT:
+        return "instruction limit reached";
+    case StopReason::STOP_PC:
+        return "stop pc reached";
+    }
+    return "";
+}
+
+/**
+ * @brief RV64I子集的指令集模拟器
+ *
+ * 指令语义与README的指令表以及cpu.v一致：
+ *      - 分支和jal的偏移量相对于下一条指令（pc+4，压缩指令为pc+2），且不左移
+ *      - jal/jalr先将下一条指令的地址写入x[rd]，jalr再读取x[rs1]计算目标地址
+ *      - 压缩指令（见rvc.hpp）展开为32位指令之后执行
+ *      - div为无符号除法，除数为0时结果为0（与alu.v一致）
+ *      - bge按有符号数比较x[rs1]和x[rs2]
+ *      - csrr读取性能计数器；没有时序模型，cycle按每条指令一个周期计算，
+ *        流水线的停顿计数器恒为0
+ *
+ * 取指时按页缓存预译码的结果，写内存时使对应的缓存项失效。
+ */
+class Iss {
+  public:
+    Iss() : decoded_pages_(Memory::SIZE / PAGE_SIZE) {}
+
+    Memory mem;
+    /* x[32]用于吸收对x0的写入，使x0恒为0而无需在每次写入后清零 */
+    uint64_t x[33] = {};
+    uint64_t pc = 0;
+
+    /* 停机指令，use_halt_instr为true时有效 */
+    uint32_t halt_instr = 0;
+    bool use_halt_instr = false;
+    /* run()在执行该地址的指令之前停止，use_stop_pc为true时有效 */
+    uint64_t stop_pc = 0;
+    bool use_stop_pc = false;
+
+    /**
+     * @brief 执行一条指令
+     *
+     * @return true 指令已经执行（退休）
+     * @return false 遇到未知指令，pc保持不变
+     */
+    bool step() {
+        const Decoded& d = fetch(pc);
+        if (d.op == OP_UNKNOWN)
+            return false;
+        pc = execute(d, pc);
+        instret_++;
+        return true;
+    }
+
+    /**
+     * @brief 执行一条指令，并记录其执行结果
+     *
+     * @return true 指令已经执行（退休）
+     * @return false 遇到未知指令，pc保持不变
+     */
+    bool step(Retire& info) {
+        const Decoded& d = fetch(pc);
+        info = Retire();
+        info.pc = pc;
+        info.instr = d.raw;
+        info.op = d.op;
+        if (d.op == OP_UNKNOWN)
+            return false;
+
+        int size = store_size(d.op);
+        info.store = size != 0;
+        info.store_addr = x[d.rs1] + d.imm;
+        info.store_data = x[d.rs2];
+        // sb/sh/sw写入的是x[rs2]的低位字节（零扩展），与cpu的观测接口dbg_store_data一致
+        if (info.store && size < 8)
+            info.store_data &= (1ULL << (8 * size)) - 1;
+        info.rd_write = (!info.store && d.op != OP_BEQ && d.op != OP_BGE);
+        info.csr = (d.op == OP_CSR) ? d.imm : 0;
+        info.rd = (d.raw >> 7) & 0x1F;
+
+        pc = execute(d, pc);
+        instret_++;
+
+        info.next_pc = pc;
+        info.rd_value = x[info.rd];
+        return true;
+    }
+
+    /**
+     * @brief 连续执行，直到停机、到达stop_pc或执行了max_instrs条指令
+     */
+    StopReason run(uint64_t max_instrs) {
+        uint64_t curr_pc = pc, last_pc = ~pc;
+        uint64_t n = 0;
+        const DecodedPage* page = nullptr;
+        uint64_t page_index = UINT64_MAX;
+        stop_ = StopReason::LIMIT;
+
+        for (; n < max_instrs; n++) {
+            // 同一页内的指令直接使用缓存的页，跨页或未对齐时再查页表
+            uint64_t addr = curr_pc & Memory::MASK;
+            const Decoded* d;
+            if ((addr & 0x1) == 0 && addr / PAGE_SIZE == page_index) {
+                d = &page->instrs[addr % PAGE_SIZE / 2];
+            } else {
+                d = &fetch(addr);
+                if ((addr & 0x1) == 0) {
+                    page_index = addr / PAGE_SIZE;
+                    page = decoded_pages_[page_index].get();
+                }
+            }
+
+            if (use_stop_pc && curr_pc == stop_pc) {
+                stop_ = StopReason::STOP_PC;
+                break;
+            }
+            if (d->op == OP_UNKNOWN) {
+                stop_ = StopReason::UNKNOWN_INSTR;
+                break;
+            }
+            uint32_t raw = d->raw;
+            uint64_t next_pc = execute(*d, curr_pc);
+
+            if (use_halt_instr && raw == halt_instr) {
+                n++;
+                stop_ = StopReason::HALT_INSTR;
+                last_pc = curr_pc;
+                curr_pc = next_pc;
+                break;
+            }
+            // 连续两次执行同一地址的指令，只可能是跳转到了自身
+            if (curr_pc == last_pc) {
+                n++;
+                stop_ = StopReason::SELF_LOOP;
+                curr_pc = next_pc;
+                break;
+            }
+            last_pc = curr_pc;
+            curr_pc = next_pc;
+        }
+
+        pc = curr_pc;
+        instret_ += n;
+        return stop_;
+    }
+
+    uint64_t instret() const { return instret_; }
+    uint64_t count(Op op) const { return counts_[op]; }
+    StopReason stop_reason() const { return stop_; }
+
+  private:
+    static constexpr uint64_t PAGE_SIZE = 4096;
+    /* 压缩指令可以从任意2字节对齐的地址开始，每2字节一项 */
+    static constexpr uint64_t PAGE_INSTRS = PAGE_SIZE / 2;
+
+    /* 一页指令的预译码结果，在该页第一次取指时整页译码 */
+    struct DecodedPage {
+        Decoded instrs[PAGE_INSTRS];
+    };
+
+    /* 译码addr处的指令：压缩指令先展开 */
+    Decoded decode_at(uint64_t addr) const {
+        uint32_t word = mem.read32(addr);
+        if (!rvc::is_compressed(addr, word))
+            return decode(word);
+        Decoded d = decode(rvc::expand(uint16_t(word >> 16)));
+        d.size = 2;
+        return d;
+    }
+
+    const Decoded& fetch(uint64_t addr) {
+        addr &= Memory::MASK;
+        // 未按2字节对齐的指令不缓存
+        if (addr & 0x1) {
+            scratch_ = decode_at(addr);
+            return scratch_;
+        }
+
+        auto& page = decoded_pages_[addr / PAGE_SIZE];
+        if (!page) {
+            page.reset(new DecodedPage);
+            uint64_t base = addr / PAGE_SIZE * PAGE_SIZE;
+            for (uint64_t i = 0; i < PAGE_INSTRS; i++)
+                page->instrs[i] = decode_at(base + i * 2);
+        }
+        return page->instrs[addr % PAGE_SIZE / 2];
+    }
+
+    /* 写内存后，重新译码覆盖到的指令：每项读取4字节，因此从写入地址之前2字节开始 */
+    void invalidate(uint64_t addr) {
+        uint64_t first = (addr & ~0x1ULL) - 2;
+        for (uint64_t i = 0; i < 6; i++) {
+            uint64_t masked = (first + 2 * i) & Memory::MASK;
+            auto& page = decoded_pages_[masked / PAGE_SIZE];
+            if (page)
+                page->instrs[masked % PAGE_SIZE / 2] = decode_at(masked);
+        }
+    }
+
+    void write_rd(uint8_t rd, uint64_t value) { x[rd] = value; }
+
+    /* 写内存指令写入的字节数，其余指令为0 */
+    static int store_size(Op op) {
+        switch (op) {
+        case OP_SB:
+            return 1;
+        case OP_SH:
+            return 2;
+        case OP_SW:
+            return 4;
+        case OP_SD:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    /* 已执行的读内存指令的条数 */
+    uint64_t loads() const {
+        return counts_[OP_LD] + counts_[OP_LB] + counts_[OP_LBU] + counts_[OP_LH] +
+               counts_[OP_LHU] + counts_[OP_LW] + counts_[OP_LWU];
+    }
+
+    /**
+     * @brief 读取性能计数器，执行csrr时调用（counts_已经计入了这条csrr）
+     */
+    uint64_t read_csr(uint64_t csr) const {
+        uint64_t executed = 0;
+        for (uint64_t count : counts_)
+            executed += count;
+        uint64_t instret = executed - 1;
+
+        switch (csr) {
+        case CSR_CYCLE:
+        case CSR_INSTRET:
+            return instret;
+        case CSR_MEM_READ:
+            // 每条指令取指一次，没有取指缓冲
+            return instret + loads();
+        case CSR_MEM_WRITE:
+        case CSR_CLS_STORE:
+            return counts_[OP_SD] + counts_[OP_SB] + counts_[OP_SH] + counts_[OP_SW];
+        case CSR_BR_TAKEN:
+            return taken_;
+        case CSR_CLS_ALU:
+            return counts_[OP_ADD] + counts_[OP_ADDI] + counts_[OP_SUB] +
+                   counts_[OP_SLL] + counts_[OP_SRL] + counts_[OP_AND] +
+                   counts_[OP_OR] + counts_[OP_XOR] + counts_[OP_XORI] +
+                   counts_[OP_LUI];
+        case CSR_CLS_MULDIV:
+            return counts_[OP_MUL] + counts_[OP_DIV];
+        case CSR_CLS_LOAD:
+            return loads();
+        case CSR_CLS_BRANCH:
+            return counts_[OP_BEQ] + counts_[OP_BGE];
+        case CSR_CLS_JUMP:
+            return counts_[OP_JAL] + counts_[OP_JALR];
+        case CSR_CLS_CSR:
+            return counts_[OP_CSR] - 1;
+        default:
+            return 0;
+        }
+    }
+
+    /**
+     * @brief 执行已译码的指令
+     *
+     * @return uint64_t 下一条指令的地址
+     */
+    uint64_t execute(const Decoded& d, uint64_t pc) {
+        uint64_t a = x[d.rs1], b = x[d.rs2];
+        uint64_t next_pc = pc + d.size;
+        counts_[d.op]++;
+
+        switch (d.op) {
+        case OP_ADD:
+            write_rd(d.rd, a + b);
+            break;
+        case OP_ADDI:
+            write_rd(d.rd, a + d.imm);
+            break;
+        case OP_SUB:
+            write_rd(d.rd, a - b);
+            break;
+        case OP_MUL:
+            write_rd(d.rd, a * b);
+            break;
+        case OP_DIV:
+            write_rd(d.rd, b != 0 ? a / b : 0);
+            break;
+        case OP_SLL:
+            write_rd(d.rd, a << (b & 0x3F));
+            break;
+        case OP_SRL:
+            write_rd(d.rd, a >> (b & 0x3F));
+            break;
+        case OP_AND:
+            write_rd(d.rd, a & b);
+            break;
+        case OP_OR:
+            write_rd(d.rd, a | b);
+            break;
+        case OP_XOR:
+            write_rd(d.rd, a ^ b);
+            break;
+        case OP_XORI:
+            write_rd(d.rd, a ^ d.imm);
+            break;
+        case OP_LUI:
+            write_rd(d.rd, d.imm);
+            break;
+        case OP_LD:
+            write_rd(d.rd, mem.read64(a + d.imm));
+            break;
+        case OP_LB:
+            write_rd(d.rd, sext(mem.load(a + d.imm, 1), 8));
+            break;
+        case OP_LBU:
+            write_rd(d.rd, mem.load(a + d.imm, 1));
+            break;
+        case OP_LH:
+            write_rd(d.rd, sext(mem.load(a + d.imm, 2), 16));
+            break;
+        case OP_LHU:
+            write_rd(d.rd, mem.load(a + d.imm, 2));
+            break;
+        case OP_LW:
+            write_rd(d.rd, sext(mem.load(a + d.imm, 4), 32));
+            break;
+        case OP_LWU:
+            write_rd(d.rd, mem.load(a + d.imm, 4));
+            break;
+        case OP_SD:
+            mem.write64(a + d.imm, b);
+            invalidate(a + d.imm);
+            break;
+        case OP_SB:
+        case OP_SH:
+        case OP_SW:
+            mem.store(a + d.imm, b, store_size(d.op));
+            invalidate(a + d.imm);
+            break;
+        case OP_BEQ:
+            if (a == b) {
+                next_pc += d.imm;
+                taken_++;
+            }
+            break;
+        case OP_BGE:
+            if (static_cast<int64_t>(a) >= static_cast<int64_t>(b)) {
+                next_pc += d.imm;
+                taken_++;
+            }
+            break;
+        case OP_JAL:
+            write_rd(d.rd, next_pc);
+            next_pc += d.imm;
+            break;
+        case OP_JALR:
+            // 先写x[rd]，再读取x[rs1]
+            write_rd(d.rd, next_pc);
+            next_pc = x[d.rs1] + d.imm;
+            break;
+        case OP_CSR:
+            write_rd(d.rd, read_csr(d.imm));
+            break;
+        default:
+            break;
+        }
+        return next_pc;
+    }
+
+    vector<unique_ptr<DecodedPage>> decoded_pages_;
+    Decoded scratch_;
+
+    uint64_t instret_ = 0;
+    uint64_t counts_[OP_COUNT] = {};
+    uint64_t taken_ = 0; // 跳转的beq/bge条数
+    StopReason stop_ = StopReason::RUNNING;
+};
+
+} // namespace iss
+
+#endif
@@ -0,0 +1,152 @@
+#include "../../as/src/image.hpp"
+#include "iss.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 将整个文件装载到内存的addr处
+ *
+ * @return true 装载成功
+ * @return false 文件无法打开，或超出了内存的范围
+ */
+bool load_file(iss::Memory& mem, const string& path, uint64_t addr) {
+    ifstream fin(path, ios::binary);
+    if (!fin) {
+        cerr << "无法打开文件: " << path << '\n';
+        return false;
+    }
+    vector<uint8_t> data((istreambuf_iterator<char>(fin)),
+                         istreambuf_iterator<char>());
+    if (mem.write(addr, data.data(), data.size()) != data.size()) {
+        cerr << "文件超出了内存的范围: " << path << '\n';
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 解析形如<file>@<addr>的数据文件描述，规则与cpu/test/loader.hpp装载数据文件时相同：
+ *        文件名中可以含有'@'（以最后一个'@'分隔），地址必须是完整的数并且在内存的范围内
+ *
+ * @return true 解析成功
+ * @return false 格式错误，已输出错误信息
+ */
+bool parse_spec(const string& spec, string& path, uint64_t& addr) {
+    size_t at = spec.rfind('@');
+    if (at == string::npos || at == 0 || at + 1 == spec.size()) {
+        cerr << "数据文件的格式应为<file>@<addr>: " << spec << '\n';
+        return false;
+    }
+
+    char* end = nullptr;
+    errno = 0;
+    addr = strtoull(spec.c_str() + at + 1, &end, 0);
+    if (*end != '\0' || errno == ERANGE || spec[at + 1] == '-') {
+        cerr << "无效的装载地址: " << spec.substr(at + 1) << '\n';
+        return false;
+    }
+    if (addr >= iss::Memory::SIZE) {
+        cerr << "装载地址超出了内存的范围: " << spec.substr(at + 1) << '\n';
+        return false;
+    }
+    path = spec.substr(0, at);
+    return true;
+}
+
+/**
+ * @brief 装载汇编器生成的程序映像（或原始二进制文件），并把pc设为入口地址
+ */
+bool load_program(iss::Iss& sim, const string& path) {
+    ifstream fin(path, ios::binary);
+    if (!fin) {
+        cerr << "无法打开文件: " << path << '\n';
+        return false;
+    }
+    vector<uint8_t> data((istreambuf_iterator<char>(fin)),
+                         istreambuf_iterator<char>());
+    uint64_t entry;
+    string error;
+    auto write = [&](uint64_t addr, const uint8_t* p, size_t n) {
+        return sim.mem.write(addr, p, n);
+    };
+    if (!image::load(data.data(), data.size(), write, entry, error)) {
+        cerr << "无法装载程序 " << path << ": " << error << '\n';
+        return false;
+    }
+    sim.pc = entry;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> positional, data_specs;
+    iss::Iss sim;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--halt" && i + 1 < argc) {
+            sim.halt_instr = strtoul(argv[++i], nullptr, 0);
+            sim.use_halt_instr = true;
+        } else if (!positional.empty() && arg.find('@') != string::npos) {
+            // 第一个位置参数总是程序文件，文件名中可以含有'@'
+            data_specs.push_back(arg);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.empty() || positional.size() > 2) {
+        cerr << "用法: iss <bin_file> [max_instrs, 默认1e9] [--halt <instr>] "
+                "[<data_file>@<addr> ...]\n";
+        return 1;
+    }
+
+    uint64_t max_instrs = positional.size() == 2
+                              ? strtoull(positional[1].c_str(), nullptr, 0)
+                              : 1000000000ULL;
+
+    // 装载程序和附加的数据文件
+    if (!load_program(sim, positional[0]))
+        return 1;
+    for (const string& spec : data_specs) {
+        string path;
+        uint64_t addr;
+        if (!parse_spec(spec, path, addr) || !load_file(sim.mem, path, addr))
+            return 1;
+    }
+
+    auto begin = chrono::steady_clock::now();
+    iss::StopReason reason = sim.run(max_instrs);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+
+    // 输出最终的寄存器
+    cout << "pc = 0x" << hex << setw(16) << setfill('0') << sim.pc << '\n';
+    for (int i = 0; i < 32; i++) {
+        cout << "x" << dec << setw(2) << setfill(' ') << left << i << right
+             << " = 0x" << hex << setw(16) << setfill('0') << sim.x[i]
+             << (i % 4 == 3 ? "\n" : "    ");
+    }
+    cout << dec << setfill(' ');
+
+    // 输出指令统计
+    cout << "Stop reason: " << iss::reason_name(reason) << '\n';
+    cout << "Instructions retired: " << sim.instret() << '\n';
+    for (int op = iss::OP_UNKNOWN + 1; op < iss::OP_COUNT; op++) {
+        uint64_t count = sim.count(static_cast<iss::Op>(op));
+        if (count)
+            cout << "  " << setw(5) << left
+                 << iss::op_name(static_cast<iss::Op>(op)) << right
+                 << setw(14) << count << '\n';
+    }
+    cout << "Host time: " << fixed << setprecision(3) << elapsed.count()
+         << " s, " << setprecision(1)
+         << sim.instret() / elapsed.count() / 1e6 << " MIPS\n";
+    return 0;
+}
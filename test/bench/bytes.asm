@@ -0,0 +1,71 @@
+; bytes：逐字节处理16KB的缓冲区，先用sb填入伪随机字节，再用lbu统计各个字节值出现的次数，统计4遍
+; 校验：x10为sum(count[v] * v)，即缓冲区中字节之和的4倍
+    la x5 buf
+    la x6 hist
+    lui x7 4 ; x7 = 16384，缓冲区的字节数
+    add x12 x5 x7 ; 缓冲区的末尾
+
+    ; 线性同余发生器：x8 = x8 * x21 + x22，取第24~31位作为字节
+    addi x8 x0 1
+    li x21 6364136223846793005 x11
+    li x22 1442695040888963407 x11
+    addi x20 x0 24
+    add x9 x5 x0
+fill:
+    mul x8 x8 x21
+    add x8 x8 x22
+    srl x15 x8 x20
+    sb x15 x9 0
+    addi x9 x9 1
+    beq x9 x12 count_start
+    beq x0 x0 fill
+
+count_start:
+    addi x13 x0 4 ; 剩余的遍数
+    addi x23 x0 3
+count_pass:
+    add x9 x5 x0
+count:
+    lbu x15 x9 0
+    sll x15 x15 x23
+    add x15 x15 x6 ; &hist[字节值]
+    ld x16 x15 0
+    addi x16 x16 1
+    sd x16 x15 0
+    addi x9 x9 1
+    beq x9 x12 count_done
+    beq x0 x0 count
+count_done:
+    addi x13 x13 -1
+    beq x13 x0 check
+    beq x0 x0 count_pass
+
+    ; x10 = sum(hist[v] * v)
+check:
+    add x10 x0 x0
+    add x14 x0 x0 ; 字节值
+    addi x19 x0 256
+sum:
+    ld x16 x6 0
+    mul x16 x16 x14
+    add x10 x10 x16
+    addi x6 x6 8
+    addi x14 x14 1
+    beq x14 x19 verify
+    beq x0 x0 sum
+
+verify:
+    la x11 expect
+    ld x11 x11 0
+    beq x10 x11 pass
+    .word 0 ; 结果错误：执行未知指令停机
+pass:
+    beq x0 x0 pass ; 结果正确：原地循环停机
+
+.data
+expect:
+    .dword 8366200
+hist:
+    .space 2048
+buf:
+    .space 16384
@@ -0,0 +1,35 @@
+; 以除法为主的循环：对i = 1..4000，求i*1000003的十进制各位数字之和（x /= 10直到x为0）
+; 被除数的大小各不相同，除法器的延迟随之变化；校验：x10为所有数字之和
+    add x10 x0 x0
+    addi x5 x0 10
+    lui x6 244
+    addi x6 x6 579 ; x6 = 1000003
+    addi x7 x0 1 ; i
+    addi x8 x0 2000
+    add x8 x8 x8 ; x8 = 4000
+outer:
+    mul x9 x7 x6 ; x = i*1000003
+digits:
+    div x12 x9 x5 ; q = x / 10
+    mul x13 x12 x5
+    sub x13 x9 x13 ; 当前位 = x - q*10
+    add x10 x10 x13
+    add x9 x12 x0
+    beq x9 x0 next
+    beq x0 x0 digits
+next:
+    beq x7 x8 verify
+    addi x7 x7 1
+    beq x0 x0 outer
+
+verify:
+    la x11 expect
+    ld x11 x11 0
+    beq x10 x11 pass
+    .word 0 ; 结果错误：执行未知指令停机
+pass:
+    beq x0 x0 pass ; 结果正确：原地循环停机
+
+.data
+expect:
+    .dword 130009
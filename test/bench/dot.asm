@@ -0,0 +1,62 @@
+; 点积：两个4096维的向量a[i] = i，b[i] = 2i+1，计算sum(a[i]*b[i])，计算4遍
+; 校验：x10为4遍的点积之和
+    la x5 vec_a
+    la x6 vec_b
+    lui x7 8 ; x7 = 32768，每个向量的字节数
+
+    ; 初始化a[i] = i，b[i] = 2i+1
+    add x8 x0 x0 ; i
+    add x9 x0 x0 ; 字节偏移
+init:
+    add x12 x5 x9
+    sd x8 x12 0
+    add x13 x8 x8
+    addi x13 x13 1
+    add x12 x6 x9
+    sd x13 x12 0
+    addi x8 x8 1
+    addi x9 x9 8
+    beq x9 x7 dot_start
+    beq x0 x0 init
+
+dot_start:
+    add x10 x0 x0
+    addi x14 x0 4 ; 剩余的遍数
+    add x16 x5 x7 ; a的末尾
+dot_pass:
+    add x12 x5 x0
+    add x13 x6 x0
+dot:
+    ; 每次处理2个元素
+    ld x17 x12 0
+    ld x18 x13 0
+    ld x19 x12 8
+    ld x20 x13 8
+    mul x17 x17 x18
+    mul x19 x19 x20
+    add x10 x10 x17
+    add x10 x10 x19
+    addi x12 x12 16
+    addi x13 x13 16
+    beq x12 x16 dot_done
+    beq x0 x0 dot
+dot_done:
+    addi x14 x14 -1
+    beq x14 x0 verify
+    beq x0 x0 dot_pass
+
+verify:
+    la x11 expect
+    ld x11 x11 0
+    beq x10 x11 pass
+    .word 0 ; 结果错误：执行未知指令停机
+pass:
+    beq x0 x0 pass ; 结果正确：原地循环停机
+
+.data
+expect:
+    .dword 183218380800
+vec_a:
+    .space 32768
+vec_b:
+    .space 32768
@@ -0,0 +1,36 @@
+; 递归的斐波那契数：fib(n) = fib(n-1) + fib(n-2)，用jal调用、ret返回，栈从RAM的顶端向下增长
+; 校验：x10 = fib(20) = 6765
+    lui x2 0x10000 ; 栈指针 = 0x10000000（256MB）
+    addi x10 x0 20
+    jal x1 fib
+    la x11 expect
+    ld x11 x11 0
+    beq x10 x11 pass
+    .word 0 ; 结果错误：执行未知指令停机
+pass:
+    beq x0 x0 pass ; 结果正确：原地循环停机
+
+    ; 参数和返回值都在x10中
+fib:
+    addi x5 x0 2
+    bge x10 x5 fib_rec
+    ret ; n < 2时fib(n) = n
+fib_rec:
+    addi x2 x2 -24
+    sd x1 x2 0
+    sd x10 x2 8
+    addi x10 x10 -1
+    jal x1 fib
+    sd x10 x2 16 ; 保存fib(n-1)
+    ld x10 x2 8
+    addi x10 x10 -2
+    jal x1 fib
+    ld x6 x2 16
+    add x10 x10 x6
+    ld x1 x2 0
+    addi x2 x2 24
+    ret
+
+.data
+expect:
+    .dword 6765
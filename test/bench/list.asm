@@ -0,0 +1,62 @@
+; 链表遍历：4096个16字节的节点{next, value}，第k个节点放在数组的(k*1597) mod 4096处，
+; 相邻节点在内存中相距很远；遍历链表8遍，累加各节点的value
+; 校验：x10为8遍累加的和
+    la x5 nodes
+    addi x6 x0 1597 ; 步长（与4096互素）
+    lui x7 1 ; x7 = 4096，节点数
+    addi x8 x7 -1 ; 取模用的掩码
+
+    ; 建立链表：节点k的value为k，next指向节点k+1，最后一个节点的next为0
+    add x9 x0 x0 ; k
+    add x12 x0 x0 ; k*1597 mod 4096
+build:
+    add x13 x12 x6
+    and x13 x13 x8 ; 节点k+1的下标
+    add x14 x12 x12
+    add x14 x14 x14
+    add x14 x14 x14
+    add x14 x14 x14
+    add x14 x14 x5 ; 节点k的地址
+    add x15 x13 x13
+    add x15 x15 x15
+    add x15 x15 x15
+    add x15 x15 x15
+    add x15 x15 x5 ; 节点k+1的地址
+    sd x15 x14 0
+    sd x9 x14 8
+    add x12 x13 x0
+    addi x9 x9 1
+    beq x9 x7 build_last
+    beq x0 x0 build
+build_last:
+    sd x0 x14 0
+
+    ; 从节点0开始遍历
+    add x10 x0 x0
+    addi x16 x0 8 ; 剩余的遍数
+walk_pass:
+    add x17 x5 x0
+walk:
+    ld x18 x17 8
+    add x10 x10 x18
+    ld x17 x17 0
+    beq x17 x0 walk_done
+    beq x0 x0 walk
+walk_done:
+    addi x16 x16 -1
+    beq x16 x0 verify
+    beq x0 x0 walk_pass
+
+verify:
+    la x11 expect
+    ld x11 x11 0
+    beq x10 x11 pass
+    .word 0 ; 结果错误：执行未知指令停机
+pass:
+    beq x0 x0 pass ; 结果正确：原地循环停机
+
+.data
+expect:
+    .dword 67092480
+nodes:
+    .space 65536
@@ -0,0 +1,100 @@
+; 矩阵乘法：32x32的双字矩阵C = A*B，A[i][j] = i+j，B[i][j] = i-j
+; 校验：x10为C中所有元素之和
+    la x5 mat_a
+    la x6 mat_b
+    la x7 mat_c
+    addi x8 x0 32 ; N
+    addi x9 x0 256 ; 一行的字节数
+
+    ; 初始化A和B
+    add x12 x0 x0 ; i
+init_row:
+    add x13 x0 x0 ; j
+init_col:
+    add x14 x12 x13
+    sd x14 x5 0
+    sub x14 x12 x13
+    sd x14 x6 0
+    addi x5 x5 8
+    addi x6 x6 8
+    addi x13 x13 1
+    beq x13 x8 init_next
+    beq x0 x0 init_col
+init_next:
+    addi x12 x12 1
+    beq x12 x8 mm_start
+    beq x0 x0 init_row
+
+    ; C[i][j] = sum(A[i][k] * B[k][j])
+mm_start:
+    la x5 mat_a
+    la x6 mat_b
+    add x12 x0 x0 ; i
+    add x15 x5 x0 ; &A[i][0]
+    add x16 x7 x0 ; &C[i][j]
+mm_row:
+    add x13 x0 x0 ; j
+    add x17 x6 x0 ; &B[0][j]
+mm_col:
+    add x18 x0 x0 ; 累加和
+    add x19 x15 x0 ; &A[i][k]
+    add x20 x17 x0 ; &B[k][j]
+    add x14 x0 x0 ; k
+mm_k:
+    ; 每次处理k和k+1
+    ld x21 x19 0
+    ld x22 x20 0
+    ld x23 x19 8
+    ld x24 x20 256
+    mul x21 x21 x22
+    mul x23 x23 x24
+    add x18 x18 x21
+    add x18 x18 x23
+    addi x19 x19 16
+    addi x20 x20 512
+    addi x14 x14 2
+    beq x14 x8 mm_store
+    beq x0 x0 mm_k
+mm_store:
+    sd x18 x16 0
+    addi x16 x16 8
+    addi x17 x17 8
+    addi x13 x13 1
+    beq x13 x8 mm_next
+    beq x0 x0 mm_col
+mm_next:
+    add x15 x15 x9
+    addi x12 x12 1
+    beq x12 x8 check
+    beq x0 x0 mm_row
+
+    ; 对C求和
+check:
+    add x10 x0 x0
+    add x16 x7 x0
+    addi x25 x0 1024 ; N*N
+check_loop:
+    ld x21 x16 0
+    add x10 x10 x21
+    addi x16 x16 8
+    addi x25 x25 -1
+    beq x25 x0 verify
+    beq x0 x0 check_loop
+
+verify:
+    la x11 expect
+    ld x11 x11 0
+    beq x10 x11 pass
+    .word 0 ; 结果错误：执行未知指令停机
+pass:
+    beq x0 x0 pass ; 结果正确：原地循环停机
+
+.data
+expect:
+    .dword 2793472
+mat_a:
+    .space 8192
+mat_b:
+    .space 8192
+mat_c:
+    .space 8192
@@ -0,0 +1,68 @@
+; memcpy：把4096个双字（32KB）从src复制到dst，复制8遍
+; 校验：x10为dst中所有双字之和，src[i] = 3i+1
+    la x5 src
+    la x6 dst
+    lui x7 8 ; x7 = 32768，数组的字节数
+
+    ; 初始化src[i] = 3i+1
+    addi x8 x0 1 ; 当前值
+    add x9 x5 x0 ; 当前地址
+    add x12 x5 x7 ; src的末尾
+init:
+    sd x8 x9 0
+    addi x8 x8 3
+    addi x9 x9 8
+    beq x9 x12 copy_start
+    beq x0 x0 init
+
+copy_start:
+    addi x13 x0 8 ; 剩余的遍数
+copy_pass:
+    add x9 x5 x0 ; 源地址
+    add x14 x6 x0 ; 目的地址
+copy:
+    ; 每次复制4个双字，先连续ld再连续sd
+    ld x15 x9 0
+    ld x16 x9 8
+    ld x17 x9 16
+    ld x18 x9 24
+    sd x15 x14 0
+    sd x16 x14 8
+    sd x17 x14 16
+    sd x18 x14 24
+    addi x9 x9 32
+    addi x14 x14 32
+    beq x9 x12 copy_done
+    beq x0 x0 copy
+copy_done:
+    addi x13 x13 -1
+    beq x13 x0 check
+    beq x0 x0 copy_pass
+
+    ; 对dst求和
+check:
+    add x10 x0 x0
+    add x14 x6 x0
+    add x19 x6 x7 ; dst的末尾
+sum:
+    ld x15 x14 0
+    add x10 x10 x15
+    addi x14 x14 8
+    beq x14 x19 verify
+    beq x0 x0 sum
+
+verify:
+    la x11 expect
+    ld x11 x11 0
+    beq x10 x11 pass
+    .word 0 ; 结果错误：执行未知指令停机
+pass:
+    beq x0 x0 pass ; 结果正确：原地循环停机
+
+.data
+expect:
+    .dword 25163776
+src:
+    .space 32768
+dst:
+    .space 32768
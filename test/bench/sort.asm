@@ -0,0 +1,80 @@
+; 插入排序：对512个伪随机的有符号双字升序排序
+; 数组由线性同余发生器x = x*A + C生成；校验：x10为sum(a[i]*(i+1))
+    la x5 array
+    addi x7 x0 512
+    add x7 x7 x7
+    add x7 x7 x7
+    add x7 x7 x7 ; x7 = 4096，数组的字节数
+    add x16 x5 x7 ; 数组的末尾
+
+    ; 生成数组
+    la x6 lcg
+    ld x12 x6 0 ; A
+    ld x13 x6 8 ; C
+    ld x8 x6 16 ; 种子
+    add x9 x5 x0
+gen:
+    mul x8 x8 x12
+    add x8 x8 x13
+    sd x8 x9 0
+    addi x9 x9 8
+    beq x9 x16 sort
+    beq x0 x0 gen
+
+    ; for (p = &a[1]; p != end; p++)：把*p插入到前面已经有序的部分
+sort:
+    addi x9 x5 8
+outer:
+    beq x9 x16 check
+    ld x14 x9 0 ; key
+    addi x15 x9 -8 ; q
+inner:
+    bge x15 x5 inner_cmp ; q >= &a[0]时继续比较
+    beq x0 x0 place
+inner_cmp:
+    ld x17 x15 0
+    bge x14 x17 place ; key >= *q：插入到q之后
+    sd x17 x15 8 ; *q后移一位
+    addi x15 x15 -8
+    beq x0 x0 inner
+place:
+    sd x14 x15 8
+    addi x9 x9 8
+    beq x0 x0 outer
+
+    ; 检查有序，并计算sum(a[i]*(i+1))
+check:
+    add x10 x0 x0
+    addi x18 x0 1 ; i+1
+    add x9 x5 x0
+    ld x17 x9 0
+check_loop:
+    mul x19 x17 x18
+    add x10 x10 x19
+    addi x9 x9 8
+    beq x9 x16 verify
+    ld x20 x9 0
+    bge x20 x17 ordered
+    .word 0 ; 没有排好序：执行未知指令停机
+ordered:
+    add x17 x20 x0
+    addi x18 x18 1
+    beq x0 x0 check_loop
+
+verify:
+    la x11 expect
+    ld x11 x11 0
+    beq x10 x11 pass
+    .word 0 ; 结果错误：执行未知指令停机
+pass:
+    beq x0 x0 pass ; 结果正确：原地循环停机
+
+.data
+lcg:
+    .dword 6364136223846793005
+    .dword 1442695040888963407
+    .dword 12345
+expect:
+    .dword 7398847052630647715
+array:
+    .space 4096
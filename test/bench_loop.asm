@@ -0,0 +1,11 @@
+    lui x3 0x100 ; 循环次数：x3 = 0x100000
+
+loop:
+    addi x2 x2 1 ; x2自增
+    add x1 x1 x2 ; 将x2的值加到x1中
+    mul x4 x2 x2 ; x4 = x2 * x2
+    beq x2 x3 end ; 如果x2的值等于x3，则跳转到end标签处结束运行
+    beq x0 x0 loop ; 否则，跳转到loop标签处继续运行
+
+end:
+    addi x0 x0 0 ; 空指令
@@ -0,0 +1,40 @@
+; 压缩指令（as -C）：相邻的两条能压缩的指令配成一组，使用16位编码；不用-C汇编时结果相同
+; 校验：x10 = 1+2+...+10 = 55（c.beqz/c.j的循环），x12 = 0x1234（c.sw/c.lw），
+;       x13 = 30+30-9 = 51（c.jalr调用、c.sdsp/c.ldsp、返回到一组中的第二条），x8 = 8，x9 = 2，x5 = 2
+    lui x2 0x10 ; 栈指针 = 0x10000
+    addi x2 x2 -32 ; c.addi
+    addi x8 x0 10 ; c.li
+    addi x10 x0 0 ; c.li
+loop:
+    beq x8 x0 done ; c.beqz
+    add x10 x10 x8 ; c.add
+    addi x8 x8 -1 ; c.addi
+    jal x0 loop ; c.j
+done:
+    addi x9 x2 8 ; c.addi4spn
+    lui x11 1 ; c.lui
+    addi x11 x11 0x234 ; 立即数超出范围，32位
+    sw x11 x9 0 ; c.sw
+    lw x12 x9 0 ; c.lw
+    addi x13 x0 30 ; c.li
+    addi x14 x0 9 ; c.li
+    la x15 func ; la总是两条32位的指令
+    jalr x1 x15 0 ; c.jalr：返回地址是下一条指令（pc+2）
+    sub x13 x13 x14 ; c.sub
+    addi x8 x0 12 ; c.li
+    addi x9 x0 10 ; c.li
+    and x8 x8 x9 ; c.and：x8 = 8
+    or x9 x9 x8 ; c.or：x9 = 10
+    xor x9 x9 x8 ; c.xor：x9 = 2
+    add x5 x0 x9 ; c.mv
+end:
+    beq x0 x0 end ; 原地循环停机
+
+    ; x13 += x13，经过栈保存和读取
+func:
+    addi x2 x2 -16 ; c.addi16sp
+    sd x13 x2 8 ; c.sdsp
+    ld x9 x2 8 ; c.ldsp
+    add x13 x13 x9 ; c.add
+    addi x2 x2 16 ; c.addi16sp
+    ret ; c.jr
@@ -0,0 +1,18 @@
+    ; 用性能计数器测量计算1到10的和所用的周期数和指令数
+    rdcycle x10 ; 开始时的周期数
+    rdinstret x11 ; 开始时的指令数
+    addi x3 x0 10 ; 向x3中写入10
+
+loop:
+    addi x2 x2 1 ; x2自增
+    add x1 x1 x2 ; 将x2的值加到x1中
+    beq x2 x3 end ; 如果x2的值等于10，则跳转到end标签处
+    beq x0 x0 loop ; 否则，跳转到loop标签处继续运行
+
+end:
+    rdcycle x12 ; 结束时的周期数
+    rdinstret x13 ; 结束时的指令数
+    sub x12 x12 x10 ; x12为循环所用的周期数
+    sub x13 x13 x11 ; x13为循环所用的指令数（含rdinstret x11本身）
+    csrr x14 hpmcounter5 ; 跳转的分支条数
+    addi x0 x0 0 ; 空指令
@@ -0,0 +1,26 @@
+    addi x1 x0 7 ; x1=7
+    add x2 x1 x1 ; 紧跟着使用上一条指令的结果：x2=14
+    add x3 x2 x1 ; 同时使用前两条指令的结果：x3=21
+    lui x10 1 ; x10=0x1000，作为数据区
+    sd x3 x10 0 ; [0x1000]=21
+    sd x2 x10 8 ; 连续的sd：[0x1008]=14
+    ld x4 x10 0 ; x4=21
+    add x5 x4 x4 ; 紧跟着使用ld的结果：x5=42
+    ld x6 x10 8 ; x6=14
+    sd x6 x10 16 ; 紧跟着写回ld的结果：[0x1010]=14
+    ld x7 x10 16 ; x7=14
+    beq x7 x6 skip ; 跳转，其后的两条指令不应执行
+    addi x5 x0 -100 ; 立即数超出c.li的范围：用-C汇编时也不压缩，skip的地址（x8）不变
+    addi x5 x0 -100
+
+skip:
+    jal x8 func ; 调用func，x8为返回地址
+    bge x5 x3 end ; 42>=21，跳转到end
+    addi x5 x0 -1
+
+func:
+    addi x9 x9 1 ; x9=1
+    jalr x0 x8 0 ; 返回
+
+end:
+    addi x0 x0 0 ; 空指令
@@ -0,0 +1,22 @@
+; li的常数合成和窥孔优化：用as -O汇编时结果应与不优化时相同
+    li x5 0x123456789ABCDEF0 x6 ; 64位常数，x6为左移量的临时寄存器
+    li x7 -1
+    li x8 0x7FFFFFFF ; lui+addi得到的是符号扩展的值，改为合成~x8再取反
+    li x9 0x8000000000000000 x6
+
+    addi x10 x0 8
+    addi x11 x0 3
+    mul x12 x5 x10 ; 乘以8，优化为sll x12 x5 x11
+    div x13 x5 x10 ; 无符号除以8，优化为srl x13 x5 x11
+    addi x14 x0 2
+    mul x15 x14 x7 ; 两个乘数都已知，优化为addi x15 x0 -2
+    mul x18 x5 x14 ; 乘以2，优化为add x18 x5 x5
+
+    beq x0 x0 next ; 跳转到下一条指令，优化时删除
+    addi x0 x0 0 ; 空指令，优化时删除
+next:
+    add x16 x16 x0 ; 恒等运算，优化时删除
+    beq x15 x7 skip ; 跳转到下一条指令，优化时删除
+    jal x0 skip ; 跳转到下一条指令，优化时删除
+skip:
+    addi x1 x0 1 ; 执行到这里
@@ -0,0 +1,39 @@
+; 字节、半字和字的读写：lb/lh/lw按符号位扩展，lbu/lhu/lwu零扩展，sb/sh/sw只改写选中的字节
+    la x2 data
+    lb x3 x2 0 ; 0x80，按符号位扩展为-128
+    lbu x4 x2 0 ; 0x80 = 128
+    lh x5 x2 2 ; 0x8001，按符号位扩展
+    lhu x6 x2 2 ; 0x8001
+    lw x7 x2 4 ; 0xFFFFFFFE，按符号位扩展为-2
+    lwu x8 x2 4 ; 0xFFFFFFFE
+    lh x13 x2 1 ; 未对齐：0x7F和0x80两个字节
+
+    ; 向0x1111111111111111中依次写入1、2、4个字节
+    la x9 buf
+    li x10 0x123456789ABCDEF0 x11
+    sb x10 x9 0
+    sh x10 x9 2
+    sw x10 x9 4
+    ld x12 x9 0 ; 0xF011DEF09ABCDEF0
+
+    ; 逐字节累加以0结尾的字符串
+    la x15 text
+    add x14 x0 x0
+loop:
+    lbu x16 x15 0
+    beq x16 x0 end
+    add x14 x14 x16
+    addi x15 x15 1
+    beq x0 x0 loop
+end:
+    addi x0 x0 0 ; 空指令
+
+.data
+data:
+    .byte 0x80 0x7F
+    .half 0x8001
+    .word 0xFFFFFFFE
+buf:
+    .dword 0x1111111111111111
+text:
+    .byte 104 101 108 108 111 0 ; "hello"
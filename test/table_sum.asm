@@ -0,0 +1,27 @@
+; 对.data中的数组求和，结果保存在x1中，并写回到sum处
+    la x2 table ; x2指向数组
+    la x3 count
+    ld x3 x3 0 ; x3为元素个数
+    lui x5 %hi(sum)
+
+loop:
+    ld x4 x2 0 ; 读取一个元素
+    add x1 x1 x4 ; 累加到x1中
+    addi x2 x2 8 ; 指向下一个元素
+    addi x3 x3 -1
+    beq x3 x0 end ; 所有元素都已累加，跳转到end标签处
+    beq x0 x0 loop
+
+end:
+    sd x1 x5 %lo(sum) ; 把结果写回sum处
+    ld x6 x5 %lo(sum) ; 再读出到x6中
+    addi x0 x0 0 ; 空指令
+
+.data
+count:
+    .dword 8
+table:
+    .dword 1 2 3 4 5 6 7 8
+    .align 4
+sum:
+    .space 8